@@ -0,0 +1,540 @@
+// Standalone JSON benchmark and regression suite.
+// Runs the parser entry points (file, stream, buffer), the serializers and typed access over a corpus made of the bundled documents and of synthetic
+// large documents, then reports throughputs (MB/s), heap allocations per document and peak RSS.
+//   Usage: JSONBenchmark [--output results.json] [--baseline previous.json] [--tolerance 0.1] [--quick] [additional files...]
+// With --baseline, any throughput lower than the baseline by more than the tolerance is reported as a regression and the exit code is 1.
+// The exit code is also 1 if a document doesn't survive a parse/serialize/parse round trip, or if one of the regression checks (edge cases run first) fails.
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <utility>
+
+#if defined(_WIN32)
+	#define NOMINMAX
+	#include <Windows.h>
+	#include <Psapi.h>
+	#pragma comment(lib, "psapi.lib")
+#else
+	#include <sys/resource.h>
+#endif
+
+#include <Benchmarks.hpp>
+#include <JSON.hpp>
+#include <JSONDocument.hpp>
+#include <JSONReader.hpp>
+#include <JSONStructuralIndex.hpp>
+#include <JSONWriter.hpp>
+#include <Logger.hpp>
+#include <Serialization.hpp>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Allocation counting: Every global allocation of the process goes through these.
+
+static std::atomic<size_t> AllocationCount{0};
+
+void* operator new(size_t size) {
+	++AllocationCount;
+	if(auto ptr = std::malloc(size == 0 ? 1 : size))
+		return ptr;
+	throw std::bad_alloc{};
+}
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+void operator delete[](void* ptr) noexcept {
+	std::free(ptr);
+}
+void operator delete(void* ptr, size_t) noexcept {
+	std::free(ptr);
+}
+void operator delete[](void* ptr, size_t) noexcept {
+	std::free(ptr);
+}
+
+template<typename Func>
+static size_t countAllocations(Func&& func) {
+	const size_t before = AllocationCount.load();
+	func();
+	return AllocationCount.load() - before;
+}
+
+static size_t getPeakRSS() {
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters{};
+	if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.PeakWorkingSetSize;
+	return 0;
+#else
+	rusage usage{};
+	getrusage(RUSAGE_SELF, &usage);
+	return static_cast<size_t>(usage.ru_maxrss) * 1024; // Kilobytes on Linux
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static std::string readFile(const std::filesystem::path& path) {
+	std::ifstream file{path, std::ios::binary | std::ios::ate};
+	if(!file)
+		return {};
+	std::string content(static_cast<size_t>(file.tellg()), '\0');
+	file.seekg(0, std::ios::beg);
+	file.read(content.data(), content.size());
+	return content;
+}
+
+static double		   MinimumDuration = 0.5; // Seconds spent on each measurement (--quick lowers it)
+static volatile float Sink = 0;			   // Results of typed access, so the work can't be optimized away
+
+// Runs func repeatedly for at least MinimumDuration and returns the throughput in MB/s, relative to bytesPerIteration.
+template<typename Func>
+static double measureThroughput(size_t bytesPerIteration, Func&& func) {
+	using clock = std::chrono::high_resolution_clock;
+	size_t						  iterations = 0;
+	const auto					  start = clock::now();
+	std::chrono::duration<double> elapsed{0};
+	do {
+		func();
+		++iterations;
+		elapsed = clock::now() - start;
+	} while(elapsed.count() < MinimumDuration);
+	return (static_cast<double>(bytesPerIteration) * iterations) / (1024.0 * 1024.0) / elapsed.count();
+}
+
+// Structural equality. Numbers are compared by value: Serialization may turn a real without fractional part into an integer.
+static bool equals(const JSON::value& a, const JSON::value& b) {
+	if(a.getType() != b.getType())
+		return false;
+	switch(a.getType()) {
+		case JSON::value::Type::string: return a.asString() == b.asString();
+		case JSON::value::Type::number: return a.asNumber().toReal() == b.asNumber().toReal();
+		case JSON::value::Type::boolean: return a.asBoolean() == b.asBoolean();
+		case JSON::value::Type::array: {
+			const auto& l = a.asArray();
+			const auto& r = b.asArray();
+			if(l.size() != r.size())
+				return false;
+			for(size_t i = 0; i < l.size(); ++i)
+				if(!equals(l[i], r[i]))
+					return false;
+			return true;
+		}
+		case JSON::value::Type::object: {
+			const auto& l = a.asObject();
+			const auto& r = b.asObject();
+			if(l.size() != r.size())
+				return false;
+			for(const auto& [key, v] : l) {
+				auto it = r.find(key);
+				if(it == r.end() || !equals(v, it->second))
+					return false;
+			}
+			return true;
+		}
+		default: return true;
+	}
+}
+
+static std::string serialize(const JSON::value& root) {
+	return root.getType() == JSON::value::Type::object ? JSON::toString(root.asObject()) : JSON::toString(root.asArray());
+}
+
+// Typed access the way the engine reads its documents: to<glm::mat4> on arrays of 16 numbers, get<T>/operator() on object members. Returns a checksum.
+static float accessTyped(const JSON::value& v) {
+	float sum = 0;
+	switch(v.getType()) {
+		case JSON::value::Type::array: {
+			const size_t size = v.isPackedFloats() ? v.asFloats().size() : (v.isPackedIntegers() ? v.asIntegers().size() : v.asArray().size());
+			if(size == 16 && (v.isPackedFloats() || v.isPackedIntegers() || v.asArray()[0].getType() == JSON::value::Type::number)) {
+				const auto m = v.to<glm::mat4>();
+				sum += m[0][0] + m[3][3];
+			} else if(!v.isPackedFloats() && !v.isPackedIntegers()) {
+				for(const auto& e : v.asArray())
+					sum += accessTyped(e);
+			}
+			break;
+		}
+		case JSON::value::Type::object:
+			for(const auto& [key, member] : v.asObject()) {
+				switch(member.getType()) {
+					case JSON::value::Type::number: sum += v.get<float>(key, 0.0f); break;
+					case JSON::value::Type::string: sum += static_cast<float>(v(key, std::string{}).size()); break;
+					case JSON::value::Type::boolean: sum += member.asBoolean() ? 1.0f : 0.0f; break;
+					default: sum += accessTyped(member); break;
+				}
+			}
+			break;
+		default: break;
+	}
+	return sum;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Synthetic documents
+
+// Many chains of nested objects and arrays.
+static std::string generateDeepDocument(size_t chains, size_t depth) {
+	JSON::Writer json;
+	json.beginArray();
+	for(size_t c = 0; c < chains; ++c) {
+		for(size_t d = 0; d < depth; ++d) {
+			if(d % 2 == 0)
+				json.beginObject().write("depth", d).key("child");
+			else
+				json.beginArray().write(static_cast<int>(c));
+		}
+		json.write(JSON::null_t{});
+		for(size_t d = depth; d-- > 0;) {
+			if(d % 2 == 0)
+				json.endObject();
+			else
+				json.endArray();
+		}
+	}
+	json.endArray();
+	return std::string{json.getBuffer()};
+}
+
+// Scene-like nodes with transforms, followed by a few large arrays of numbers (vertex data like).
+static std::string generateNumbersDocument(size_t nodes, size_t arrayLength) {
+	JSON::Writer json;
+	json.beginObject();
+	json.key("nodes").beginArray();
+	float transform[16];
+	for(size_t i = 0; i < nodes; ++i) {
+		for(int j = 0; j < 16; ++j)
+			transform[j] = static_cast<float>(i) * 0.25f + static_cast<float>(j) / 7.0f;
+		json.beginObject().write("index", i).write("transform", std::span<const float>{transform, 16}).endObject();
+	}
+	json.endArray();
+	std::vector<float> reals(arrayLength);
+	std::vector<int>   integers(arrayLength);
+	for(size_t i = 0; i < arrayLength; ++i) {
+		reals[i] = static_cast<float>(i) / 3.0f - 1000.0f;
+		integers[i] = static_cast<int>(i * 7919 % 1000003);
+	}
+	json.write("positions", std::span<const float>{reals});
+	json.write("indices", std::span<const int>{integers});
+	json.endObject();
+	return std::string{json.getBuffer()};
+}
+
+// Long strings, some with escape sequences.
+static std::string generateStringsDocument(size_t count, size_t length) {
+	JSON::Writer json;
+	json.beginArray();
+	std::string str;
+	for(size_t i = 0; i < count; ++i) {
+		str.clear();
+		for(size_t j = 0; j < length; ++j)
+			str += static_cast<char>('a' + (i + j) % 26);
+		if(i % 2 == 0)
+			str += "\t\"escaped\"\n\\";
+		json.beginObject().write("name", std::to_string(i)).write("text", str).endObject();
+	}
+	json.endArray();
+	return std::string{json.getBuffer()};
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct BenchmarkDocument {
+	std::string			  name;
+	std::filesystem::path path; // The file entry point needs a file, synthetic documents are written to a temporary one.
+	std::string			  content;
+};
+
+struct BenchmarkResult {
+	std::string									name;
+	size_t										bytes = 0;
+	std::vector<std::pair<std::string, double>> throughputs; // MB/s, relative to the document size
+	std::vector<std::pair<std::string, size_t>> allocations; // Per parse/serialization
+	size_t										peakRSS = 0; // Of the process, after this document (documents are run in sequence)
+	bool										roundTrip = false;
+};
+
+static BenchmarkResult run(const BenchmarkDocument& doc) {
+	BenchmarkResult r{.name = doc.name, .bytes = doc.content.size()};
+	const auto&		content = doc.content;
+	const auto		add = [&](const char* name, double throughput, size_t allocations) {
+		 r.throughputs.emplace_back(name, throughput);
+		 r.allocations.emplace_back(name, allocations);
+	};
+	const auto measure = [&](const char* name, auto&& func) { add(name, measureThroughput(content.size(), func), countAllocations(func)); };
+
+	measure("parseFile", [&]() {
+		JSON json;
+		json.parse(doc.path);
+	});
+	measure("parseStream", [&]() {
+		std::istringstream iss{content};
+		JSON			   json;
+		json.parse(iss);
+	});
+	measure("parseBuffer", [&]() {
+		JSON json;
+		json.parse(std::string_view{content}, JSON::ParseOptions{.useStructuralIndex = false});
+	});
+	measure("parseIndexed", [&]() {
+		JSON json;
+		json.parse(std::string_view{content}, JSON::ParseOptions{.useStructuralIndex = true});
+	});
+	measure("parsePacked", [&]() {
+		JSON json;
+		json.parse(std::string_view{content}, JSON::ParseOptions{.packNumericArrays = true});
+	});
+	measure("document", [&]() {
+		JSON::Document d;
+		d.parse(std::string_view{content});
+	});
+	measure("documentPacked", [&]() {
+		JSON::Document d;
+		d.parse(std::string_view{content}, JSON::Document::ParseOptions{.packNumericArrays = true});
+	});
+
+	JSON json;
+	json.parse(std::string_view{content});
+	measure("save", [&]() {
+		std::ostringstream oss;
+		json.save(oss);
+	});
+	measure("toString", [&]() { serialize(json.getRoot()); });
+	measure("typedAccess", [&]() { Sink = Sink + accessTyped(json.getRoot()); });
+
+	JSON reparsed;
+	r.roundTrip = reparsed.parse(std::string_view{serialize(json.getRoot())}) && equals(json.getRoot(), reparsed.getRoot());
+	r.peakRSS = getPeakRSS();
+
+	print("  {} ({} bytes, peak RSS so far {} MB)\n", r.name, r.bytes, r.peakRSS / (1024 * 1024));
+	for(size_t i = 0; i < r.throughputs.size(); ++i)
+		print("    {:<14} {:>10.2f} MB/s  {:>10} allocations\n", r.throughputs[i].first, r.throughputs[i].second, r.allocations[i].second);
+	if(!r.roundTrip)
+		error("    Round trip failed: The document changed after serialization.\n");
+	return r;
+}
+
+static void writeResults(const std::filesystem::path& path, const std::vector<BenchmarkResult>& results) {
+	std::ofstream file{path, std::ios::binary};
+	if(!file) {
+		error("Could not open '{}' for writing.\n", path.string());
+		return;
+	}
+	JSON::Writer json{file};
+	json.beginObject();
+	json.write("version", 1);
+	constexpr const char* ImplementationNames[]{"Scalar", "SSE2", "AVX2"};
+	json.write("structuralIndex", ImplementationNames[static_cast<int>(JSONStructuralIndex::BestImplementation)]);
+	json.key("documents").beginArray();
+	for(const auto& r : results) {
+		json.beginObject();
+		json.write("name", r.name);
+		json.write("bytes", r.bytes);
+		json.key("throughput").beginObject();
+		for(const auto& [name, throughput] : r.throughputs)
+			json.write(name, static_cast<float>(throughput));
+		json.endObject();
+		json.key("allocations").beginObject();
+		for(const auto& [name, count] : r.allocations)
+			json.write(name, count);
+		json.endObject();
+		json.write("peakRSS", r.peakRSS);
+		json.write("roundTrip", r.roundTrip);
+		json.endObject();
+	}
+	json.endArray();
+	json.endObject();
+	print("Results written to '{}'.\n", path.string());
+}
+
+// Returns the number of regressions.
+static size_t compareToBaseline(const std::filesystem::path& path, const std::vector<BenchmarkResult>& results, double tolerance) {
+	JSON::Document baseline;
+	if(!baseline.parse(path)) {
+		error("Could not read baseline '{}'.\n", path.string());
+		return 0;
+	}
+	print("Comparison to '{}' (tolerance {:.0f}%)\n", path.string(), tolerance * 100.0);
+	size_t regressions = 0;
+	for(const auto& r : results) {
+		for(const auto& d : baseline["documents"]) {
+			if(d["name"].asString() != r.name)
+				continue;
+			for(const auto& [name, throughput] : r.throughputs) {
+				const auto* previous = d["throughput"].find(name);
+				if(!previous)
+					continue;
+				const auto ratio = throughput / previous->to<float>();
+				if(ratio < 1.0 - tolerance) {
+					++regressions;
+					warn("  {} {}: {:.2f} MB/s, was {:.2f} MB/s ({:+.1f}%)\n", r.name, name, throughput, previous->to<float>(), (ratio - 1.0) * 100.0);
+				}
+			}
+		}
+	}
+	if(regressions == 0)
+		success("  No regression.\n");
+	return regressions;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Regression checks: Edge cases of the parsers and accessors (malformed or truncated inputs log errors, this is expected). Returns the number of failures.
+
+static size_t runChecks() {
+	size_t	   failures = 0;
+	const auto check = [&](bool ok, const char* what) {
+		if(!ok) {
+			++failures;
+			error("  Check failed: {}\n", what);
+		}
+	};
+
+	// JSON::Reader
+	{
+		JSON::Reader reader{std::string_view{"\"abc\\"}}; // Ends with the backslash
+		check(!reader.skip() && reader.hasError() && reader.getOffset() <= 5, "Reader::skip on a string ending with a backslash");
+	}
+	{
+		uint32_t u = 0;
+		check(JSON::Reader{"4294967295"}.read(u) && u == 4294967295u, "Reader::read(uint32_t&) of UINT32_MAX");
+		check(JSON::Reader{"3000000000"}.read(u) && u == 3000000000u, "Reader::read(uint32_t&) above INT_MAX");
+		check(JSON::Reader{"2.0"}.read(u) && u == 2, "Reader::read(uint32_t&) of an integral real");
+		check(!JSON::Reader{"4294967296"}.read(u), "Reader::read(uint32_t&) rejects values above UINT32_MAX");
+		check(!JSON::Reader{"-1"}.read(u), "Reader::read(uint32_t&) rejects negative values");
+		check(!JSON::Reader{"1.5"}.read(u), "Reader::read(uint32_t&) rejects fractions");
+	}
+
+	// Packed numeric arrays (ParseOptions::packNumericArrays)
+	{
+		JSON json;
+		json.parse(std::string_view{R"({"f": [1.5, 2.5], "i": [1, 2, 3]})"}, JSON::ParseOptions{.packNumericArrays = true});
+		const auto& root = std::as_const(json).getRoot();
+		check(root["f"].isPackedFloats() && root["i"].isPackedIntegers(), "Numeric arrays are packed");
+		check(root["f"].asFloats()[1] == 2.5f && root["i"].asIntegers()[2] == 3, "Packed arrays are read through asFloats/asIntegers");
+		check(root["i"][1].getType() == JSON::value::Type::null && root["f"].asArray().empty() && root["i"].begin() == root["i"].end(), "Const generic access to packed arrays sees an empty array");
+		check(json.getRoot()["i"][1].as<int>() == 2 && !json.getRoot()["i"].isPackedIntegers(), "Non-const generic access unpacks the array");
+	}
+
+	// Serialization
+	{
+		JSON json;
+		json.parse(std::string_view{R"({"s": "a\"b\\c\n", "n": [1, 2.5, -3e-4], "t": true, "z": null})"});
+		const auto& root = json.getRoot();
+		std::ostringstream oss;
+		oss << root;
+		JSON reparsed;
+		check(oss.str() == root.serialize() && reparsed.parse(std::string_view{oss.str()}) && equals(root, reparsed.getRoot()), "operator<< and value::serialize round trip");
+		check(root["s"].serialize() == R"("a\"b\\c\n")" && root["s"].toString() == "a\"b\\c\n", "value::serialize escapes strings, toString doesn't");
+		check(JSON::number{2.5f}.toString() == "2.5" && JSON::number{-3}.toString() == "-3", "number::toString");
+	}
+
+	// JSON::Document
+	{
+		JSON::Document document;
+		document.parse(std::string_view{R"({"f": [1.5, 2.5, 3.5], "i": [1, 2], "mixed": [1, 2.5], "empty": []})"}, JSON::Document::ParseOptions{.packNumericArrays = true});
+		check(document["f"].isPackedFloats() && document["i"].isPackedIntegers() && !document["mixed"].isPackedFloats() && !document["empty"].isPackedIntegers(),
+			  "Document packs the arrays made only of reals or only of integers");
+		check(document["f"].to<glm::vec3>() == glm::vec3{1.5f, 2.5f, 3.5f} && document["i"].asIntegers()[1] == 2 && document["mixed"][1].to<float>() == 2.5f,
+			  "Document packed arrays are read through to<>() and asIntegers()");
+		check(document["i"].size() == 2 && document["i"][0].isNull() && document["f"].asArray().empty() && document["f"].begin() == document["f"].end(),
+			  "Document generic access to packed arrays sees an empty array");
+		check(document["f"].toValue().isPackedFloats() && document["f"].toValue().asFloats()[2] == 3.5f, "Document::Node::toValue keeps arrays packed");
+	}
+	{
+		const auto	   content = generateDeepDocument(50, 16);
+		JSON::Document document;
+		document.parse(std::string_view{content});
+		const auto arenaSize = document.getArenaSize();
+		for(int i = 0; i < 8; ++i)
+			document.parse(std::string_view{content});
+		check(document.getArenaSize() == arenaSize, "Document::parse releases the arena of the previous parse");
+	}
+	{
+		JSON::Document document;
+		document.parse(std::string_view{R"({"a": {"b" 1, "c": 2}, "d": [1, [2, 3]]})"}, JSON::Document::ParseOptions{.lazy = true});
+		check(!document.hasError() && document["d"][1][1].as<int>() == 3, "Lazy Document materializes valid subtrees");
+		check(!document["a"].contains("c") && document["a"].size() == 0 && document.hasError(), "Lazy Document reports malformed subtrees and sees them as empty");
+		document.parse(std::string_view{R"({"a": {"b" 1, "c": 2}, "d": [1, [2, 3]]})"}, JSON::Document::ParseOptions{.lazy = true});
+		check(!document.hasError() && !document.getRoot().materialize() && document.hasError(), "Document::Node::materialize fails on malformed subtrees");
+		JSON::Document valid;
+		valid.parse(std::string_view{R"({"a": {"b": [1, {"c": 2}]}})"}, JSON::Document::ParseOptions{.lazy = true});
+		check(valid.getRoot().materialize() && !valid.hasError() && valid["a"]["b"][1]["c"].as<int>() == 2, "Document::Node::materialize parses all deferred subtrees");
+	}
+
+	if(failures == 0)
+		success("  All checks passed.\n");
+	return failures;
+}
+
+int main(int argc, char* argv[]) {
+	std::filesystem::path output = "JSONBenchmark.json";
+	std::filesystem::path baselinePath;
+	double				  tolerance = 0.1;
+	bool				  quick = false;
+
+	std::vector<std::filesystem::path> files = DefaultJSONBenchmarkCorpus;
+	if(std::filesystem::exists("./data/materials"))
+		for(const auto& entry : std::filesystem::recursive_directory_iterator("./data/materials"))
+			if(entry.path().extension() == ".mat" && std::find(files.begin(), files.end(), entry.path()) == files.end())
+				files.push_back(entry.path());
+
+	for(int i = 1; i < argc; ++i) {
+		const std::string_view arg{argv[i]};
+		if(arg == "--output" && i + 1 < argc)
+			output = argv[++i];
+		else if(arg == "--baseline" && i + 1 < argc)
+			baselinePath = argv[++i];
+		else if(arg == "--tolerance" && i + 1 < argc)
+			tolerance = std::atof(argv[++i]);
+		else if(arg == "--quick")
+			quick = true;
+		else
+			files.push_back(arg);
+	}
+	if(quick)
+		MinimumDuration = 0.05;
+
+	std::vector<BenchmarkDocument> corpus;
+	for(const auto& path : files) {
+		auto content = readFile(path);
+		if(content.empty()) {
+			warn("Could not read '{}', skipping.\n", path.string());
+			continue;
+		}
+		corpus.push_back({path.filename().string(), path, std::move(content)});
+	}
+	const size_t scale = quick ? 1 : 8;
+	const std::pair<const char*, std::string> synthetic[]{
+		{"synthetic-deep", generateDeepDocument(500 * scale, 128)},
+		{"synthetic-numbers", generateNumbersDocument(2000 * scale, 100000 * scale)},
+		{"synthetic-strings", generateStringsDocument(500 * scale, 4096)},
+	};
+	for(const auto& [name, content] : synthetic) {
+		const auto path = std::filesystem::temp_directory_path() / (std::string{name} + ".json");
+		std::ofstream{path, std::ios::binary}.write(content.data(), content.size());
+		corpus.push_back({name, path, content});
+	}
+
+	print("JSON Checks\n");
+	size_t failures = runChecks();
+
+	print("JSON Benchmark ({} documents)\n", corpus.size());
+	std::vector<BenchmarkResult> results;
+	for(const auto& doc : corpus)
+		results.push_back(run(doc));
+	for(const auto& [name, content] : synthetic)
+		std::filesystem::remove(std::filesystem::temp_directory_path() / (std::string{name} + ".json"));
+
+	writeResults(output, results);
+
+	failures += std::count_if(results.begin(), results.end(), [](const BenchmarkResult& r) { return !r.roundTrip; });
+	if(!baselinePath.empty())
+		failures += compareToBaseline(baselinePath, results, tolerance);
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
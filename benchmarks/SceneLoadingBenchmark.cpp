@@ -0,0 +1,302 @@
+// Standalone (headless, no Vulkan device) Scene loading benchmark and regression suite.
+// Times the synchronous (Scene::load) and asynchronous (Scene::loadAsync, published by batches as the editor's main loop would) loads of a corpus of files,
+// then checks that both produce the same scene: Meshes, materials, textures, skins, animations and the node hierarchy with its renderers. Also checks that
+// importing a file twice in the same scene doesn't duplicate its meshes, and that malformed GLB files are rejected.
+//   Usage: SceneLoadingBenchmark [--meshes 64] [--nodes 4096] [files...]
+// --meshes and --nodes set the PublishBudget of the asynchronous loads (small budgets exercise the batching). Without files, the bundled corpus is used. A synthetic
+// OBJ file is always added.
+// The exit code is 1 if any of the checks fails.
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include <Benchmarks.hpp>
+#include <Logger.hpp>
+#include <Scene.hpp>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Copy of the global resources added by the loads
+struct Resources {
+	std::vector<Material>				materials;
+	std::vector<Texture>				textures;
+	std::vector<SkeletalAnimationClip> animations;
+};
+
+class Comparison {
+  public:
+	Comparison(const std::string& name) : _name(name) {}
+
+	inline size_t getMismatches() const { return _mismatches; }
+
+	template<typename T>
+	bool check(bool equal, const std::string& what, const T& expected, const T& actual) {
+		if(!equal) {
+			++_mismatches;
+			error("  [{}] {}: {} (synchronous) != {} (asynchronous).\n", _name, what, expected, actual);
+		}
+		return equal;
+	}
+	template<typename T>
+	bool check(const std::string& what, const T& expected, const T& actual) {
+		return check(expected == actual, what, expected, actual);
+	}
+
+  private:
+	std::string _name;
+	size_t		_mismatches = 0;
+};
+
+static std::string toString(const glm::mat4& m) {
+	return fmt::format("[{} {} {} {} | {} {} {} {} | {} {} {} {} | {} {} {} {}]", m[0][0], m[0][1], m[0][2], m[0][3], m[1][0], m[1][1], m[1][2], m[1][3], m[2][0], m[2][1],
+					   m[2][2], m[2][3], m[3][0], m[3][1], m[3][2], m[3][3]);
+}
+
+static std::string toString(const Bounds& b) {
+	return fmt::format("[{} {} {}] - [{} {} {}]", b.min.x, b.min.y, b.min.z, b.max.x, b.max.y, b.max.z);
+}
+
+static void compareResources(Comparison& cmp, const Resources& expected, const Resources& actual) {
+	if(cmp.check("Material count", expected.materials.size(), actual.materials.size()))
+		for(size_t i = 0; i < expected.materials.size(); ++i) {
+			const auto& e = expected.materials[i];
+			const auto& a = actual.materials[i];
+			cmp.check(fmt::format("Material #{} name", i), e.name, a.name);
+			cmp.check(std::memcmp(&e.properties, &a.properties, sizeof(Material::Properties)) == 0, fmt::format("Material #{} ('{}') properties", i, e.name),
+					  std::string{"..."}, std::string{"..."});
+		}
+	if(cmp.check("Texture count", expected.textures.size(), actual.textures.size()))
+		for(size_t i = 0; i < expected.textures.size(); ++i) {
+			cmp.check(fmt::format("Texture #{} source", i), expected.textures[i].source.string(), actual.textures[i].source.string());
+			cmp.check(fmt::format("Texture #{} format", i), static_cast<int>(expected.textures[i].format), static_cast<int>(actual.textures[i].format));
+		}
+	cmp.check("Animation count", expected.animations.size(), actual.animations.size());
+}
+
+static void compareMeshes(Comparison& cmp, const Scene& expected, const Scene& actual) {
+	const auto& e = expected.getMeshes();
+	const auto& a = actual.getMeshes();
+	if(!cmp.check("Mesh count", e.size(), a.size()))
+		return;
+	for(size_t i = 0; i < e.size(); ++i) {
+		cmp.check(fmt::format("Mesh #{} name", i), e[i].name, a[i].name);
+		cmp.check(e[i].hasSameContent(a[i]), fmt::format("Mesh #{} ('{}') content hash", i, e[i].name), e[i].computeContentHash(), a[i].computeContentHash());
+		cmp.check(fmt::format("Mesh #{} ('{}') default material", i, e[i].name), e[i].defaultMaterialIndex.value, a[i].defaultMaterialIndex.value);
+		cmp.check(fmt::format("Mesh #{} ('{}') dynamic", i, e[i].name), e[i].dynamic, a[i].dynamic);
+	}
+	cmp.check("Skin count", expected.getSkins().size(), actual.getSkins().size());
+}
+
+// Walks both hierarchies in parallel, in the order of the children links.
+static void compareNodes(Comparison& cmp, const Scene& expected, const Scene& actual, entt::entity e, entt::entity a, const std::string& path) {
+	const auto& er = expected.getRegistry();
+	const auto& ar = actual.getRegistry();
+	const auto& en = er.get<NodeComponent>(e);
+	const auto& an = ar.get<NodeComponent>(a);
+	const auto	nodePath = path + "/" + en.name;
+	cmp.check(fmt::format("{}: Name", nodePath), en.name, an.name);
+	cmp.check(en.transform == an.transform, fmt::format("{}: Local transform", nodePath), toString(en.transform), toString(an.transform));
+	cmp.check(en.globalTransform == an.globalTransform, fmt::format("{}: Global transform", nodePath), toString(en.globalTransform), toString(an.globalTransform));
+
+	const auto* emr = er.try_get<MeshRendererComponent>(e);
+	const auto* amr = ar.try_get<MeshRendererComponent>(a);
+	if(cmp.check(fmt::format("{}: Has a MeshRendererComponent", nodePath), emr != nullptr, amr != nullptr) && emr) {
+		cmp.check(fmt::format("{}: Mesh", nodePath), emr->meshIndex.value, amr->meshIndex.value);
+		cmp.check(fmt::format("{}: Material", nodePath), emr->materialIndex.value, amr->materialIndex.value);
+	}
+	const auto* esr = er.try_get<SkinnedMeshRendererComponent>(e);
+	const auto* asr = ar.try_get<SkinnedMeshRendererComponent>(a);
+	if(cmp.check(fmt::format("{}: Has a SkinnedMeshRendererComponent", nodePath), esr != nullptr, asr != nullptr) && esr) {
+		cmp.check(fmt::format("{}: Skinned mesh", nodePath), esr->meshIndex.value, asr->meshIndex.value);
+		cmp.check(fmt::format("{}: Skinned material", nodePath), esr->materialIndex.value, asr->materialIndex.value);
+		cmp.check(fmt::format("{}: Skin", nodePath), esr->skinIndex.value, asr->skinIndex.value);
+	}
+	cmp.check(fmt::format("{}: Has an AnimationComponent", nodePath), er.all_of<AnimationComponent>(e), ar.all_of<AnimationComponent>(a));
+
+	if(!cmp.check(fmt::format("{}: Child count", nodePath), en.children, an.children))
+		return;
+	for(auto ec = en.first, ac = an.first; ec != entt::null && ac != entt::null; ec = er.get<NodeComponent>(ec).next, ac = ar.get<NodeComponent>(ac).next)
+		compareNodes(cmp, expected, actual, ec, ac, nodePath);
+}
+
+// Grid of side * side quads in two objects, faces in a scattered order: Optimization changes their content (see Scene::optimizeMeshes).
+static std::string generateOBJ(size_t side) {
+	std::string obj;
+	for(size_t y = 0; y <= side; ++y)
+		for(size_t x = 0; x <= side; ++x)
+			obj += fmt::format("v {} {} {}\n", x * 0.1, 0.01 * static_cast<double>((x * 7 + y * 13) % 10), y * -0.1);
+	obj += "vn 0 1 0\n";
+	const auto vertex = [&](size_t x, size_t y) { return y * (side + 1) + x + 1; };
+	const auto faces = side * side;
+	for(size_t i = 0; i < faces; ++i) {
+		if(i == 0 || i == faces / 2)
+			obj += fmt::format("o Grid{}\n", i == 0 ? 0 : 1);
+		const auto face = (i * 7919) % faces; // 7919 is prime: A permutation of the faces, unless their count is a multiple of it
+		const auto x = face % side, y = face / side;
+		obj += fmt::format("f {}//1 {}//1 {}//1 {}//1\n", vertex(x, y), vertex(x + 1, y), vertex(x + 1, y + 1), vertex(x, y + 1));
+	}
+	return obj;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Loads the files in scene, synchronously or asynchronously (with the supplied budget). Returns the resources the loads added to the global ones, which are
+// restored.
+static Resources load(Scene& scene, const std::vector<std::filesystem::path>& files, bool async, const Scene::PublishBudget& budget, size_t& batches) {
+	const auto materialCount = Materials.size();
+	const auto textureCount = Textures.size();
+	const auto animationCount = Animations.size();
+	for(const auto& path : files)
+		if(async)
+			scene.loadAsync(path);
+		else
+			scene.load(path);
+	while(scene.isLoading())
+		if(scene.publishLoads(budget))
+			++batches;
+	scene.update(0); // Computes the global transforms
+	Resources added{
+		.materials = {Materials.begin() + materialCount, Materials.end()},
+		.textures = {Textures.begin() + textureCount, Textures.end()},
+		.animations = {Animations.begin() + animationCount, Animations.end()},
+	};
+	Materials.erase(Materials.begin() + materialCount, Materials.end());
+	Textures.erase(Textures.begin() + textureCount, Textures.end());
+	Animations.erase(Animations.begin() + animationCount, Animations.end());
+	return added;
+}
+
+static size_t compareLoads(const std::string& name, const std::vector<std::filesystem::path>& files, const Scene::PublishBudget& budget) {
+	size_t	   batches = 0;
+	Scene	   syncScene;
+	const auto syncResources = load(syncScene, files, false, budget, batches);
+	Scene	   asyncScene;
+	const auto asyncResources = load(asyncScene, files, true, budget, batches);
+
+	Comparison cmp(name);
+	compareResources(cmp, syncResources, asyncResources);
+	compareMeshes(cmp, syncScene, asyncScene);
+	compareNodes(cmp, syncScene, asyncScene, syncScene.getRoot(), asyncScene.getRoot(), "");
+	const auto& eb = syncScene.getBounds();
+	const auto& ab = asyncScene.getBounds();
+	cmp.check(eb.min == ab.min && eb.max == ab.max, "Bounds", toString(eb), toString(ab));
+	print("  {:<40} {:>6} meshes, {:>8} nodes, {:>5} batches: {}\n", name, syncScene.getMeshes().size(), syncScene.getRegistry().view<NodeComponent>().size(), batches,
+		  cmp.getMismatches() == 0 ? "Identical" : fmt::format("{} mismatches", cmp.getMismatches()));
+	return cmp.getMismatches();
+}
+
+// Importing a file a second time in the same scene must not add any mesh: All of them are duplicates of the first import (see Scene::deduplicateMeshes).
+static size_t checkDeduplication(const std::filesystem::path& path, const Scene::PublishBudget& budget) {
+	size_t batches = 0;
+	Scene  once;
+	load(once, {path}, false, budget, batches);
+	size_t failures = 0;
+	for(const bool async : {false, true}) {
+		Scene twice;
+		load(twice, {path, path}, async, budget, batches);
+		if(twice.getMeshes().size() != once.getMeshes().size()) {
+			++failures;
+			error("  [{}] {} imports twice: {} meshes, expected {}.\n", path.filename().string(), async ? "Asynchronous" : "Synchronous", twice.getMeshes().size(),
+				  once.getMeshes().size());
+		}
+	}
+	print("  {:<40} {:>6} meshes: {}\n", path.filename().string(), once.getMeshes().size(), failures == 0 ? "Deduplicated" : "Duplicates left");
+	return failures;
+}
+
+// Truncated or corrupted GLB files must be rejected (Scene::load returning false) rather than read out-of-bounds. Logs the errors of the rejected loads.
+static size_t checkMalformedGLB() {
+	// Valid container: 12 bytes header, then a JSON chunk (8 bytes header, content padded to 4 bytes).
+	const std::string_view json = R"({"asset":{"version":"2.0"}} )";
+	std::string			   valid(12 + 8 + json.size(), '\0');
+	const auto			   set = [](std::string& data, size_t offset, uint32_t value) { std::memcpy(data.data() + offset, &value, sizeof(value)); };
+	set(valid, 0, 0x46546C67);
+	set(valid, 4, 2);
+	set(valid, 8, static_cast<uint32_t>(valid.size()));
+	set(valid, 12, static_cast<uint32_t>(json.size()));
+	set(valid, 16, 0x4E4F534A);
+	std::memcpy(valid.data() + 20, json.data(), json.size());
+
+	std::vector<std::pair<const char*, std::string>> cases;
+	cases.emplace_back("Truncated header", valid.substr(0, 8));
+	cases.emplace_back("Invalid magic", valid);
+	set(cases.back().second, 0, 0);
+	cases.emplace_back("Length larger than the file", valid);
+	set(cases.back().second, 8, static_cast<uint32_t>(valid.size() + 64));
+	cases.emplace_back("Truncated file", valid.substr(0, valid.size() - 4));
+	cases.emplace_back("Chunk larger than the file", valid);
+	set(cases.back().second, 12, static_cast<uint32_t>(json.size() + 64));
+	cases.emplace_back("Truncated chunk header", valid + std::string(4, '\0'));
+	set(cases.back().second, 8, static_cast<uint32_t>(valid.size() + 4));
+	cases.emplace_back("First chunk is not JSON", valid);
+	set(cases.back().second, 16, 0x004E4942);
+
+	print("Malformed GLB files\n");
+	const auto path = std::filesystem::temp_directory_path() / "SceneLoadingBenchmark.glb";
+	size_t	   failures = 0;
+	for(const auto& [name, content] : cases) {
+		std::ofstream{path, std::ios::binary}.write(content.data(), content.size());
+		Scene scene;
+		if(scene.load(path)) {
+			++failures;
+			error("  {}: Loaded, expected an error.\n", name);
+		}
+	}
+	std::filesystem::remove(path);
+	if(failures == 0)
+		success("  All malformed files were rejected.\n");
+	return failures;
+}
+
+int main(int argc, char* argv[]) {
+	Scene::PublishBudget			   budget;
+	std::vector<std::filesystem::path> files;
+	for(int i = 1; i < argc; ++i) {
+		const std::string_view arg{argv[i]};
+		if(arg == "--meshes" && i + 1 < argc)
+			budget.meshes = std::max(1, std::atoi(argv[++i]));
+		else if(arg == "--nodes" && i + 1 < argc)
+			budget.nodes = std::max(1, std::atoi(argv[++i]));
+		else
+			files.push_back(arg);
+	}
+	if(files.empty())
+		files = DefaultSceneLoadingBenchmarkCorpus;
+	std::erase_if(files, [](const std::filesystem::path& path) {
+		if(std::filesystem::exists(path))
+			return false;
+		warn("Could not find '{}', skipping.\n", path.string());
+		return true;
+	});
+	const auto syntheticOBJ = std::filesystem::temp_directory_path() / "SceneLoadingBenchmark.obj";
+	{
+		const auto content = generateOBJ(64);
+		std::ofstream{syntheticOBJ, std::ios::binary}.write(content.data(), content.size());
+	}
+	files.push_back(syntheticOBJ);
+
+	// Index 0 is the default material of the editor, see Scene::loadAsync.
+	Materials.push_back(Material{.name = "Default Material"});
+
+	benchmarkSceneLoading(files);
+
+	print("Synchronous and asynchronous loads (budget of {} meshes and {} nodes per batch)\n", budget.meshes, budget.nodes);
+	size_t mismatches = 0;
+	for(const auto& path : files)
+		mismatches += compareLoads(path.filename().string(), {path}, budget);
+	if(files.size() > 1) // Materials and meshes of the first files shift the indices of the next ones
+		mismatches += compareLoads("(All files)", files, budget);
+
+	if(Scene{}.deduplicateImportedMeshes) {
+		print("Mesh deduplication across imports\n");
+		for(const auto& path : files)
+			mismatches += checkDeduplication(path, budget);
+	}
+
+	std::filesystem::remove(syntheticOBJ);
+
+	mismatches += checkMalformedGLB();
+
+	return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
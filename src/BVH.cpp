@@ -0,0 +1,198 @@
+#include "BVH.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <numeric>
+
+#include <Mesh.hpp>
+
+namespace {
+
+constexpr Bounds EmptyBounds{.min = glm::vec3(std::numeric_limits<float>::max()), .max = glm::vec3(std::numeric_limits<float>::lowest())};
+
+inline float halfArea(const Bounds& b) {
+	const auto d = glm::max(b.max - b.min, glm::vec3(0.0f));
+	return d.x * d.y + d.y * d.z + d.z * d.x;
+}
+
+inline glm::vec3 centroid(const Bounds& b) {
+	return 0.5f * (b.min + b.max);
+}
+
+} // namespace
+
+void BVH::build(std::span<const Bounds> primitives, uint32_t maxLeafSize) {
+	constexpr uint32_t BinCount = 16;
+
+	_nodes.clear();
+	_primitives.resize(primitives.size());
+	std::iota(_primitives.begin(), _primitives.end(), 0u);
+	if(primitives.empty())
+		return;
+
+	const auto rangeBounds = [&](uint32_t first, uint32_t count) {
+		Bounds b = EmptyBounds;
+		for(uint32_t i = first; i < first + count; ++i)
+			b += primitives[_primitives[i]];
+		return b;
+	};
+
+	_nodes.reserve(2 * primitives.size());
+	_nodes.push_back({rangeBounds(0, static_cast<uint32_t>(primitives.size())), 0, static_cast<uint32_t>(primitives.size())});
+	std::vector<std::pair<uint32_t, uint32_t>> stack{{0, 1}}; // Node, depth
+	while(!stack.empty()) {
+		const auto [index, depth] = stack.back();
+		stack.pop_back();
+		const auto first = _nodes[index].first;
+		const auto count = _nodes[index].count;
+		if(count <= 1 || depth >= MaxDepth)
+			continue;
+
+		Bounds centroids = EmptyBounds;
+		for(uint32_t i = first; i < first + count; ++i) {
+			const auto c = centroid(primitives[_primitives[i]]);
+			centroids += Bounds{c, c};
+		}
+
+		// Cost of a split relative to the intersection of a primitive (traversal of a node: 1): 1 + (area(left) * left + area(right) * right) / area
+		struct Bin {
+			Bounds	 bounds = EmptyBounds;
+			uint32_t count = 0;
+		};
+		float	 bestCost = std::numeric_limits<float>::max();
+		int		 bestAxis = -1;
+		uint32_t bestSplit = 0;
+		for(int axis = 0; axis < 3; ++axis) {
+			const float extent = centroids.max[axis] - centroids.min[axis];
+			if(extent <= 0.0f)
+				continue;
+			const float			  scale = BinCount / extent;
+			std::array<Bin, BinCount> bins;
+			for(uint32_t i = first; i < first + count; ++i) {
+				const auto& b = primitives[_primitives[i]];
+				const auto	bin = std::min(BinCount - 1, static_cast<uint32_t>((centroid(b)[axis] - centroids.min[axis]) * scale));
+				bins[bin].bounds += b;
+				++bins[bin].count;
+			}
+			// Sweep from the right, then from the left
+			std::array<float, BinCount> rightCosts;
+			Bounds						right = EmptyBounds;
+			uint32_t					rightCount = 0;
+			for(uint32_t split = BinCount - 1; split > 0; --split) {
+				right += bins[split].bounds;
+				rightCount += bins[split].count;
+				rightCosts[split] = rightCount > 0 ? rightCount * halfArea(right) : 0.0f;
+			}
+			Bounds	 left = EmptyBounds;
+			uint32_t leftCount = 0;
+			for(uint32_t split = 1; split < BinCount; ++split) {
+				left += bins[split - 1].bounds;
+				leftCount += bins[split - 1].count;
+				if(leftCount == 0 || leftCount == count)
+					continue;
+				const float cost = leftCount * halfArea(left) + rightCosts[split];
+				if(cost < bestCost) {
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = split;
+				}
+			}
+		}
+
+		const auto	area = halfArea(_nodes[index].bounds);
+		const float splitCost = area > 0.0f ? 1.0f + bestCost / area : 1.0f + count;
+		if(count <= maxLeafSize && (bestAxis < 0 || splitCost >= static_cast<float>(count)))
+			continue;
+
+		uint32_t middle = first + count / 2; // All centroids are at the same place: Arbitrary split
+		if(bestAxis >= 0) {
+			const float scale = BinCount / (centroids.max[bestAxis] - centroids.min[bestAxis]);
+			const auto	it = std::partition(_primitives.begin() + first, _primitives.begin() + first + count, [&](uint32_t p) {
+				 const auto bin = std::min(BinCount - 1, static_cast<uint32_t>((centroid(primitives[p])[bestAxis] - centroids.min[bestAxis]) * scale));
+				 return bin < bestSplit;
+			 });
+			middle = static_cast<uint32_t>(it - _primitives.begin());
+		}
+
+		const auto children = static_cast<uint32_t>(_nodes.size());
+		_nodes.push_back({rangeBounds(first, middle - first), first, middle - first});
+		_nodes.push_back({rangeBounds(middle, first + count - middle), middle, first + count - middle});
+		_nodes[index].first = children;
+		_nodes[index].count = 0;
+		stack.push_back({children, depth + 1});
+		stack.push_back({children + 1, depth + 1});
+	}
+}
+
+void BVH::refit(std::span<const Bounds> primitives) {
+	assert(primitives.size() == _primitives.size());
+	for(size_t i = _nodes.size(); i-- > 0;) {
+		auto& node = _nodes[i];
+		if(node.count > 0) {
+			node.bounds = EmptyBounds;
+			for(uint32_t p = node.first; p < node.first + node.count; ++p)
+				node.bounds += primitives[_primitives[p]];
+		} else {
+			node.bounds = _nodes[node.first].bounds + _nodes[node.first + 1].bounds;
+		}
+	}
+}
+
+MeshBVH::MeshBVH(const Mesh& mesh)
+	: _vertexData(mesh.getVertices().data()), _indexData(mesh.getIndices().data()), _vertexCount(mesh.getVertices().size()), _indexCount(mesh.getIndices().size()),
+	  _bounds(mesh.getBounds()) {
+	const auto&			vertices = mesh.getVertices();
+	const auto&			indices = mesh.getIndices();
+	std::vector<Bounds> triangles(indices.size() / 3);
+	for(size_t t = 0; t < triangles.size(); ++t) {
+		const auto& v0 = vertices[indices[3 * t]].pos;
+		const auto& v1 = vertices[indices[3 * t + 1]].pos;
+		const auto& v2 = vertices[indices[3 * t + 2]].pos;
+		triangles[t] = {.min = glm::min(v0, glm::min(v1, v2)), .max = glm::max(v0, glm::max(v1, v2))};
+	}
+	_bvh.build(triangles);
+
+	_positions.resize(3 * triangles.size());
+	const auto& order = _bvh.getPrimitives();
+	for(size_t i = 0; i < order.size(); ++i)
+		for(size_t v = 0; v < 3; ++v)
+			_positions[3 * i + v] = vertices[indices[3 * order[i] + v]].pos;
+}
+
+bool MeshBVH::isUpToDate(const Mesh& mesh) const {
+	const auto& b = mesh.getBounds();
+	return _vertexData == mesh.getVertices().data() && _indexData == mesh.getIndices().data() && _vertexCount == mesh.getVertices().size() &&
+		   _indexCount == mesh.getIndices().size() && b.min == _bounds.min && b.max == _bounds.max;
+}
+
+bool MeshBVH::intersect(const Ray& ray, Hit& hit) const {
+	bool found = false;
+	_bvh.traverse(ray, hit.depth, [&](uint32_t slot, float& maxDepth) {
+		// Möller-Trumbore
+		const auto&		v0 = _positions[3 * slot];
+		const glm::vec3 e1 = _positions[3 * slot + 1] - v0;
+		const glm::vec3 e2 = _positions[3 * slot + 2] - v0;
+		const glm::vec3 p = glm::cross(ray.direction, e2);
+		const float		det = glm::dot(e1, p);
+		if(det == 0.0f) // Parallel. No epsilon: Triangles can be tiny in the space of their mesh.
+			return;
+		const float		inverseDet = 1.0f / det;
+		const glm::vec3 s = ray.origin - v0;
+		const float		u = glm::dot(s, p) * inverseDet;
+		if(!(u >= 0.0f && u <= 1.0f)) // Also rejects NaNs
+			return;
+		const glm::vec3 q = glm::cross(s, e1);
+		const float		v = glm::dot(ray.direction, q) * inverseDet;
+		if(!(v >= 0.0f && u + v <= 1.0f))
+			return;
+		const float t = glm::dot(e2, q) * inverseDet;
+		if(!(t > 0.0f && t < maxDepth))
+			return;
+		maxDepth = t;
+		hit.triangle = _bvh.getPrimitives()[slot];
+		hit.barycentrics = {u, v};
+		found = true;
+	});
+	return found;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <Raytracing.hpp>
+
+// Bounding volume hierarchy over arbitrary primitives, given by their bounds, for the ray queries on the CPU (see Scene::raycast, which mirrors the
+// BLAS/TLAS split of the GPU: One MeshBVH per mesh, and a BVH over the world bounds of the mesh instances).
+// Built top-down with the surface area heuristic, evaluated on bins of primitive centroids. Can be refitted when the bounds move.
+class BVH {
+  public:
+	struct Node {
+		Bounds	 bounds;
+		uint32_t first; // Internal nodes: Index of the first child, the second one follows it. Leaves: First primitive in getPrimitives().
+		uint32_t count; // Number of primitives, 0 for internal nodes.
+	};
+
+	void build(std::span<const Bounds> primitives, uint32_t maxLeafSize = 4);
+	// Updates the bounds of the nodes without changing the topology (primitives must be the ones used by build, with new bounds).
+	void refit(std::span<const Bounds> primitives);
+
+	inline bool							 empty() const { return _nodes.empty(); }
+	inline const std::vector<Node>&		 getNodes() const { return _nodes; }
+	inline const std::vector<uint32_t>& getPrimitives() const { return _primitives; } // Primitive indices, in leaf order
+
+	// Calls intersect(slot, maxDepth) for each primitive whose leaf is hit by ray before maxDepth, closest nodes first. slot is the position of the
+	// primitive in getPrimitives(). intersect lowers maxDepth when it finds a closer hit, which prunes the rest of the traversal.
+	template<typename Intersect>
+	void traverse(const Ray& ray, float& maxDepth, Intersect&& intersect) const;
+
+	// Distance along ray to the entry point of b (0 if the origin is inside), or infinity if it is missed or entered after maxDepth.
+	static inline float intersect(const Bounds& b, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDepth) {
+		const glm::vec3 t1 = (b.min - origin) * inverseDirection;
+		const glm::vec3 t2 = (b.max - origin) * inverseDirection;
+		const glm::vec3 tNear = glm::min(t1, t2);
+		const glm::vec3 tFar = glm::max(t1, t2);
+		const float		entry = glm::max(glm::max(tNear.x, tNear.y), glm::max(tNear.z, 0.0f));
+		const float		exit = glm::min(glm::min(tFar.x, tFar.y), glm::min(tFar.z, maxDepth));
+		return entry <= exit ? entry : std::numeric_limits<float>::infinity();
+	}
+
+  private:
+	static constexpr uint32_t MaxDepth = 64; // Of the traversal stack. Deeper nodes are made leaves.
+
+	std::vector<Node>	  _nodes; // Children always follow their parent
+	std::vector<uint32_t> _primitives;
+};
+
+template<typename Intersect>
+void BVH::traverse(const Ray& ray, float& maxDepth, Intersect&& intersect) const {
+	if(_nodes.empty())
+		return;
+	const glm::vec3 inverseDirection = 1.0f / ray.direction;
+	struct Entry {
+		uint32_t node;
+		float	 depth;
+	};
+	Entry	 stack[MaxDepth + 1];
+	uint32_t size = 0;
+	if(const auto depth = BVH::intersect(_nodes[0].bounds, ray.origin, inverseDirection, maxDepth); depth != std::numeric_limits<float>::infinity())
+		stack[size++] = {0, depth};
+	while(size > 0) {
+		const auto entry = stack[--size];
+		if(entry.depth > maxDepth)
+			continue;
+		const auto& node = _nodes[entry.node];
+		if(node.count > 0) {
+			for(uint32_t i = node.first; i < node.first + node.count; ++i)
+				intersect(i, maxDepth);
+			continue;
+		}
+		Entry near{node.first, BVH::intersect(_nodes[node.first].bounds, ray.origin, inverseDirection, maxDepth)};
+		Entry far{node.first + 1, BVH::intersect(_nodes[node.first + 1].bounds, ray.origin, inverseDirection, maxDepth)};
+		if(far.depth < near.depth)
+			std::swap(near, far);
+		// The closest child is visited first
+		if(far.depth != std::numeric_limits<float>::infinity())
+			stack[size++] = far;
+		if(near.depth != std::numeric_limits<float>::infinity())
+			stack[size++] = near;
+	}
+}
+
+class Mesh;
+
+// BVH over the triangles of a Mesh, with a copy of their vertex positions in leaf order.
+class MeshBVH {
+  public:
+	struct Hit {
+		float	  depth = std::numeric_limits<float>::max(); // Along the direction of the ray
+		uint32_t  triangle = 0;
+		glm::vec2 barycentrics{0.0f}; // Weights of the second and third vertices of the triangle
+	};
+
+	explicit MeshBVH(const Mesh& mesh);
+
+	// False if the geometry of mesh has visibly changed since the construction (vertex or index buffers reallocated or resized, different bounds).
+	bool isUpToDate(const Mesh& mesh) const;
+
+	// Looks for a hit closer than hit.depth, returns true (and updates hit) if one was found.
+	bool intersect(const Ray& ray, Hit& hit) const;
+
+	inline size_t getTriangleCount() const { return _positions.size() / 3; }
+
+  private:
+	BVH					   _bvh;
+	std::vector<glm::vec3> _positions; // 3 per triangle, in the order of the leaves of _bvh
+
+	const void* _vertexData = nullptr;
+	const void* _indexData = nullptr;
+	size_t		_vertexCount = 0;
+	size_t		_indexCount = 0;
+	Bounds		_bounds;
+};
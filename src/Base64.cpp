@@ -0,0 +1,200 @@
+#include "Base64.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include <Logger.hpp>
+
+#if defined(BASE64_SIMD_AVX2)
+	#include <immintrin.h>
+#elif defined(BASE64_SIMD_SSSE3)
+	#include <tmmintrin.h>
+#endif
+
+namespace Base64 {
+
+namespace {
+
+constexpr uint8_t Invalid = 0xFF;
+
+constexpr std::array<uint8_t, 256> DecodingTable = [] {
+	std::array<uint8_t, 256> table{};
+	table.fill(Invalid);
+	constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	for(size_t i = 0; i < alphabet.size(); ++i)
+		table[static_cast<uint8_t>(alphabet[i])] = static_cast<uint8_t>(i);
+	return table;
+}();
+
+// Input without its padding. valid is false if the padding is misplaced or if the length can't be the one of a Base64 string.
+std::string_view stripPadding(std::string_view str, bool& valid) {
+	size_t padding = 0;
+	while(padding < 2 && padding < str.size() && str[str.size() - 1 - padding] == '=')
+		++padding;
+	const auto body = str.substr(0, str.size() - padding);
+	// A padded input is a multiple of 4 characters long, and a single character can't encode a full byte.
+	valid = (padding == 0 || str.size() % 4 == 0) && body.size() % 4 != 1;
+	return body;
+}
+
+size_t decodedBodySize(size_t bodySize) {
+	return bodySize / 4 * 3 + (bodySize % 4 == 0 ? 0 : bodySize % 4 - 1);
+}
+
+// Scalar
+
+bool decodeScalar(const char* src, size_t size, char* dst) {
+	const auto* s = reinterpret_cast<const uint8_t*>(src);
+	const auto* end = s + size;
+	for(; end - s >= 4; s += 4, dst += 3) {
+		const uint32_t a = DecodingTable[s[0]], b = DecodingTable[s[1]], c = DecodingTable[s[2]], d = DecodingTable[s[3]];
+		if((a | b | c | d) & 0x80) // Invalid
+			return false;
+		const uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+		dst[0] = static_cast<char>(v >> 16);
+		dst[1] = static_cast<char>(v >> 8);
+		dst[2] = static_cast<char>(v);
+	}
+	// 2 or 3 remaining characters: 1 or 2 bytes
+	if(s < end) {
+		uint32_t v = 0;
+		uint32_t check = 0;
+		const auto remaining = end - s;
+		for(ptrdiff_t i = 0; i < 4; ++i) {
+			const uint32_t x = i < remaining ? DecodingTable[s[i]] : 0;
+			check |= x;
+			v = (v << 6) | x;
+		}
+		if(check & 0x80)
+			return false;
+		dst[0] = static_cast<char>(v >> 16);
+		if(remaining == 3)
+			dst[1] = static_cast<char>(v >> 8);
+	}
+	return true;
+}
+
+// SSSE3
+
+#if defined(BASE64_SIMD_SSSE3)
+// Translates 16 characters to their 6bit values. Returns false if any of them is not part of the alphabet.
+// The low and high nibbles of each character index two tables whose entries share a bit only for invalid characters; a third table, indexed by the
+// high nibble ('/' being the only special case), gives the offset to add to the character.
+inline bool translateSSSE3(__m128i& v) {
+	const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+	const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m128i mask2F = _mm_set1_epi8(0x2F);
+
+	const __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(v, 4), mask2F);
+	const __m128i loNibbles = _mm_and_si128(v, mask2F);
+	const __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+	const __m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+	if(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0)
+		return false;
+	const __m128i eq2F = _mm_cmpeq_epi8(v, mask2F);
+	v = _mm_add_epi8(v, _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles)));
+	return true;
+}
+
+// Packs the 6bit values of each group of 4 bytes into 3 bytes, in the first 12 bytes of the register.
+inline __m128i packSSSE3(__m128i v) {
+	const __m128i merged = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));  // a << 6 | b, c << 6 | d
+	const __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000)); // ab << 12 | cd
+	return _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+}
+
+// Decodes blocks of 16 characters as long as the 16 bytes stores fit in dst. Returns the number of characters decoded, stops at the first invalid block.
+size_t decodeSSSE3(const char* src, size_t size, char* dst, size_t dstSize) {
+	size_t i = 0;
+	for(; i + 16 <= size && i / 4 * 3 + 16 <= dstSize; i += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		if(!translateSSSE3(v))
+			break;
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i / 4 * 3), packSSSE3(v));
+	}
+	return i;
+}
+#endif
+
+// AVX2
+
+#if defined(BASE64_SIMD_AVX2)
+// Same as translateSSSE3, on 32 characters.
+inline bool translateAVX2(__m256i& v) {
+	const __m256i lutLo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A, 0x15, 0x11, 0x11, 0x11,
+										   0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+	const __m256i lutHi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02,
+										   0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m256i lutRoll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m256i mask2F = _mm256_set1_epi8(0x2F);
+
+	const __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(v, 4), mask2F);
+	const __m256i loNibbles = _mm256_and_si256(v, mask2F);
+	const __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+	const __m256i lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+	if(!_mm256_testz_si256(lo, hi))
+		return false;
+	const __m256i eq2F = _mm256_cmpeq_epi8(v, mask2F);
+	v = _mm256_add_epi8(v, _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles)));
+	return true;
+}
+
+// Packs into the first 24 bytes of the register.
+inline __m256i packAVX2(__m256i v) {
+	const __m256i merged = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+	const __m256i packed = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+	const __m256i lanes = _mm256_shuffle_epi8(packed, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13,
+																	   12, -1, -1, -1, -1));
+	return _mm256_permutevar8x32_epi32(lanes, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+}
+
+size_t decodeAVX2(const char* src, size_t size, char* dst, size_t dstSize) {
+	size_t i = 0;
+	for(; i + 32 <= size && i / 4 * 3 + 32 <= dstSize; i += 32) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+		if(!translateAVX2(v))
+			break;
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i / 4 * 3), packAVX2(v));
+	}
+	return i + decodeSSSE3(src + i, size - i, dst + i / 4 * 3, dstSize - i / 4 * 3);
+}
+#endif
+
+} // namespace
+
+size_t decodedSize(std::string_view str) {
+	bool valid = true;
+	return decodedBodySize(stripPadding(str, valid).size());
+}
+
+bool decode(std::string_view str, char* dst, Implementation impl) {
+	bool	   valid = true;
+	const auto body = stripPadding(str, valid);
+	if(!valid)
+		return false;
+	const size_t dstSize = decodedBodySize(body.size());
+	size_t		 decoded = 0; // Characters decoded by the SIMD implementations, always a multiple of 4
+	switch(impl) {
+#if defined(BASE64_SIMD_AVX2)
+		case Implementation::AVX2: decoded = decodeAVX2(body.data(), body.size(), dst, dstSize); break;
+#endif
+#if defined(BASE64_SIMD_SSSE3)
+		case Implementation::SSSE3: decoded = decodeSSSE3(body.data(), body.size(), dst, dstSize); break;
+#endif
+		default: break;
+	}
+	return decodeScalar(body.data() + decoded, body.size() - decoded, dst + decoded / 4 * 3);
+}
+
+std::vector<char> decode(std::string_view str) {
+	std::vector<char> result(decodedSize(str));
+	if(!decode(str, result.data())) {
+		error("Base64::decode: Invalid input ({} characters).\n", str.size());
+		return {};
+	}
+	return result;
+}
+
+} // namespace Base64
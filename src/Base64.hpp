@@ -1,77 +1,46 @@
 #pragma once
 
-#include <array>
-#include <cassert>
+#include <cstddef>
 #include <string_view>
 #include <vector>
 
-char decodeBase64(char c) {
-	if(c >= 'A' && c <= 'Z')
-		return c - 'A';
-	if(c >= 'a' && c <= 'z')
-		return 26 + c - 'a';
-	if(c >= '0' && c <= '9')
-		return 52 + c - '0';
-	if(c == '+')
-		return 62;
-	if(c == '/')
-		return 63;
-	assert(false);
-	return 0;
-}
+#if defined(__AVX2__)
+	#define BASE64_SIMD_AVX2
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+	#define BASE64_SIMD_SSSE3
+#endif
 
-std::vector<char> decodeBase64(const std::string_view& str) {
-	assert(str.size() % 4 == 0); // We only support padded string for now.
-	std::vector<char> result;
-	result.reserve(str.size() / 4 * 3);
-	for(size_t i = 0; i < str.size() / 4 - 1; ++i) {
-		std::array<char, 4> d{
-			decodeBase64(str[4 * i + 0]),
-			decodeBase64(str[4 * i + 1]),
-			decodeBase64(str[4 * i + 2]),
-			decodeBase64(str[4 * i + 3]),
-		};
-		int32_t data = (d[0] << 18) | (d[1] << 12) | (d[2] << 6) | d[3];
-		result.push_back(static_cast<char>((data >> 2 * 8) & 0xFF));
-		result.push_back(static_cast<char>((data >> 1 * 8) & 0xFF));
-		result.push_back(static_cast<char>((data >> 0 * 8) & 0xFF));
-	}
-	// Last quadruplet may contain padding
-	if(str.size() % 4 != 0) {
-		// TODO
-	} else {
-		const auto i = str.size() / 4 - 1;
-		// May contain padding character(s)
-		if(str[str.size() - 1] == '=') {
-			if(str[str.size() - 2] == '=') {
-				std::array<char, 2> d{
-					decodeBase64(str[4 * i + 0]),
-					decodeBase64(str[4 * i + 1]),
-				};
-				int32_t data = (d[0] << 18) | ((d[1] << 12) & 0b110000);
-				result.push_back(static_cast<char>((data >> 2 * 8) & 0xFF));
-			} else {
-				std::array<char, 3> d{
-					decodeBase64(str[4 * i + 0]),
-					decodeBase64(str[4 * i + 1]),
-					decodeBase64(str[4 * i + 2]),
-				};
-				int32_t data = (d[0] << 18) | (d[1] << 12) | ((d[2] << 6) & 0b111100);
-				result.push_back(static_cast<char>((data >> 2 * 8) & 0xFF));
-				result.push_back(static_cast<char>((data >> 1 * 8) & 0xFF));
-			}
-		} else {
-			std::array<char, 4> d{
-				decodeBase64(str[4 * i + 0]),
-				decodeBase64(str[4 * i + 1]),
-				decodeBase64(str[4 * i + 2]),
-				decodeBase64(str[4 * i + 3]),
-			};
-			int32_t data = (d[0] << 18) | (d[1] << 12) | (d[2] << 6) | d[3];
-			result.push_back(static_cast<char>((data >> 2 * 8) & 0xFF));
-			result.push_back(static_cast<char>((data >> 1 * 8) & 0xFF));
-			result.push_back(static_cast<char>((data >> 0 * 8) & 0xFF));
-		}
-	}
-	return result;
-}
+// Base64 decoding (RFC 4648, standard alphabet), used for the buffers embedded in glTF files as data URIs.
+// Padding is optional, but must only appear at the end of the input. Whitespace and other characters outside of the alphabet are rejected.
+// The unused bits of the last character are ignored.
+// The SIMD implementations decode 16 (SSSE3) or 32 (AVX2) characters per iteration using nibble lookup tables (W. Muła and D. Lemire's method),
+// the remaining characters and invalid inputs are handled by the scalar decoder (lookup table).
+namespace Base64 {
+
+enum class Implementation {
+	Scalar,
+	SSSE3,
+	AVX2,
+};
+
+// Best implementation available in this build.
+static constexpr Implementation BestImplementation =
+#if defined(BASE64_SIMD_AVX2)
+	Implementation::AVX2;
+#elif defined(BASE64_SIMD_SSSE3)
+	Implementation::SSSE3;
+#else
+	Implementation::Scalar;
+#endif
+
+// Size of the decoded data, if str is valid.
+size_t decodedSize(std::string_view str);
+
+// Decodes str into dst, which must hold at least decodedSize(str) bytes. Returns false if str is not valid Base64 (the content of dst is then undefined).
+bool decode(std::string_view str, char* dst, Implementation impl = BestImplementation);
+
+// Returns an empty vector (and logs an error) if str is not valid Base64.
+std::vector<char> decode(std::string_view str);
+
+} // namespace Base64
@@ -0,0 +1,762 @@
+#include "Benchmarks.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include <fmt/ostream.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <Base64.hpp>
+#include <Gltf.hpp>
+#include <JSON.hpp>
+#include <JSONBinary.hpp>
+#include <JSONDocument.hpp>
+#include <JSONStructuralIndex.hpp>
+#include <JSONWriter.hpp>
+#include <Logger.hpp>
+#include <OBJ.hpp>
+#include <Raytracing.hpp>
+#include <Scene.hpp>
+#include <ThreadPool.hpp>
+#include <VertexKernels.hpp>
+
+static std::string readFile(const std::filesystem::path& path) {
+	std::ifstream file{path, std::ios::binary | std::ios::ate};
+	if(!file)
+		return {};
+	std::string content(static_cast<size_t>(file.tellg()), '\0');
+	file.seekg(0, std::ios::beg);
+	file.read(content.data(), content.size());
+	return content;
+}
+
+// Runs func enough times to process at least a few MB of data and returns the throughput in MB/s.
+template<typename Func>
+static double measureThroughput(size_t bytesPerIteration, Func&& func) {
+	constexpr size_t TargetBytes = 64 * 1024 * 1024;
+	const size_t	 iterations = std::max<size_t>(8, TargetBytes / std::max<size_t>(1, bytesPerIteration));
+	const auto		 start = std::chrono::high_resolution_clock::now();
+	for(size_t i = 0; i < iterations; ++i)
+		func();
+	const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+	return (static_cast<double>(bytesPerIteration) * iterations) / (1024.0 * 1024.0) / elapsed.count();
+}
+
+// Approximate heap usage of a DOM (values, keys and packed buffers, ignoring the containers overhead).
+static size_t estimateDOMSize(const JSON::value& v) {
+	switch(v.getType()) {
+		case JSON::value::Type::string: return v.asString().capacity();
+		case JSON::value::Type::array: {
+			if(v.isPackedFloats())
+				return v.asFloats().size() * sizeof(float);
+			if(v.isPackedIntegers())
+				return v.asIntegers().size() * sizeof(int);
+			size_t size = v.asArray().capacity() * sizeof(JSON::value);
+			for(const auto& e : v.asArray())
+				size += estimateDOMSize(e);
+			return size;
+		}
+		case JSON::value::Type::object: {
+			size_t size = 0;
+			for(const auto& [key, member] : v.asObject())
+				size += sizeof(JSON::value) + key.capacity() + estimateDOMSize(member);
+			return size;
+		}
+		default: return 0;
+	}
+}
+
+// Vertex count of the first primitive of the first mesh of a glTF document: What's needed to start loading geometry.
+template<typename Node>
+static int firstMeshVertexCount(const Node& root) {
+	const auto position = root["meshes"][0]["primitives"][0]["attributes"]["POSITION"].template as<int>();
+	return root["accessors"][position]["count"].template as<int>();
+}
+
+void benchmarkJSONParsing(const std::vector<std::filesystem::path>& corpus) {
+	print("JSON Parsing Benchmark\n");
+	for(const auto& path : corpus) {
+		const auto content = readFile(path);
+		if(content.empty()) {
+			warn("  Could not read '{}', skipping.\n", path.string());
+			continue;
+		}
+
+		const auto stream = measureThroughput(content.size(), [&]() {
+			std::istringstream iss{content};
+			JSON			   json;
+			json.parse(iss);
+		});
+		const auto buffer = measureThroughput(content.size(), [&]() {
+			JSON json;
+			json.parse(std::string_view{content}, JSON::ParseOptions{.useStructuralIndex = false});
+		});
+		const auto indexed = measureThroughput(content.size(), [&]() {
+			JSON json;
+			json.parse(std::string_view{content}, JSON::ParseOptions{.useStructuralIndex = true});
+		});
+		const auto packed = measureThroughput(content.size(), [&]() {
+			JSON json;
+			json.parse(std::string_view{content}, JSON::ParseOptions{.packNumericArrays = true});
+		});
+		const auto document = measureThroughput(content.size(), [&]() {
+			JSON::Document doc;
+			doc.parse(std::string_view{content});
+		});
+		JSON::Document doc;
+		doc.parse(std::string_view{content});
+		JSON unpackedDOM, packedDOM;
+		unpackedDOM.parse(std::string_view{content});
+		packedDOM.parse(std::string_view{content}, JSON::ParseOptions{.packNumericArrays = true});
+
+		print("  {} ({} bytes)\n", path.string(), content.size());
+		print("    Stream:          {:>10.2f} MB/s\n", stream);
+		print("    Buffer (Scalar): {:>10.2f} MB/s (x{:.2f})\n", buffer, buffer / stream);
+		print("    Buffer (Index):  {:>10.2f} MB/s (x{:.2f})\n", indexed, indexed / stream);
+		print("    Buffer (Packed): {:>10.2f} MB/s (x{:.2f}, DOM: ~{} bytes, {} unpacked)\n", packed, packed / stream, estimateDOMSize(packedDOM.getRoot()),
+			  estimateDOMSize(unpackedDOM.getRoot()));
+		print("    Document:        {:>10.2f} MB/s (x{:.2f}, arena: {} bytes)\n", document, document / stream, doc.getArenaSize());
+		if(path.extension() == ".gltf") {
+			// Single pass into typed tables, no DOM at all
+			const auto gltf = measureThroughput(content.size(), [&]() {
+				GltfAsset asset;
+				asset.parse(content);
+			});
+			print("    glTF Reader:     {:>10.2f} MB/s (x{:.2f})\n", gltf, gltf / stream);
+
+			// Time to first mesh: From the JSON text to the description of the first primitive.
+			int		   sink = 0;
+			const auto toMicroseconds = [&](double throughput) { return static_cast<double>(content.size()) / (throughput * 1024.0 * 1024.0) * 1e6; };
+			const auto dom = measureThroughput(content.size(), [&]() {
+				JSON json;
+				json.parse(std::string_view{content});
+				sink += firstMeshVertexCount(json.getRoot());
+			});
+			const auto eager = measureThroughput(content.size(), [&]() {
+				JSON::Document doc;
+				doc.parse(std::string_view{content});
+				sink += firstMeshVertexCount(doc.getRoot());
+			});
+			const auto lazy = measureThroughput(content.size(), [&]() {
+				JSON::Document doc;
+				doc.parse(std::string_view{content}, JSON::Document::ParseOptions{.lazy = true});
+				sink += firstMeshVertexCount(doc.getRoot());
+			});
+			const auto reader = measureThroughput(content.size(), [&]() {
+				GltfAsset asset;
+				asset.parse(content);
+				sink += asset.accessors[asset.meshes[0].primitives[0].attributes.position].count;
+			});
+			print("    Time to first mesh: DOM {:.1f}us, Document {:.1f}us, Lazy Document {:.1f}us, glTF Reader {:.1f}us ({})\n", toMicroseconds(dom), toMicroseconds(eager),
+				  toMicroseconds(lazy), toMicroseconds(reader), sink > 0 ? "ok" : "no mesh");
+		}
+
+		// Structural index construction alone (first stage of the indexed parser)
+		const std::pair<JSONStructuralIndex::Implementation, const char*> implementations[]{
+			{JSONStructuralIndex::Implementation::Scalar, "Scalar"},
+#if defined(JSON_SIMD_SSE2)
+			{JSONStructuralIndex::Implementation::SSE2, "SSE2"},
+#endif
+#if defined(JSON_SIMD_AVX2)
+			{JSONStructuralIndex::Implementation::AVX2, "AVX2"},
+#endif
+		};
+		JSONStructuralIndex index;
+		for(const auto& [impl, name] : implementations) {
+			const auto throughput = measureThroughput(content.size(), [&]() { index.build(content, impl); });
+			print("    Index ({:<6}):   {:>10.2f} GB/s\n", name, throughput / 1024.0);
+		}
+	}
+}
+
+static void getBenchmarkTransform(float (&transform)[16]) {
+	for(int i = 0; i < 16; ++i)
+		transform[i] = 0.1f * static_cast<float>(i) + 1.0f / 3.0f;
+}
+
+// Same layout as Scene::save: Name, 16 floats transform and a few indices per entity. Writer is either a JSON::Writer or a JSON::BinaryWriter.
+template<typename Writer>
+static void writeBenchmarkEntities(Writer& json, size_t entityCount) {
+	float transform[16];
+	getBenchmarkTransform(transform);
+	json.beginObject();
+	json.key("entities").beginArray();
+	for(size_t i = 0; i < entityCount; ++i) {
+		json.beginObject();
+		json.write("name", "Entity \"" + std::to_string(i) + "\"");
+		json.write("transform", std::span<const float>{transform, 16});
+		json.write("parent", -1);
+		json.key("children").beginArray().write(i + 1).endArray();
+		json.key("meshRenderer").beginObject().write("meshIndex", static_cast<int>(i)).write("materialIndex", 0).endObject();
+		json.endObject();
+	}
+	json.endArray();
+	json.endObject();
+}
+
+void benchmarkJSONWriting(size_t entityCount) {
+	print("JSON Writing Benchmark ({} scene-like entities)\n", entityCount);
+	float transform[16];
+	getBenchmarkTransform(transform);
+	const auto writeEntities = [&](JSON::Writer& json) { writeBenchmarkEntities(json, entityCount); };
+
+	size_t bytes = 0;
+	{
+		JSON::Writer json;
+		writeEntities(json);
+		bytes = json.getBuffer().size();
+	}
+
+	JSON::array entities;
+	for(size_t i = 0; i < entityCount; ++i)
+		entities.push_back(JSON::object{
+			{"name", "Entity \"" + std::to_string(i) + "\""},
+			{"transform", JSON::array(transform, transform + 16)},
+			{"parent", -1},
+			{"children", JSON::array{static_cast<int>(i + 1)}},
+			{"meshRenderer", JSON::object{{"meshIndex", static_cast<int>(i)}, {"materialIndex", 0}}},
+		});
+	const JSON::value dom{JSON::object{{"entities", std::move(entities)}}};
+
+	const auto streaming = measureThroughput(bytes, [&]() {
+		JSON::Writer json;
+		writeEntities(json);
+	});
+	const auto fromDOM = measureThroughput(bytes, [&]() { JSON::toString(dom.asObject()); });
+	const auto toStream = measureThroughput(bytes, [&]() {
+		std::ostringstream oss;
+		JSON::Writer	   json{oss};
+		writeEntities(json);
+	});
+
+	print("  Output size: {} bytes\n", bytes);
+	print("    Writer (buffer):      {:>10.2f} MB/s\n", streaming);
+	print("    Writer (ostream):     {:>10.2f} MB/s\n", toStream);
+	print("    JSON::toString (DOM): {:>10.2f} MB/s (DOM already built)\n", fromDOM);
+}
+
+// Reads every entity like Scene::loadScene does, returns a checksum so the work can't be optimized away.
+static float walkBenchmarkEntities(const JSON::Document& doc) {
+	float sum = 0;
+	for(const auto& n : doc["entities"]) {
+		sum += static_cast<float>(n["name"].size());
+		for(const auto& f : n["transform"])
+			sum += f.to<float>();
+		for(const auto& c : n["children"])
+			sum += static_cast<float>(c.as<int>());
+		if(n.contains("meshRenderer"))
+			sum += static_cast<float>(n["meshRenderer"]["meshIndex"].as<int>() + n["meshRenderer"]["materialIndex"].as<int>());
+	}
+	return sum;
+}
+
+void benchmarkSceneJSONLoading(size_t entityCount) {
+	print("Scene JSON Loading Benchmark ({} entities)\n", entityCount);
+	JSON::Writer text;
+	writeBenchmarkEntities(text, entityCount);
+	JSON::BinaryWriter binary;
+	writeBenchmarkEntities(binary, entityCount);
+	const auto& textData = text.getBuffer();
+	const auto	binaryData = binary.getEncoded();
+
+	float	   sink = 0;
+	const auto fromText = measureThroughput(textData.size(), [&]() {
+		JSON::Document doc;
+		doc.parse(std::string_view{textData});
+		sink += walkBenchmarkEntities(doc);
+	});
+	const auto fromBinary = measureThroughput(textData.size(), [&]() {
+		JSON::Document doc;
+		doc.parseBinary(binaryData);
+		sink += walkBenchmarkEntities(doc);
+	});
+	const auto encoding = measureThroughput(textData.size(), [&]() {
+		JSON::BinaryWriter json;
+		writeBenchmarkEntities(json, entityCount);
+		json.getEncoded();
+	});
+
+	// Throughputs are relative to the size of the text, so they compare directly.
+	print("  Text: {} bytes, Binary: {} bytes ({:.1f}%)\n", textData.size(), binaryData.size(), 100.0 * binaryData.size() / textData.size());
+	print("    Text (Document + walk):   {:>10.2f} MB/s\n", fromText);
+	print("    Binary (Document + walk): {:>10.2f} MB/s (x{:.2f})\n", fromBinary, fromBinary / fromText);
+	print("    Binary encoding:          {:>10.2f} MB/s ({})\n", encoding, sink > 0 ? "ok" : "empty");
+}
+
+void benchmarkVertexKernels(size_t vertexCount) {
+	using namespace VertexKernels;
+	print("Vertex Kernels Benchmark ({} vertices)\n", vertexCount);
+
+	// Same size as Vertex (pos, color, normal, tangent, texCoord and padding), destination of the scatters.
+	struct AoSVertex {
+		float pos[3], color[3], normal[3], tangent[4], texCoord[2];
+		uint32_t padding;
+	};
+	static_assert(sizeof(AoSVertex) == 64);
+	// Typical interleaved glTF vertex buffer: position, normal, texCoord (32 bytes per vertex).
+	constexpr size_t  InterleavedStride = 32;
+	std::vector<char> interleaved(vertexCount * InterleavedStride);
+	std::vector<char> packed(vertexCount * 16); // vec4, u8x4 / u16x4 joints, normalized u8x4 weights, u8 / u16 indices...
+	for(size_t i = 0; i < interleaved.size(); ++i)
+		interleaved[i] = static_cast<char>(i * 7);
+	for(size_t i = 0; i < packed.size(); ++i)
+		packed[i] = static_cast<char>(i * 13);
+
+	std::vector<AoSVertex> vertices(vertexCount);
+	std::vector<glm::vec3> vec3s(vertexCount);
+	std::vector<glm::vec4> vec4s(vertexCount);
+	std::vector<uint16_t>  joints(4 * vertexCount);
+	std::vector<uint32_t>  indices(vertexCount);
+
+	struct Kernel {
+		const char*							name;
+		size_t								bytes; // Source bytes per call
+		std::function<void(Implementation)> run;
+	};
+	const Kernel kernels[]{
+		{"Position (vec3 interleaved -> AoS)", 12 * vertexCount,
+		 [&](Implementation impl) { copy(vertices[0].pos, sizeof(AoSVertex), interleaved.data(), InterleavedStride, 12, vertexCount, impl); }},
+		{"TexCoord (vec2 interleaved -> AoS)", 8 * vertexCount,
+		 [&](Implementation impl) { copy(vertices[0].texCoord, sizeof(AoSVertex), interleaved.data() + 24, InterleavedStride, 8, vertexCount, impl); }},
+		{"Position (vec3 interleaved -> packed)", 12 * vertexCount,
+		 [&](Implementation impl) { copy(vec3s.data(), sizeof(glm::vec3), interleaved.data(), InterleavedStride, 12, vertexCount, impl); }},
+		{"Tangent (vec4 packed -> AoS)", 16 * vertexCount,
+		 [&](Implementation impl) { copy(vertices[0].tangent, sizeof(AoSVertex), packed.data(), 16, 16, vertexCount, impl); }},
+		{"TexCoord (normalized u16x2 -> AoS)", 4 * vertexCount,
+		 [&](Implementation impl) { toFloat(vertices[0].texCoord, sizeof(AoSVertex), packed.data(), 4, ComponentType::UnsignedShort, 2, true, vertexCount, impl); }},
+		{"Normal (normalized i8x3 -> AoS)", 4 * vertexCount,
+		 [&](Implementation impl) { toFloat(vertices[0].normal, sizeof(AoSVertex), packed.data(), 4, ComponentType::Byte, 3, true, vertexCount, impl); }},
+		{"Weights (normalized u8x4 -> vec4)", 4 * vertexCount,
+		 [&](Implementation impl) { toFloat(&vec4s[0].x, sizeof(glm::vec4), packed.data(), 4, ComponentType::UnsignedByte, 4, true, vertexCount, impl); }},
+		{"Joints (u8x4 -> u16x4)", 4 * vertexCount,
+		 [&](Implementation impl) { toU16x4(joints.data(), 4 * sizeof(uint16_t), packed.data(), 4, ComponentType::UnsignedByte, vertexCount, impl); }},
+		{"Indices (u8 -> u32)", vertexCount, [&](Implementation impl) { widen(indices.data(), packed.data(), 1, ComponentType::UnsignedByte, vertexCount, impl); }},
+		{"Indices (u16 -> u32)", 2 * vertexCount,
+		 [&](Implementation impl) { widen(indices.data(), packed.data(), 2, ComponentType::UnsignedShort, vertexCount, impl); }},
+		{"Indices (generated)", 4 * vertexCount, [&](Implementation impl) { iota(indices.data(), vertexCount, 0, impl); }},
+	};
+
+	const std::pair<Implementation, const char*> implementations[]{
+		{Implementation::Scalar, "Scalar"},
+#if defined(VERTEX_SIMD_SSE2)
+		{Implementation::SSE2, "SSE2"},
+#endif
+#if defined(VERTEX_SIMD_AVX2)
+		{Implementation::AVX2, "AVX2"},
+#endif
+	};
+	for(const auto& kernel : kernels) {
+		print("  {}\n", kernel.name);
+		for(const auto& [impl, name] : implementations) {
+			const auto throughput = measureThroughput(kernel.bytes, [&]() { kernel.run(impl); });
+			print("    {:<6}: {:>10.2f} GB/s\n", name, throughput / 1024.0);
+		}
+	}
+	// Reference: The push_back loop previously used by extract<T>, same work as "Position (vec3 interleaved -> packed)".
+	const auto pushBack = measureThroughput(12 * vertexCount, [&]() {
+		std::vector<glm::vec3> data;
+		data.reserve(vertexCount);
+		for(size_t i = 0; i < vertexCount; ++i)
+			data.push_back(*reinterpret_cast<const glm::vec3*>(interleaved.data() + i * InterleavedStride));
+	});
+	print("  Position (vec3 interleaved -> packed, push_back loop)\n    {:<6}: {:>10.2f} GB/s\n", "Scalar", pushBack / 1024.0);
+}
+
+void benchmarkSceneLoading(const std::vector<std::filesystem::path>& files) {
+	using Clock = std::chrono::high_resolution_clock;
+	const auto milliseconds = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+	print("Scene Loading Benchmark ({} files)\n", files.size());
+
+	// Loading adds to the global resources: They're restored after each run.
+	const auto materialCount = Materials.size();
+	const auto textureCount = Textures.size();
+	const auto animationCount = Animations.size();
+	const auto restoreResources = [&]() {
+		Materials.erase(Materials.begin() + materialCount, Materials.end());
+		Textures.erase(Textures.begin() + textureCount, Textures.end());
+		Animations.erase(Animations.begin() + animationCount, Animations.end());
+	};
+
+	size_t syncMeshes = 0;
+	double syncTotal = 0;
+	{
+		Scene	   scene;
+		const auto start = Clock::now();
+		for(const auto& path : files)
+			scene.load(path);
+		syncTotal = milliseconds(Clock::now() - start);
+		syncMeshes = scene.getMeshes().size();
+	}
+	restoreResources();
+
+	size_t asyncMeshes = 0;
+	size_t batches = 0;
+	double firstMesh = -1;
+	double asyncTotal = 0;
+	{
+		Scene	   scene;
+		const auto start = Clock::now();
+		for(const auto& path : files)
+			scene.loadAsync(path);
+		while(scene.isLoading()) {
+			if(scene.publishLoads())
+				++batches;
+			if(firstMesh < 0 && !scene.getMeshes().empty())
+				firstMesh = milliseconds(Clock::now() - start);
+			std::this_thread::yield(); // Stands in for the rest of a frame
+		}
+		asyncTotal = milliseconds(Clock::now() - start);
+		asyncMeshes = scene.getMeshes().size();
+	}
+	restoreResources();
+
+	print("  Synchronous:  {:>10.2f} ms total, {} meshes\n", syncTotal, syncMeshes);
+	print("  Asynchronous: {:>10.2f} ms total, {} meshes in {} batches\n", asyncTotal, asyncMeshes, batches);
+	print("                {:>10.2f} ms to the first mesh ({:.1f}% of the synchronous load)\n", firstMesh, 100.0 * firstMesh / syncTotal);
+}
+
+void benchmarkOBJLoading(size_t faceCount) {
+	using Clock = std::chrono::high_resolution_clock;
+	const auto milliseconds = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+	// Square grid of quads (about faceCount of them), with a position and a texture coordinate per vertex and a shared normal.
+	const size_t	  side = std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(faceCount))));
+	std::stringstream ss;
+	for(size_t y = 0; y <= side; ++y)
+		for(size_t x = 0; x <= side; ++x)
+			fmt::print(ss, "v {:.6f} {:.6f} {:.6f}\n", x * 0.01, 0.001 * static_cast<double>((x * 7 + y * 13) % 100), y * -0.01);
+	for(size_t y = 0; y <= side; ++y)
+		for(size_t x = 0; x <= side; ++x)
+			fmt::print(ss, "vt {:.6f} {:.6f}\n", static_cast<double>(x) / side, static_cast<double>(y) / side);
+	ss << "vn 0 1 0\n";
+	const auto vertex = [&](size_t x, size_t y) { return y * (side + 1) + x + 1; };
+	for(size_t y = 0; y < side; ++y)
+		for(size_t x = 0; x < side; ++x) {
+			const size_t a = vertex(x, y), b = vertex(x + 1, y), c = vertex(x + 1, y + 1), d = vertex(x, y + 1);
+			fmt::print(ss, "f {}/{}/1 {}/{}/1 {}/{}/1 {}/{}/1\n", a, a, b, b, c, c, d, d);
+		}
+	const auto content = ss.str();
+	print("OBJ Loading Benchmark ({} faces, {:.1f} MB)\n", side * side, content.size() / (1024.0 * 1024.0));
+
+	// Floats alone, on the vertex lines
+	{
+		const auto	vertices = std::string_view{content}.substr(0, content.find("vn"));
+		std::string numbers;
+		for(char c : vertices)
+			if(c != 'v' && c != 't')
+				numbers += c;
+		const auto parseAll = [&](auto&& parse) {
+			float		sum = 0, f = 0;
+			const char* cur = numbers.data();
+			const char* end = cur + numbers.size();
+			while(cur < end) {
+				while(cur < end && (*cur == ' ' || *cur == '\n'))
+					++cur;
+				if(cur < end)
+					cur = parse(cur, end, f);
+				sum += f;
+			}
+			return sum;
+		};
+		volatile float sink = 0;
+		const auto	   fromChars = measureThroughput(numbers.size(), [&]() { sink = parseAll([](const char* b, const char* e, float& f) { return std::from_chars(b, e, f).ptr; }); });
+		const auto	   custom = measureThroughput(numbers.size(), [&]() { sink = parseAll([](const char* b, const char* e, float& f) { return OBJ::parseFloat(b, e, f); }); });
+		print("  {:<32} {:>10.1f} MB/s\n", "Floats (std::from_chars)", fromChars);
+		print("  {:<32} {:>10.1f} MB/s\n", "Floats (OBJ::parseFloat)", custom);
+	}
+
+	for(const auto& [name, chunkSize] : {std::pair{"Parse (single chunk)", size_t{0}}, std::pair{"Parse (parallel chunks)", OBJ::ParseOptions{}.chunkSize}}) {
+		OBJ::Data  data;
+		const auto start = Clock::now();
+		OBJ::parse(content, data, {.chunkSize = chunkSize});
+		const auto ms = milliseconds(Clock::now() - start);
+		print("  {:<32} {:>10.2f} ms, {:>8.1f} MB/s, {:.1f}M triangles/s\n", name, ms, content.size() / (1024.0 * 1024.0) / (ms / 1000.0),
+			  data.corners.size() / 3 / 1000.0 / ms);
+	}
+
+	// Complete import: Parsing, vertices deduplication and normals/tangents generation (without the mesh deduplication and optimization passes).
+	const auto path = std::filesystem::temp_directory_path() / "VulkanExpBenchmark.obj";
+	{
+		std::ofstream file{path, std::ios::binary};
+		file.write(content.data(), content.size());
+	}
+	{
+		Scene scene;
+		scene.deduplicateImportedMeshes = false;
+		scene.optimizeImportedMeshes = false;
+		const auto start = Clock::now();
+		scene.load(path);
+		const auto ms = milliseconds(Clock::now() - start);
+		size_t	   vertices = 0;
+		for(const auto& m : scene.getMeshes())
+			vertices += m.getVertices().size();
+		print("  {:<32} {:>10.2f} ms, {} vertices\n", "Scene::load", ms, vertices);
+	}
+	std::filesystem::remove(path);
+}
+
+void benchmarkBase64Decoding(size_t size) {
+	using namespace Base64;
+	print("Base64 Decoding Benchmark ({:.1f} MB decoded)\n", size / (1024.0 * 1024.0));
+
+	constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	std::string				   encoded((size + 2) / 3 * 4, '=');
+	for(size_t i = 0; i < size / 3 * 4 + (size % 3 == 0 ? 0 : size % 3 + 1); ++i)
+		encoded[i] = alphabet[(i * 7 + i / 5) % 64];
+	std::vector<char> decoded(decodedSize(encoded));
+
+	const std::pair<Implementation, const char*> implementations[]{
+		{Implementation::Scalar, "Scalar"},
+#if defined(BASE64_SIMD_SSSE3)
+		{Implementation::SSSE3, "SSSE3"},
+#endif
+#if defined(BASE64_SIMD_AVX2)
+		{Implementation::AVX2, "AVX2"},
+#endif
+	};
+	std::vector<char> reference;
+	for(const auto& [impl, name] : implementations) {
+		bool	   valid = true;
+		const auto throughput = measureThroughput(encoded.size(), [&]() { valid = decode(encoded, decoded.data(), impl) && valid; });
+		if(reference.empty())
+			reference = decoded;
+		print("  {:<8} {:>10.1f} MB/s (encoded){}\n", name, throughput, !valid ? " INVALID" : (decoded != reference ? " MISMATCH" : ""));
+	}
+}
+
+// Static level: Complete tree of fanOut children per node (the children of node j are fanOut * j + 1 to fanOut * j + fanOut), every node rendering the
+// same mesh. Returns the nodes, root included.
+static std::vector<entt::entity> buildBenchmarkHierarchy(Scene& scene, size_t nodeCount, size_t fanOut) {
+	auto& registry = scene.getRegistry();
+	auto& mesh = scene.getMeshes().emplace_back();
+	mesh.setBounds({.min = glm::vec3(-1.0f), .max = glm::vec3(1.0f)});
+	std::vector<entt::entity> nodes{scene.getRoot()};
+	nodes.reserve(nodeCount + 1);
+	for(size_t i = 1; i <= nodeCount; ++i) {
+		const auto entity = registry.create();
+		registry.emplace<NodeComponent>(entity).transform = glm::translate(glm::mat4(1.0f), glm::vec3(static_cast<float>(i % 100), 0.0f, static_cast<float>(i / 100)));
+		registry.emplace<MeshRendererComponent>(entity, MeshIndex{0u});
+		scene.addChild(nodes[(i - 1) / fanOut], entity);
+		nodes.push_back(entity);
+	}
+	return nodes;
+}
+
+void benchmarkSceneUpdate(const std::vector<size_t>& sceneSizes, const std::vector<size_t>& movedNodes) {
+	using Clock = std::chrono::high_resolution_clock;
+	constexpr size_t FanOut = 16;
+	constexpr size_t Frames = 32;
+	print("Scene Update Benchmark (average over {} frames, serial)\n", Frames);
+
+	for(const auto nodeCount : sceneSizes) {
+		Scene scene;
+		scene.parallelUpdate = false; // See benchmarkParallelSceneUpdate
+		auto&	   registry = scene.getRegistry();
+		const auto nodes = buildBenchmarkHierarchy(scene, nodeCount, FanOut);
+		scene.update(0);
+		scene.computeBounds();
+
+		const auto measure = [&](auto&& frame) {
+			const auto start = Clock::now();
+			for(size_t f = 0; f < Frames; ++f)
+				frame(f);
+			return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / Frames;
+		};
+		// Transforms only: Bounds are not grown while they are invalid.
+		scene.setBounds({.min = glm::vec3(1.0f), .max = glm::vec3(-1.0f)});
+		// Reference: Depth-first traversal following the links of NodeComponent through the registry (Scene::update before TransformHierarchy).
+		std::vector<std::pair<entt::entity, const glm::mat4*>> stack;
+		const auto traversal = measure([&](size_t) {
+			auto& root = registry.get<NodeComponent>(scene.getRoot());
+			for(auto child = root.first; child != entt::null; child = registry.get<NodeComponent>(child).next)
+				stack.push_back({child, &root.globalTransform});
+			while(!stack.empty()) {
+				const auto [entity, parentTransform] = stack.back();
+				stack.pop_back();
+				auto& node = registry.get<NodeComponent>(entity);
+				node.globalTransform = *parentTransform * node.transform;
+				for(auto child = node.first; child != entt::null; child = registry.get<NodeComponent>(child).next)
+					stack.push_back({child, &node.globalTransform});
+			}
+		});
+		print("  {:>8} nodes: {:>10.1f} us for the transforms of the whole hierarchy (registry traversal)\n", nodeCount, traversal);
+		const auto flattened = measure([&](size_t) {
+			scene.markDirty(scene.getRoot());
+			scene.update(0);
+		});
+		print("  {:>8} nodes: {:>10.1f} us for the transforms of the whole hierarchy (flattened hierarchy)\n", nodeCount, flattened);
+		const auto exactBounds = measure([&](size_t) { scene.computeBounds(); });
+		print("  {:>8} nodes: {:>10.1f} us for the exact bounds\n", nodeCount, exactBounds);
+		const auto full = measure([&](size_t) {
+			scene.markDirty(scene.getRoot());
+			scene.update(0);
+		});
+		print("  {:>8} nodes: {:>10.1f} us for the whole hierarchy (transforms and bounds)\n", nodeCount, full);
+		// Structural change: The flattened hierarchy has to be rebuilt.
+		const auto relinked = measure([&](size_t) {
+			const auto leaf = nodes.back();
+			const auto parent = registry.get<NodeComponent>(leaf).parent;
+			scene.removeFromHierarchy(leaf);
+			scene.addChild(parent, leaf);
+			scene.update(0);
+		});
+		print("  {:>8} nodes: {:>10.1f} us with a relinked node (rebuild)\n", nodeCount, relinked);
+		for(const auto moved : movedNodes) {
+			if(moved > nodeCount)
+				continue;
+			// Moved nodes are leaves spread over the whole scene.
+			const size_t firstLeaf = (nodeCount - 1) / FanOut + 1;
+			const auto	 incremental = measure([&](size_t f) {
+				for(size_t i = 0; i < moved; ++i) {
+					const auto entity = nodes[firstLeaf + (i * 7919 + f * 104729) % (nodeCount + 1 - firstLeaf)];
+					registry.get<NodeComponent>(entity).transform[3].y = static_cast<float>(f % 2);
+					scene.markDirty(entity);
+				}
+				scene.update(0);
+			});
+			print("  {:>8} nodes: {:>10.1f} us with {} moved nodes\n", nodeCount, incremental, moved);
+		}
+	}
+}
+
+void benchmarkParallelSceneUpdate(size_t nodeCount, uint32_t maxConcurrency) {
+	using Clock = std::chrono::high_resolution_clock;
+	constexpr size_t Frames = 16;
+	if(maxConcurrency == 0)
+		maxConcurrency = ThreadPool::GetInstance().getThreadCount() + 1;
+	print("Parallel Scene Update Benchmark ({} nodes, average over {} frames, {} threads in the pool)\n", nodeCount, Frames, ThreadPool::GetInstance().getThreadCount());
+
+	// A few large independent subtrees (like the roots of glTF scenes) and a wide, shallow hierarchy.
+	for(const size_t fanOut : {4, 64}) {
+		Scene scene;
+		buildBenchmarkHierarchy(scene, nodeCount, fanOut);
+		scene.update(0);
+		scene.computeBounds();
+		double serial = 0.0;
+		for(uint32_t concurrency = 1; concurrency <= maxConcurrency; ++concurrency) {
+			scene.updateConcurrency = concurrency;
+			const auto start = Clock::now();
+			for(size_t f = 0; f < Frames; ++f) {
+				scene.markDirty(scene.getRoot());
+				scene.update(0);
+			}
+			const auto ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / Frames;
+			if(concurrency == 1)
+				serial = ms;
+			print("  Fan-out {:>2}, {:>2} threads: {:>8.2f} ms (x{:.2f})\n", fanOut, concurrency, ms, serial / ms);
+		}
+	}
+}
+
+void benchmarkRaycast(size_t instanceCount, size_t queryCount) {
+	using Clock = std::chrono::high_resolution_clock;
+	const auto milliseconds = [](auto duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+	print("Raycast Benchmark ({} instances, {} queries)\n", instanceCount, queryCount);
+
+	// A few bumpy grids (8k triangles each), instanced on a plane with random orientations.
+	Scene		scene;
+	auto&		registry = scene.getRegistry();
+	std::mt19937 rng(42);
+	constexpr uint32_t MeshCount = 4;
+	constexpr uint32_t GridSize = 64;
+	for(uint32_t m = 0; m < MeshCount; ++m) {
+		auto& mesh = scene.getMeshes().emplace_back();
+		for(uint32_t y = 0; y <= GridSize; ++y)
+			for(uint32_t x = 0; x <= GridSize; ++x) {
+				const auto u = static_cast<float>(x) / GridSize, v = static_cast<float>(y) / GridSize;
+				mesh.getVertices().push_back(Vertex{.pos = glm::vec3(u - 0.5f, 0.1f * std::sin(6.28f * (m + 1) * u) * std::cos(6.28f * v), v - 0.5f)});
+			}
+		for(uint32_t y = 0; y < GridSize; ++y)
+			for(uint32_t x = 0; x < GridSize; ++x) {
+				const uint32_t a = y * (GridSize + 1) + x, b = a + 1, c = a + GridSize + 1, d = c + 1;
+				mesh.getIndices().insert(mesh.getIndices().end(), {a, c, b, b, c, d});
+			}
+		mesh.computeBounds();
+	}
+	const auto						side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(instanceCount))));
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	for(size_t i = 0; i < instanceCount; ++i) {
+		const auto entity = registry.create();
+		auto&	   node = registry.emplace<NodeComponent>(entity);
+		node.transform = glm::translate(glm::mat4(1.0f), glm::vec3(2.0f * (i % side), 0.0f, 2.0f * (i / side))) *
+						 glm::rotate(glm::mat4(1.0f), 6.28f * unit(rng), glm::normalize(glm::vec3(unit(rng), 1.0f, unit(rng)))) * glm::scale(glm::mat4(1.0f), glm::vec3(1.5f));
+		registry.emplace<MeshRendererComponent>(entity, MeshIndex{static_cast<uint32_t>(i % MeshCount)});
+		scene.addChild(scene.getRoot(), entity);
+	}
+	scene.update(0);
+
+	// Rays from above the scene towards random points of the plane (most of them hit something).
+	const auto extent = 2.0f * side;
+	std::vector<Ray> rays(queryCount);
+	for(auto& r : rays) {
+		const glm::vec3 origin{extent * unit(rng), 10.0f + 10.0f * unit(rng), extent * unit(rng)};
+		r = Ray{.origin = origin, .direction = glm::normalize(glm::vec3(extent * unit(rng), 0.0f, extent * unit(rng)) - origin)};
+	}
+
+	auto start = Clock::now();
+	scene.raycast(rays[0]);
+	print("  {:<40} {:>10.2f} ms\n", "Instance BVH build (first query)", milliseconds(Clock::now() - start));
+	start = Clock::now();
+	for(auto& m : scene.getMeshes())
+		MeshBVH{m};
+	print("  {:<40} {:>10.2f} ms\n", fmt::format("Mesh BVH builds ({} meshes)", MeshCount), milliseconds(Clock::now() - start));
+
+	std::vector<Scene::RaycastHit> hits(rays.size());
+	start = Clock::now();
+	for(size_t i = 0; i < rays.size(); ++i)
+		hits[i] = scene.raycast(rays[i]);
+	auto ms = milliseconds(Clock::now() - start);
+	print("  {:<40} {:>10.0f} queries/s ({} hits)\n", "Scene::raycast", rays.size() / (ms / 1000.0),
+		  std::count_if(hits.begin(), hits.end(), [](const auto& h) { return h.hit(); }));
+
+	// Reference: Every triangle of every instance, without any bounds culling (which would share the bugs of the bounds computations). Only a few queries.
+	const size_t referenceCount = std::min<size_t>(rays.size(), 16);
+	size_t		 mismatches = 0;
+	start = Clock::now();
+	for(size_t i = 0; i < referenceCount; ++i) {
+		float depth = std::numeric_limits<float>::max();
+		scene.forEachNode([&](entt::entity entity, glm::mat4 transform) {
+			const auto* renderer = registry.try_get<MeshRendererComponent>(entity);
+			if(!renderer)
+				return;
+			const auto& mesh = scene[renderer->meshIndex];
+			// The local direction is not normalized: Distances along it are the world depths.
+			const auto		inverse = glm::inverse(transform);
+			const glm::vec3 origin = glm::vec3(inverse * glm::vec4(rays[i].origin, 1.0f));
+			const glm::vec3 direction = glm::mat3(inverse) * rays[i].direction;
+			for(size_t t = 0; t < mesh.getIndices().size(); t += 3) {
+				glm::vec2 bary{0.0f};
+				float	  distance;
+				if(glm::intersectRayTriangle(origin, direction, mesh.getVertices()[mesh.getIndices()[t]].pos, mesh.getVertices()[mesh.getIndices()[t + 1]].pos,
+											 mesh.getVertices()[mesh.getIndices()[t + 2]].pos, bary, distance) &&
+				   distance > 0 && distance < depth)
+					depth = distance;
+			}
+		});
+		const bool hit = depth < std::numeric_limits<float>::max();
+		if(hit != hits[i].hit() || (hit && std::abs(depth - hits[i].depth) > 1e-3f * depth))
+			++mismatches;
+	}
+	ms = milliseconds(Clock::now() - start);
+	print("  {:<40} {:>10.2f} queries/s ({} mismatches over {} queries)\n", "Brute force (every triangle)", referenceCount / (ms / 1000.0), mismatches, referenceCount);
+	if(mismatches > 0)
+		error("benchmarkRaycast: Scene::raycast disagrees with the brute force on {} of {} queries.\n", mismatches, referenceCount);
+
+	// Moving a node refits the instance BVH on the next query.
+	start = Clock::now();
+	constexpr size_t Frames = 16;
+	for(size_t f = 0; f < Frames; ++f) {
+		const auto entity = scene.getRegistry().view<MeshRendererComponent>().front();
+		registry.get<NodeComponent>(entity).transform[3].y = static_cast<float>(f % 2);
+		scene.markDirty(entity);
+		scene.update(0);
+		scene.raycast(rays[f]);
+	}
+	print("  {:<40} {:>10.2f} ms\n", "Moved node: update, refit and query", milliseconds(Clock::now() - start) / Frames);
+}
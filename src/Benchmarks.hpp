@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// Small throughput benchmarks, triggered from the Debug menu. Results are printed to the console.
+
+// Compares the stream based JSON parser against the buffer based ones (scalar, indexed and with packed numeric arrays) on each file of the corpus.
+// For glTF files, also reports the time needed to get to the first mesh with each parser (including the lazy JSON::Document).
+void benchmarkJSONParsing(const std::vector<std::filesystem::path>& corpus);
+
+// Serializes a synthetic document shaped like the entities of a .scene file, streaming with JSON::Writer and from a DOM.
+void benchmarkJSONWriting(size_t entityCount = 10000);
+
+// Loads the same synthetic entities from JSON text and from the binary encoding (JSON::BinaryWriter), both into a JSON::Document.
+void benchmarkSceneJSONLoading(size_t entityCount = 10000);
+
+// Throughput of each vertex attribute gather/convert kernel (VertexKernels.hpp), for each implementation available in this build.
+void benchmarkVertexKernels(size_t vertexCount = 1024 * 1024);
+
+// Headless (no device) loading of the files into a Scene: Total time of the synchronous loads, against the time to the first available mesh and the total time
+// of the asynchronous loads (Scene::loadAsync, published by batches as a main loop would).
+void benchmarkSceneLoading(const std::vector<std::filesystem::path>& files);
+
+// Parses a synthetic grid of quads from memory with OBJ::parse (serially and by parallel chunks), then imports it with Scene::load.
+// Also compares OBJ::parseFloat to std::from_chars.
+void benchmarkOBJLoading(size_t faceCount = 2 * 1024 * 1024);
+
+// Decodes the same Base64 string (typical of a buffer embedded in a glTF file) with each implementation available in this build.
+void benchmarkBase64Decoding(size_t size = 16 * 1024 * 1024);
+
+// Cost of Scene::update on synthetic hierarchies of each size, when moving a few nodes every frame, against updating the whole hierarchy.
+void benchmarkSceneUpdate(const std::vector<size_t>& sceneSizes = {10'000, 100'000, 1'000'000}, const std::vector<size_t>& movedNodes = {1, 100, 10'000});
+
+// Scaling of the parallel Scene::update from 1 to maxConcurrency threads (0: all the threads of the pool and the calling one) on whole hierarchy updates.
+void benchmarkParallelSceneUpdate(size_t nodeCount = 1'000'000, uint32_t maxConcurrency = 0);
+
+// Scene::raycast against the brute force intersection of every mesh node, on a plane of randomly oriented mesh instances. Also reports the BVH builds.
+void benchmarkRaycast(size_t instanceCount = 10'000, size_t queryCount = 100'000);
+
+inline const std::vector<std::filesystem::path> DefaultJSONBenchmarkCorpus{
+	"./data/debug-models/sphere.gltf",
+	"./data/materials/cavern-deposits/cavern-deposits.mat",
+};
+
+// Bundled files only: Larger corpora are passed to the standalone SceneLoadingBenchmark (benchmarks/).
+inline const std::vector<std::filesystem::path> DefaultSceneLoadingBenchmarkCorpus{
+	"./data/debug-models/sphere.gltf",
+};
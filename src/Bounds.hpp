@@ -36,10 +36,14 @@ struct Bounds {
 };
 
 inline Bounds operator*(const glm::mat4& transform, const Bounds& b) {
-	Bounds tmp{
-		.min = glm::vec3(transform * glm::vec4(b.min, 1.0f)),
-		.max = glm::vec3(transform * glm::vec4(b.max, 1.0f)),
-	};
-	// Transform may inverse min and max on each axis.
-	return {.min = glm::min(tmp.min, tmp.max), .max = glm::max(tmp.min, tmp.max)};
+	// All corners: Under a rotation, the transformed min and max alone don't bound the box.
+	const auto points = b.getPoints();
+	Bounds	   r{.min = glm::vec3(transform * glm::vec4(points[0], 1.0f))};
+	r.max = r.min;
+	for(size_t i = 1; i < points.size(); ++i) {
+		const auto p = glm::vec3(transform * glm::vec4(points[i], 1.0f));
+		r.min = glm::min(r.min, p);
+		r.max = glm::max(r.max, p);
+	}
+	return r;
 }
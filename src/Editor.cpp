@@ -141,18 +141,28 @@ void Editor::run() {
 		meshGenerations.wait();
 		*/
 
+		// Files are loaded in the background while the window is created, the main loop then publishes them progressively.
 		for(const auto& str : {
 				//"./data/dungeon.scene",
 				"D:/Source/glTF-Sample-Models/2.0/Sponza/glTF/Sponza.gltf",
 				"./data/models/MetalRoughSpheres/MetalRoughSpheres.gltf",
 			})
-			_scene.load(str);
+			_scene.loadAsync(str);
 	}
 	_probeMesh.loadglTF("./data/debug-models/sphere.gltf");
 	{
 		QuickTimer qt("initWindow");
 		initWindow();
 	}
+	{
+		// The renderer is initialized with the first available file.
+		QuickTimer qt("Waiting for the first scene file");
+		const auto loadCount = _scene.getLoads().size();
+		while(_scene.isLoading() && _scene.getLoads().size() == loadCount) {
+			_scene.publishLoads();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
 	{
 		QuickTimer qt("initVulkan");
 		initVulkan();
@@ -172,11 +182,20 @@ void Editor::mainLoop() {
 	while(!glfwWindowShouldClose(_window)) {
 		glfwPollEvents();
 
+		if(_scene.isLoading())
+			if(const auto published = _scene.publishLoads())
+				onScenePublished(published);
+
 		if(_dirtyShaders) {
 			compileShaders();
 			_dirtyShaders = false;
 		}
 
+		if(_dirtyScene) {
+			onSceneLoaded();
+			_dirtyScene = false;
+		}
+
 		if(_dirtyHierarchy) {
 			// Recreate Acceleration Structure
 			vkDeviceWaitIdle(_device); // TODO: Better sync?
@@ -447,6 +466,7 @@ void Editor::trySelectNode() {
 						_scene[idx].getVertices() = m.getVertices();
 						_scene[idx].getIndices() = m.getIndices();
 						_scene[idx].computeBounds();
+						_scene.invalidateMeshBVH(idx);
 						_scene[idx].defaultMaterialIndex = MaterialIndex(static_cast<uint32_t>(Materials.size()) - 1);
 						vkDeviceWaitIdle(_device); // FIXME: Can we do better?
 						if(_scene[idx].blasIndex == -1) {
@@ -605,29 +625,58 @@ void Editor::sMouseButtonCallback(GLFWwindow* window, int button, int action, in
 
 void Editor::sDropCallback(GLFWwindow* window, int pathCount, const char* paths[]) {
 	auto app = reinterpret_cast<Editor*>(glfwGetWindowUserPointer(window));
-	vkDeviceWaitIdle(app->_device); // FIXME: Do better?
 	for(int i = 0; i < pathCount; ++i) {
 		print("Received path '{}'.\n", paths[i]);
-		app->_scene.load(paths[i]);
+		app->_scene.loadAsync(paths[i]);
 	}
+}
+
+void Editor::onSceneLoaded() {
+	vkDeviceWaitIdle(_device); // FIXME: Do better?
 	// FIXME: This is way overkill
-	app->uploadScene();
+	uploadScene();
 	// Since the number of material may have changed, we have to re-create GBuffer descriptor layout and sets
-	app->destroyGBufferPipeline();
-	app->destroyDirectLightPipeline();
-	app->destroyReflectionPipeline();
-	app->destroyRayTracingPipeline();
-	app->createGBufferPipeline();
-	app->createDirectLightPass();
-	app->createReflectionPass();
-	app->createRayTracingPipeline();
-	app->createRaytracingDescriptorSets();
-	app->recordRayTracingCommands();
-	app->_irradianceProbes.destroyPipeline();
-	app->_irradianceProbes.createPipeline(app->_pipelineCache);
-	app->onTLASCreation();
-	app->uiOnTextureChange();
-	app->_outdatedCommandBuffers = true;
+	destroyGBufferPipeline();
+	destroyDirectLightPipeline();
+	destroyReflectionPipeline();
+	destroyRayTracingPipeline();
+	createGBufferPipeline();
+	createDirectLightPass();
+	createReflectionPass();
+	createRayTracingPipeline();
+	createRaytracingDescriptorSets();
+	recordRayTracingCommands();
+	_irradianceProbes.destroyPipeline();
+	_irradianceProbes.createPipeline(_pipelineCache);
+	onTLASCreation();
+	uiOnTextureChange();
+	_outdatedCommandBuffers = true;
+}
+
+void Editor::onScenePublished(const Scene::PublishResult& published) {
+	// New materials and textures change the pipelines layouts, and finished loads get a full (compacted) re-upload once.
+	if(published.resources || published.finished) {
+		onSceneLoaded();
+		return;
+	}
+	vkDeviceWaitIdle(_device); // FIXME: Do better?
+	QuickTimer qt("Progressive Upload");
+	// Either range may be empty: New nodes can still add material variants to the offset table.
+	auto& meshes = _scene.getMeshes();
+	for(size_t i = published.firstMesh; i < meshes.size(); ++i)
+		meshes[i].init(_device);
+	if(!_renderer.appendMeshes(published.firstMesh)) {
+		onSceneLoaded(); // Out of headroom
+		return;
+	}
+	for(size_t i = published.firstMesh; i < meshes.size(); ++i)
+		meshes[i].upload(_device, _stagingBuffer, _stagingMemory, _transfertCommandPool, _transfertQueue);
+	if(!_renderer.appendBLAS(published.firstMesh)) {
+		onSceneLoaded();
+		return;
+	}
+	// New nodes and/or new meshes: Rebuilds the TLAS only.
+	_dirtyHierarchy = true;
 }
 
 void Editor::sKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
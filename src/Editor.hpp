@@ -174,6 +174,7 @@ class Editor {
 	PipelineCache						_pipelineCache;
 
 	bool							 _dirtyHierarchy = false;		  // Node Hierachy has changed shape
+	bool							 _dirtyScene = false;			  // Re-upload the whole scene (see onSceneLoaded), e.g. when the offset table is full
 	bool							 _outdatedCommandBuffers = false; // Re-record command buffers at the start of the next frame
 	Image							 _depthImage;
 	ImageView						 _depthImageView;
@@ -473,6 +474,11 @@ class Editor {
 	void drawUI();
 
 	void onTLASCreation();
+	// Re-uploads the scene and re-creates the pipelines depending on the number of materials, after new content was published (see Scene::publishLoads).
+	void onSceneLoaded();
+	// Uploads the meshes and nodes of a publication batch in the headroom of the existing buffers, falls back to onSceneLoaded when resources were added,
+	// a load finished, or the headroom is exhausted.
+	void onScenePublished(const Scene::PublishResult&);
 
 	void cameraControl(float dt);
 	void updateUniformBuffer(uint32_t currentImage);
@@ -0,0 +1,119 @@
+#include "Gltf.hpp"
+
+#include <array>
+
+#include <JSONReader.hpp>
+#include <Logger.hpp>
+
+static constexpr std::array<std::string_view, 7> AccessorTypeNames{"SCALAR", "VEC2", "VEC3", "VEC4", "MAT2", "MAT3", "MAT4"};
+
+std::string_view toString(GltfAccessorType type) {
+	if(type == GltfAccessorType::Unknown)
+		return "Unknown";
+	return AccessorTypeNames[static_cast<size_t>(type)];
+}
+
+static GltfAccessorType parseAccessorType(std::string_view str) {
+	for(size_t i = 0; i < AccessorTypeNames.size(); ++i)
+		if(AccessorTypeNames[i] == str)
+			return static_cast<GltfAccessorType>(i);
+	return GltfAccessorType::Unknown;
+}
+
+// Generic deserializer: One readValue overload per kind of member, structs are read by walking their GltfSchema.
+
+static bool readValue(JSON::Reader& r, int32_t& value) {
+	return r.read(value);
+}
+
+static bool readValue(JSON::Reader& r, uint32_t& value) {
+	return r.read(value);
+}
+
+static bool readValue(JSON::Reader& r, float& value) {
+	return r.read(value);
+}
+
+static bool readValue(JSON::Reader& r, bool& value) {
+	return r.read(value);
+}
+
+static bool readValue(JSON::Reader& r, std::string& value) {
+	return r.read(value);
+}
+
+// Enums are stored as strings in glTF, converted once here.
+static bool readValue(JSON::Reader& r, GltfAccessorType& type) {
+	std::string str;
+	if(!r.read(str))
+		return false;
+	type = parseAccessorType(str);
+	return true;
+}
+
+static bool readValue(JSON::Reader& r, SkeletalAnimationClip::Path& path) {
+	std::string str;
+	if(!r.read(str))
+		return false;
+	path = SkeletalAnimationClip::parsePath(str);
+	return true;
+}
+
+static bool readValue(JSON::Reader& r, SkeletalAnimationClip::Interpolation& interpolation) {
+	std::string str;
+	if(!r.read(str))
+		return false;
+	interpolation = SkeletalAnimationClip::parseInterpolation(str);
+	return true;
+}
+
+static bool readValue(JSON::Reader& r, glm::vec3& v) {
+	return r.read(&v[0], 3);
+}
+
+// glTF stores quaternions as (x, y, z, w)
+static bool readValue(JSON::Reader& r, glm::quat& q) {
+	glm::vec4 v;
+	if(!r.read(&v[0], 4))
+		return false;
+	q = glm::quat{v.w, v.x, v.y, v.z};
+	return true;
+}
+
+static bool readValue(JSON::Reader& r, std::optional<glm::mat4>& m) {
+	return r.read(&(m.emplace()[0][0]), 16);
+}
+
+template<GltfDescribed T>
+static bool readValue(JSON::Reader& r, T& object);
+
+template<typename T>
+static bool readValue(JSON::Reader& r, std::vector<T>& values) {
+	values.clear();
+	return r.readArray([&]() { return readValue(r, values.emplace_back()); });
+}
+
+template<GltfDescribed T>
+static bool readValue(JSON::Reader& r, T& object) {
+	return r.readObject([&](std::string_view key) {
+		bool found = false;
+		bool success = true;
+		auto readField = [&](const auto& field) {
+			if(found || key != field.name)
+				return;
+			found = true;
+			success = readValue(r, object.*field.member);
+		};
+		std::apply([&](const auto&... fields) { (readField(fields), ...); }, GltfSchema<T>::Fields);
+		return found ? success : r.skip();
+	});
+}
+
+bool GltfAsset::parse(std::string_view json) {
+	JSON::Reader r{json};
+	if(!readValue(r, *this)) {
+		error("GltfAsset::parse error: Invalid glTF JSON (offset {}).\n", r.getOffset());
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include <SkeletalAnimation.hpp>
+
+// glTF front-end: Reads the JSON part of a glTF asset in a single pass using JSON::Reader, directly into typed tables.
+// Only the geometry, hierarchy, skins and animations are decoded, the other top-level properties (materials, textures...) are skipped.
+// Indices into other tables are -1 when undefined.
+// Each struct is described by a GltfSchema (its JSON properties and the members they are stored in), used by a generic deserializer (see Gltf.cpp).
+
+enum class GltfAccessorType {
+	Scalar,
+	Vec2,
+	Vec3,
+	Vec4,
+	Mat2,
+	Mat3,
+	Mat4,
+	Unknown
+};
+
+std::string_view toString(GltfAccessorType);
+
+// Reflection-style description of a JSON property: Its name and the struct member it is stored in.
+template<typename Struct, typename Member>
+struct GltfField {
+	std::string_view name;
+	Member Struct::*member;
+};
+template<typename Struct, typename Member>
+GltfField(std::string_view, Member Struct::*) -> GltfField<Struct, Member>;
+
+// Specialized for each deserializable struct, with a constexpr tuple of GltfField named Fields.
+// Unlisted properties are skipped.
+template<typename T>
+struct GltfSchema;
+
+template<typename T>
+concept GltfDescribed = requires { GltfSchema<T>::Fields; };
+
+struct GltfBuffer {
+	uint32_t	byteLength = 0;
+	std::string uri; // Empty for the GLB binary chunk
+};
+
+template<>
+struct GltfSchema<GltfBuffer> {
+	static constexpr auto Fields = std::make_tuple(GltfField{"byteLength", &GltfBuffer::byteLength}, GltfField{"uri", &GltfBuffer::uri});
+};
+
+struct GltfBufferView {
+	uint32_t buffer = 0;
+	uint32_t byteOffset = 0;
+	uint32_t byteLength = 0;
+	uint32_t byteStride = 0; // 0: Tightly packed
+};
+
+template<>
+struct GltfSchema<GltfBufferView> {
+	static constexpr auto Fields = std::make_tuple(GltfField{"buffer", &GltfBufferView::buffer}, GltfField{"byteOffset", &GltfBufferView::byteOffset},
+												   GltfField{"byteLength", &GltfBufferView::byteLength}, GltfField{"byteStride", &GltfBufferView::byteStride});
+};
+
+struct GltfAccessor {
+	int32_t			   bufferView = -1;
+	uint32_t		   byteOffset = 0;
+	uint32_t		   componentType = 0; // See Scene::ComponentType
+	uint32_t		   count = 0;
+	GltfAccessorType   type = GltfAccessorType::Unknown;
+	bool			   normalized = false;
+	std::vector<float> min;
+	std::vector<float> max;
+};
+
+template<>
+struct GltfSchema<GltfAccessor> {
+	static constexpr auto Fields = std::make_tuple(GltfField{"bufferView", &GltfAccessor::bufferView}, GltfField{"byteOffset", &GltfAccessor::byteOffset},
+												   GltfField{"componentType", &GltfAccessor::componentType}, GltfField{"count", &GltfAccessor::count},
+												   GltfField{"type", &GltfAccessor::type}, GltfField{"normalized", &GltfAccessor::normalized}, GltfField{"min", &GltfAccessor::min},
+												   GltfField{"max", &GltfAccessor::max});
+};
+
+struct GltfPrimitive {
+	struct Attributes {
+		int32_t position = -1;
+		int32_t normal = -1;
+		int32_t tangent = -1;
+		int32_t texCoord0 = -1;
+		int32_t joints0 = -1;
+		int32_t weights0 = -1;
+	};
+	Attributes	attributes;
+	int32_t		indices = -1;
+	int32_t		material = -1;
+	uint32_t	mode = 4; // Triangles
+	std::string name;
+};
+
+template<>
+struct GltfSchema<GltfPrimitive::Attributes> {
+	using A = GltfPrimitive::Attributes;
+	static constexpr auto Fields = std::make_tuple(GltfField{"POSITION", &A::position}, GltfField{"NORMAL", &A::normal}, GltfField{"TANGENT", &A::tangent},
+												   GltfField{"TEXCOORD_0", &A::texCoord0}, GltfField{"JOINTS_0", &A::joints0}, GltfField{"WEIGHTS_0", &A::weights0});
+};
+
+template<>
+struct GltfSchema<GltfPrimitive> {
+	static constexpr auto Fields = std::make_tuple(GltfField{"attributes", &GltfPrimitive::attributes}, GltfField{"indices", &GltfPrimitive::indices},
+												   GltfField{"material", &GltfPrimitive::material}, GltfField{"mode", &GltfPrimitive::mode}, GltfField{"name", &GltfPrimitive::name});
+};
+
+struct GltfMesh {
+	std::string				   name;
+	std::vector<GltfPrimitive> primitives;
+};
+
+template<>
+struct GltfSchema<GltfMesh> {
+	static constexpr auto Fields = std::make_tuple(GltfField{"name", &GltfMesh::name}, GltfField{"primitives", &GltfMesh::primitives});
+};
+
+struct GltfNode {
+	std::string				 name;
+	int32_t					 mesh = -1;
+	int32_t					 skin = -1;
+	std::vector<uint32_t>	 children;
+	std::optional<glm::mat4> matrix;
+	glm::vec3				 translation{0.0f};
+	glm::quat				 rotation{1, 0, 0, 0};
+	glm::vec3				 scale{1.0f};
+};
+
+template<>
+struct GltfSchema<GltfNode> {
+	static constexpr auto Fields = std::make_tuple(GltfField{"name", &GltfNode::name}, GltfField{"mesh", &GltfNode::mesh}, GltfField{"skin", &GltfNode::skin},
+												   GltfField{"children", &GltfNode::children}, GltfField{"matrix", &GltfNode::matrix}, GltfField{"translation", &GltfNode::translation},
+												   GltfField{"rotation", &GltfNode::rotation}, GltfField{"scale", &GltfNode::scale});
+};
+
+struct GltfScene {
+	std::string			  name;
+	std::vector<uint32_t> nodes;
+};
+
+template<>
+struct GltfSchema<GltfScene> {
+	static constexpr auto Fields = std::make_tuple(GltfField{"name", &GltfScene::name}, GltfField{"nodes", &GltfScene::nodes});
+};
+
+struct GltfSkin {
+	int32_t				  inverseBindMatrices = -1;
+	std::vector<uint32_t> joints;
+};
+
+template<>
+struct GltfSchema<GltfSkin> {
+	static constexpr auto Fields = std::make_tuple(GltfField{"inverseBindMatrices", &GltfSkin::inverseBindMatrices}, GltfField{"joints", &GltfSkin::joints});
+};
+
+struct GltfAnimation {
+	struct Channel {
+		struct Target {
+			int32_t						node = -1;
+			SkeletalAnimationClip::Path path = SkeletalAnimationClip::Path::Translation;
+		};
+		uint32_t sampler = 0;
+		Target	 target;
+	};
+	struct Sampler {
+		uint32_t							 input = 0;
+		uint32_t							 output = 0;
+		SkeletalAnimationClip::Interpolation interpolation = SkeletalAnimationClip::Interpolation::Linear;
+	};
+	std::vector<Channel> channels;
+	std::vector<Sampler> samplers;
+};
+
+template<>
+struct GltfSchema<GltfAnimation::Channel::Target> {
+	using T = GltfAnimation::Channel::Target;
+	static constexpr auto Fields = std::make_tuple(GltfField{"node", &T::node}, GltfField{"path", &T::path});
+};
+
+template<>
+struct GltfSchema<GltfAnimation::Channel> {
+	using C = GltfAnimation::Channel;
+	static constexpr auto Fields = std::make_tuple(GltfField{"sampler", &C::sampler}, GltfField{"target", &C::target});
+};
+
+template<>
+struct GltfSchema<GltfAnimation::Sampler> {
+	using S = GltfAnimation::Sampler;
+	static constexpr auto Fields = std::make_tuple(GltfField{"input", &S::input}, GltfField{"output", &S::output}, GltfField{"interpolation", &S::interpolation});
+};
+
+template<>
+struct GltfSchema<GltfAnimation> {
+	static constexpr auto Fields = std::make_tuple(GltfField{"channels", &GltfAnimation::channels}, GltfField{"samplers", &GltfAnimation::samplers});
+};
+
+struct GltfAsset {
+	std::vector<GltfBuffer>		buffers;
+	std::vector<GltfBufferView> bufferViews;
+	std::vector<GltfAccessor>	accessors;
+	std::vector<GltfMesh>		meshes;
+	std::vector<GltfNode>		nodes;
+	std::vector<GltfScene>		scenes;
+	std::vector<GltfSkin>		skins;
+	std::vector<GltfAnimation>	animations;
+	std::vector<std::string>	extensionsRequired;
+
+	bool parse(std::string_view json);
+};
+
+template<>
+struct GltfSchema<GltfAsset> {
+	static constexpr auto Fields = std::make_tuple(GltfField{"buffers", &GltfAsset::buffers}, GltfField{"bufferViews", &GltfAsset::bufferViews},
+												   GltfField{"accessors", &GltfAsset::accessors}, GltfField{"meshes", &GltfAsset::meshes}, GltfField{"nodes", &GltfAsset::nodes},
+												   GltfField{"scenes", &GltfAsset::scenes}, GltfField{"skins", &GltfAsset::skins}, GltfField{"animations", &GltfAsset::animations},
+												   GltfField{"extensionsRequired", &GltfAsset::extensionsRequired});
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// 64bit non-cryptographic hash of a memory block (XXH64 algorithm, by Yann Collet), used to address contents (e.g. meshes deduplication).
+// Results are identical on all platforms (little-endian reads). Hashes can be chained by passing the previous one as seed.
+uint64_t hash64(const void* data, size_t size, uint64_t seed = 0);
+
+template<typename T>
+uint64_t hash64(std::span<const T> data, uint64_t seed = 0) {
+	return hash64(data.data(), data.size_bytes(), seed);
+}
@@ -1,7 +1,10 @@
 #include "JSON.hpp"
 
+#include <algorithm>
 #include <stack>
 
+#include <JSONStructuralIndex.hpp>
+#include <JSONWriter.hpp>
 #include <Logger.hpp>
 
 JSON::JSON(const std::filesystem::path& path) {
@@ -15,12 +18,18 @@ JSON::JSON(const std::initializer_list<KeyValue>& list) {
 }
 
 bool JSON::parse(const std::filesystem::path& path) {
-	std::ifstream file{path, std::ios::in};
+	std::ifstream file{path, std::ios::binary | std::ios::ate};
 	if(!file) {
 		error("JSON Parsing error: Could not open ''{}'.\n", path);
 		return false;
 	}
-	return parse(file);
+	std::string content(static_cast<size_t>(file.tellg()), '\0');
+	file.seekg(0, std::ios::beg);
+	if(!file.read(content.data(), content.size())) {
+		error("JSON Parsing error: Could not read ''{}'.\n", path);
+		return false;
+	}
+	return parse(std::string_view{content});
 }
 
 bool JSON::parse(std::istream& file) {
@@ -38,26 +47,8 @@ bool JSON::parse(std::istream& file) {
 	return true;
 }
 
-// NOTE: Used to construct an istream from a arbitrary memory buffer.
-template<typename char_type>
-struct istreambuf : public std::basic_streambuf<char_type, std::char_traits<char_type>> {
-	istreambuf(char_type* buffer, std::streamsize bufferLength) {
-		// Set the "get" pointer to the start of the buffer, the next item, and record its length.
-		this->setg(buffer, buffer, buffer + bufferLength);
-		// set the "put" pointer the start of the buffer and record it's length.
-		this->setp(buffer, buffer + bufferLength);
-	}
-};
-
 bool JSON::parse(char* data, size_t size) {
-	/* NOTE: Workaround
-	I'd like to do the following, but pubsetbuf is not implemented ('correctly'?) in Visual Studio. Yay.
-		std::stringstream stream;
-		stream.rdbuf()->pubsetbuf(jsonChunk.data, jsonChunk.length);
-	*/
-	istreambuf<char> streambuf(data, size);
-	std::istream	 stream(&streambuf);
-	return parse(stream);
+	return parse(std::string_view{data, size});
 }
 
 bool JSON::expectImmediate(char c, std::istream& file) {
@@ -251,6 +242,448 @@ JSON::value JSON::parseValue(std::istream& file) {
 	error("JSON::parseValue: Unexpected character '{}'.\n", byte);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Buffer parser
+
+bool JSON::parse(std::string_view data) {
+	// Building the index isn't worth it for small documents (.mat files, simple glTF)
+	constexpr size_t StructuralIndexThreshold = 64 * 1024;
+	return parse(data, ParseOptions{.useStructuralIndex = data.size() >= StructuralIndexThreshold});
+}
+
+bool JSON::parse(std::string_view data, const ParseOptions& options) {
+	if(options.useStructuralIndex) {
+		JSONStructuralIndex index;
+		if(!index.build(data)) {
+			error("JSON::parse error: Unterminated string.\n");
+			return false;
+		}
+		const auto& positions = index.getPositions();
+		if(positions.empty()) {
+			error("JSON::parse error: Expected '{{' or '['.\n");
+			return false;
+		}
+		IndexCursor ic{data.data(), data.data() + data.size(), positions.data(), positions.data() + positions.size(), options.packNumericArrays};
+		char		byte = data[*ic.idx++];
+		if(byte == '{')
+			_root = value{parseObject(ic)};
+		else if(byte == '[')
+			_root = value{parseArray(ic)};
+		else {
+			error("JSON::parse error: Expected '{{' or '[', got '{}'\n", byte);
+			return false;
+		}
+		return true;
+	}
+
+	Cursor c{data.data(), data.data() + data.size(), options.packNumericArrays};
+	char   byte = skipWhitespace(c);
+	if(byte == '{')
+		_root = value{parseObject(c)};
+	else if(byte == '[')
+		_root = value{parseArray(c)};
+	else {
+		error("JSON::parse error: Expected '{{' or '[', got '{}'\n", byte);
+		return false;
+	}
+	return true;
+}
+
+void JSON::value::unpackArray() {
+	array a;
+	if(_packing == Packing::floats) {
+		a.reserve(_value.as_floats.size());
+		for(const auto& f : _value.as_floats)
+			a.emplace_back(f);
+		_value.as_floats.~vector();
+	} else {
+		a.reserve(_value.as_integers.size());
+		for(const auto& i : _value.as_integers)
+			a.emplace_back(i);
+		_value.as_integers.~vector();
+	}
+	_packing = Packing::none;
+	new(&_value.as_array) array(std::move(a));
+}
+
+const JSON::array& JSON::value::packedConstAccess() const {
+	error("JSON::value: Generic const access to a packed array of {} numbers, use asFloats()/asIntegers(), copyTo() or unpackArrays().\n",
+		  _packing == Packing::floats ? _value.as_floats.size() : _value.as_integers.size());
+	static const array Empty;
+	return Empty;
+}
+
+const JSON::value& JSON::value::null() {
+	static const value Null;
+	return Null;
+}
+
+void JSON::value::unpackArrays() {
+	switch(_type) {
+		case Type::array:
+			unpack();
+			for(auto& v : _value.as_array)
+				v.unpackArrays();
+			break;
+		case Type::object:
+			for(auto& [key, v] : _value.as_object)
+				v.unpackArrays();
+			break;
+		default: break;
+	}
+}
+
+void JSON::value::copyTo(float* out, size_t count) const {
+	assert(_type == Type::array);
+	switch(_packing) {
+		case Packing::floats:
+			assert(_value.as_floats.size() == count);
+			std::copy_n(_value.as_floats.data(), count, out);
+			break;
+		case Packing::integers:
+			assert(_value.as_integers.size() == count);
+			std::transform(_value.as_integers.data(), _value.as_integers.data() + count, out, [](int i) { return static_cast<float>(i); });
+			break;
+		default:
+			assert(_value.as_array.size() == count);
+			for(size_t i = 0; i < count; ++i)
+				out[i] = _value.as_array[i].to<float>();
+			break;
+	}
+}
+
+bool JSON::expectImmediate(const char* str, Cursor& c) {
+	for(; *str != '\0'; ++str) {
+		if(c.cur >= c.end || *c.cur != *str) {
+			error("JSON::expectImmediate error: Expected '{}', got '{}'\n", *str, c.cur < c.end ? *c.cur : '\0');
+			return false;
+		}
+		++c.cur;
+	}
+	return true;
+}
+
+bool JSON::expect(char c, Cursor& cursor) {
+	char byte = skipWhitespace(cursor);
+	if(byte != c) {
+		error("JSON::expect error: Expected '{}', got '{}'\n", c, byte);
+		return false;
+	}
+	return true;
+}
+
+JSON::object JSON::parseObject(Cursor& c) {
+	object o;
+	while(c.cur < c.end) {
+		char byte = skipWhitespace(c);
+		switch(byte) {
+			case '}': return o;
+			case '"': {
+				auto key = parseString(c);
+				expect(':', c);
+				o.emplace(std::move(key), parseValue(c));
+				break;
+			}
+			case ',': break;
+			default: error("JSON::parseObject error: Unexpected character '{}'.\n", byte); return o;
+		}
+	}
+	return o;
+}
+
+JSON::array JSON::parseArray(Cursor& c) {
+	array a;
+	while(c.cur < c.end) {
+		char byte = skipWhitespace(c);
+		switch(byte) {
+			case ']': return a;
+			case ',': break;
+			case '\0': return a;
+			default:
+				--c.cur; // Put back the first character of the value
+				a.emplace_back(parseValue(c));
+				break;
+		}
+	}
+	return a;
+}
+
+// Appends the UTF-8 encoding of a \uXXXX escape sequence (c points right after the 'u'), handling surrogate pairs.
+static void appendEscapedCodepoint(std::string& s, const char*& cur, const char* end) {
+	auto readHex = [&](uint32_t& codepoint) {
+		if(end - cur < 4)
+			return false;
+		auto r = std::from_chars(cur, cur + 4, codepoint, 16);
+		if(r.ptr != cur + 4)
+			return false;
+		cur += 4;
+		return true;
+	};
+	uint32_t codepoint = 0;
+	if(!readHex(codepoint)) {
+		error("JSON::parseString error: Invalid unicode escape sequence.\n");
+		return;
+	}
+	if(codepoint >= 0xD800 && codepoint <= 0xDBFF && end - cur >= 6 && cur[0] == '\\' && cur[1] == 'u') {
+		cur += 2;
+		uint32_t low = 0;
+		if(readHex(low) && low >= 0xDC00 && low <= 0xDFFF)
+			codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+	}
+	if(codepoint < 0x80) {
+		s += static_cast<char>(codepoint);
+	} else if(codepoint < 0x800) {
+		s += static_cast<char>(0xC0 | (codepoint >> 6));
+		s += static_cast<char>(0x80 | (codepoint & 0x3F));
+	} else if(codepoint < 0x10000) {
+		s += static_cast<char>(0xE0 | (codepoint >> 12));
+		s += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+		s += static_cast<char>(0x80 | (codepoint & 0x3F));
+	} else {
+		s += static_cast<char>(0xF0 | (codepoint >> 18));
+		s += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+		s += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+		s += static_cast<char>(0x80 | (codepoint & 0x3F));
+	}
+}
+
+JSON::string JSON::parseString(Cursor& c) {
+	// We assume the leading '"' has already been consumed.
+	string s;
+	while(c.cur < c.end) {
+		// Copy runs of regular characters at once, only stopping on the closing quote or an escape sequence.
+		const char* start = c.cur;
+		c.cur = findQuoteOrBackslash(c.cur, c.end);
+		s.append(start, c.cur);
+		if(c.cur >= c.end)
+			break;
+		if(*c.cur++ == '"')
+			return s;
+		if(c.cur >= c.end)
+			break;
+		switch(*c.cur++) {
+			case '"': s += '"'; break;
+			case '\\': s += '\\'; break;
+			case '/': s += '/'; break;
+			case 'b': s += '\b'; break;
+			case 'f': s += '\f'; break;
+			case 'n': s += '\n'; break;
+			case 'r': s += '\r'; break;
+			case 't': s += '\t'; break;
+			case 'u': appendEscapedCodepoint(s, c.cur, c.end); break;
+			default: error("JSON::parseString error: Invalid escape sequence '\\{}'.\n", *(c.cur - 1)); break;
+		}
+	}
+	error("JSON::parseString error: Unterminated string.\n");
+	return s;
+}
+
+JSON::number JSON::parseNumber(Cursor& c) {
+	// Let from_chars find the end of the number: Try as an integer first, and restart as a float if we stopped on a fraction or an exponent (or overflowed).
+	int	 i = 0;
+	auto r = std::from_chars(c.cur, c.end, i);
+	if(r.ec == std::errc{} && (r.ptr == c.end || (*r.ptr != '.' && *r.ptr != 'e' && *r.ptr != 'E'))) {
+		c.cur = r.ptr;
+		return number{i};
+	}
+	float f = 0;
+	auto  rf = std::from_chars(c.cur, c.end, f);
+	if(rf.ec == std::errc::invalid_argument) {
+		error("JSON::parseNumber error: Invalid number.\n");
+		++c.cur;
+	} else
+		c.cur = rf.ptr;
+	return number{f};
+}
+
+bool JSON::parseBoolean(Cursor& c) {
+	if(c.cur < c.end && *c.cur == 't') {
+		expectImmediate("true", c);
+		return true;
+	} else if(c.cur < c.end && *c.cur == 'f') {
+		expectImmediate("false", c);
+		return false;
+	}
+	error("JSON::parseBoolean error: Unexpected character '{}'.\n", c.cur < c.end ? *c.cur : '\0');
+	return false;
+}
+
+JSON::null_t JSON::parseNull(Cursor& c) {
+	expectImmediate("null", c);
+	return JSON::null_t{};
+}
+
+bool JSON::parsePackedArray(Cursor& c, value& out) {
+	// Speculatively read numbers into a plain buffer, bailing out on the first value that doesn't fit: c is only updated on success.
+	Cursor			   cur = c;
+	std::vector<float> floats;
+	std::vector<int>   ints;
+	bool			   reals = false;
+	for(size_t i = 0;; ++i) {
+		char byte = skipWhitespace(cur);
+		if(byte != '-' && (byte < '0' || byte > '9'))
+			return false;
+		--cur.cur;
+		auto n = parseNumber(cur);
+		if(i == 0)
+			reals = n.isReal();
+		else if(n.isReal() != reals)
+			return false;
+		if(reals)
+			floats.push_back(n.asReal());
+		else
+			ints.push_back(n.asInteger());
+		byte = skipWhitespace(cur);
+		if(byte == ']')
+			break;
+		if(byte != ',')
+			return false;
+	}
+	c = cur;
+	if(reals)
+		out = value{std::move(floats)};
+	else
+		out = value{std::move(ints)};
+	return true;
+}
+
+JSON::value JSON::parseValue(Cursor& c) {
+	char byte = skipWhitespace(c);
+	switch(byte) {
+		case '"': return value{parseString(c)};
+		case '-':
+		case '0':
+		case '1':
+		case '2':
+		case '3':
+		case '4':
+		case '5':
+		case '6':
+		case '7':
+		case '8':
+		case '9': --c.cur; return value{parseNumber(c)};
+		case '{': return value{parseObject(c)};
+		case '[':
+			if(value packed; c.packNumericArrays && parsePackedArray(c, packed))
+				return packed;
+			return value{parseArray(c)};
+		case 't':
+		case 'f': --c.cur; return value{parseBoolean(c)};
+		case 'n': --c.cur; return value{parseNull(c)};
+	}
+	error("JSON::parseValue: Unexpected character '{}'.\n", byte);
+	return value{};
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Indexed parser
+
+JSON::object JSON::parseObject(IndexCursor& ic) {
+	object o;
+	while(ic.idx < ic.idxEnd) {
+		char byte = ic.data[*ic.idx];
+		switch(byte) {
+			case '}': ++ic.idx; return o;
+			case '"': {
+				auto key = parseString(ic);
+				if(ic.idx >= ic.idxEnd || ic.data[*ic.idx] != ':') {
+					error("JSON::expect error: Expected ':', got '{}'\n", ic.idx < ic.idxEnd ? ic.data[*ic.idx] : '\0');
+					return o;
+				}
+				++ic.idx;
+				o.emplace(std::move(key), parseValue(ic));
+				break;
+			}
+			case ',': ++ic.idx; break;
+			default: error("JSON::parseObject error: Unexpected character '{}'.\n", byte); return o;
+		}
+	}
+	error("JSON::parseObject error: Unexpected end of input.\n");
+	return o;
+}
+
+JSON::array JSON::parseArray(IndexCursor& ic) {
+	array		a;
+	const char* p = ic.data + *(ic.idx - 1) + 1;
+	while(p < ic.end && isWhitespace(*p))
+		++p;
+	if(p < ic.end && *p == ']') {
+		++ic.idx;
+		return a;
+	}
+	while(ic.idx < ic.idxEnd) {
+		a.emplace_back(parseValue(ic));
+		if(ic.idx >= ic.idxEnd)
+			break;
+		char byte = ic.data[*ic.idx++];
+		if(byte == ']')
+			return a;
+		if(byte != ',') {
+			error("JSON::parseArray error: Unexpected character '{}'.\n", byte);
+			return a;
+		}
+	}
+	error("JSON::parseArray error: Unexpected end of input.\n");
+	return a;
+}
+
+JSON::string JSON::parseString(IndexCursor& ic) {
+	// Opening and closing quotes are consecutive in the index.
+	const char* begin = ic.data + *ic.idx + 1;
+	if(ic.idx + 1 >= ic.idxEnd) {
+		error("JSON::parseString error: Unterminated string.\n");
+		ic.idx = ic.idxEnd;
+		return {};
+	}
+	const char* closingQuote = ic.data + *(ic.idx + 1);
+	ic.idx += 2;
+	// Escaped quotes are always preceded by a backslash, so this only stops on the closing quote if there's no escape sequence.
+	if(findQuoteOrBackslash(begin, closingQuote) == closingQuote)
+		return string{begin, closingQuote};
+	Cursor c{begin, closingQuote + 1};
+	return parseString(c);
+}
+
+JSON::value JSON::parseValue(IndexCursor& ic) {
+	const char* p = ic.data + *(ic.idx - 1) + 1;
+	while(p < ic.end && isWhitespace(*p))
+		++p;
+	if(p >= ic.end) {
+		error("JSON::parseValue: Unexpected end of input.\n");
+		return value{};
+	}
+	switch(*p) {
+		case '"':
+		case '{':
+		case '[':
+			if(ic.idx >= ic.idxEnd || ic.data + *ic.idx != p) {
+				error("JSON::parseValue: Unexpected character '{}'.\n", *p);
+				return value{};
+			}
+			if(*p == '"')
+				return value{parseString(ic)};
+			++ic.idx;
+			if(*p == '{')
+				return value{parseObject(ic)};
+			if(ic.packNumericArrays) {
+				// Numbers are not part of the index: Only the n - 1 commas and the closing bracket of a packed array of n numbers have to be skipped.
+				Cursor c{p + 1, ic.end};
+				value  packed;
+				if(parsePackedArray(c, packed)) {
+					ic.idx += packed.isPackedFloats() ? packed.asFloats().size() : packed.asIntegers().size();
+					assert(ic.data + *(ic.idx - 1) == c.cur - 1);
+					return packed;
+				}
+			}
+			return value{parseArray(ic)};
+		default: {
+			// Scalars are not part of the index.
+			Cursor c{p, ic.end};
+			return parseValue(c);
+		}
+	}
+}
+
 bool JSON::save(const std::filesystem::path& path) const {
 	std::ofstream file(path);
 	if(!file)
@@ -260,6 +693,57 @@ bool JSON::save(const std::filesystem::path& path) const {
 }
 
 bool JSON::save(std::ostream& file) const {
-	file << *this;
-	return true;
+	Writer writer{file};
+	writer.write(getRoot());
+	writer.flush();
+	return static_cast<bool>(file);
+}
+
+std::string JSON::number::toString() const {
+	Writer writer;
+	writer.write(*this);
+	return std::string{writer.getBuffer()};
+}
+
+std::string JSON::value::serialize() const {
+	Writer writer;
+	writer.write(*this);
+	return std::string{writer.getBuffer()};
+}
+
+std::string JSON::value::toString() const {
+	if(_type == Type::string)
+		return _value.as_string;
+	return serialize();
+}
+
+std::ostream& operator<<(std::ostream& os, const JSON::value& value) {
+	JSON::Writer writer{os};
+	writer.write(value);
+	writer.flush();
+	return os;
+}
+
+std::string JSON::toString(const array& value) {
+	Writer writer;
+	writer.write(value);
+	return std::string{writer.getBuffer()};
+}
+
+std::string JSON::toString(std::span<const float> value) {
+	Writer writer;
+	writer.write(value);
+	return std::string{writer.getBuffer()};
+}
+
+std::string JSON::toString(std::span<const int> value) {
+	Writer writer;
+	writer.write(value);
+	return std::string{writer.getBuffer()};
+}
+
+std::string JSON::toString(const object& value) {
+	Writer writer;
+	writer.write(value);
+	return std::string{writer.getBuffer()};
 }
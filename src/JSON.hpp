@@ -1,9 +1,12 @@
 #pragma once
 
 #include <cassert>
+#include <charconv>
 #include <filesystem>
 #include <fstream>
 #include <functional>
+#include <span>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -13,6 +16,10 @@
 class JSON {
   public:
 	class value;
+	class Document;		// Read-only, arena allocated alternative to the DOM. See JSONDocument.hpp
+	class Reader;		// Pull parser, see JSONReader.hpp
+	class Writer;		// Streaming serializer, see JSONWriter.hpp
+	class BinaryWriter; // Binary encoding, see JSONBinary.hpp
 
 	class null_t {};
 
@@ -24,12 +31,7 @@ class JSON {
 		number(int i) : _type(Type::integer) { _value.as_int = i; }
 		number(float f) : _type(Type::real) { _value.as_float = f; }
 
-		std::string toString() const {
-			if(_type == Type::real)
-				return std::to_string(_value.as_float);
-			else
-				return std::to_string(_value.as_int);
-		}
+		std::string toString() const; // Same representation as JSON::Writer
 
 		const float& asReal() const {
 			assert(_type == Type::real);
@@ -41,6 +43,8 @@ class JSON {
 			return _value.as_int;
 		}
 
+		bool isReal() const { return _type == Type::real; }
+
 		operator const float&() const { return asReal(); }
 		operator const int&() const { return asInteger(); }
 
@@ -94,12 +98,16 @@ class JSON {
 		value(value& v) { copy(v); };
 		value(const value& v) noexcept { copy(v); };
 		value& operator=(const value& v) noexcept {
-			copy(v);
+			value tmp{v}; // v may be part of this value
+			this->~value();
+			swap(std::move(tmp));
 			return *this;
 		}
 		value(value&& v) noexcept { swap(std::move(v)); };
 		value& operator=(value&& v) noexcept {
-			swap(std::move(v));
+			value tmp{std::move(v)};
+			this->~value();
+			swap(std::move(tmp));
 			return *this;
 		}
 
@@ -149,12 +157,28 @@ class JSON {
 			_type = Type::null;
 			new(&_value.as_null) null_t{n};
 		}
+		// Packed arrays of numbers, see isPackedFloats()
+		explicit value(std::vector<float>&& floats) : _packing(Packing::floats) {
+			_type = Type::array;
+			new(&_value.as_floats) std::vector<float>{std::move(floats)};
+		}
+		explicit value(std::vector<int>&& integers) : _packing(Packing::integers) {
+			_type = Type::array;
+			new(&_value.as_integers) std::vector<int>{std::move(integers)};
+		}
 
 		~value() {
 			switch(_type) {
 				case Type::string: _value.as_string.~string(); break;
 				case Type::number: _value.as_number.~number(); break;
-				case Type::array: _value.as_array.~array(); break;
+				case Type::array:
+					if(_packing == Packing::floats)
+						_value.as_floats.~vector();
+					else if(_packing == Packing::integers)
+						_value.as_integers.~vector();
+					else
+						_value.as_array.~array();
+					break;
 				case Type::object: _value.as_object.~object(); break;
 				case Type::boolean:
 				case Type::null: break;
@@ -163,29 +187,10 @@ class JSON {
 
 		auto operator<=>(const value&) const = default;
 
-		std::string serialize() const {
-			switch(_type) {
-				// case Type::string: return "\"" + _value.as_string + "\"";
-				case Type::string: {
-					std::ostringstream ss;
-					ss << std::quoted(_value.as_string);
-					return ss.str();
-				}
-				default: return toString();
-			}
-		}
-
-		std::string toString() const {
-			switch(_type) {
-				case Type::string: return _value.as_string;
-				case Type::number: return _value.as_number.toString();
-				case Type::array: return JSON::toString(_value.as_array);
-				case Type::object: return JSON::toString(_value.as_object);
-				case Type::boolean: return _value.as_boolean ? "true" : "false";
-				case Type::null: return "null";
-				default: return "undefined";
-			}
-		}
+		// JSON representation (see JSON::Writer).
+		std::string serialize() const;
+		// Same as serialize, except for strings which are returned as is (unquoted and unescaped).
+		std::string toString() const;
 
 		bool contains(const std::string& key) const {
 			assert(_type == Type::object);
@@ -194,12 +199,14 @@ class JSON {
 
 		value& push(value&& val) {
 			assert(_type == Type::array);
+			unpack();
 			_value.as_array.push_back(std::move(val));
 			return _value.as_array.back();
 		}
 
 		value& push(const value& val) {
 			assert(_type == Type::array);
+			unpack();
 			_value.as_array.push_back(val);
 			return _value.as_array.back();
 		}
@@ -215,10 +222,13 @@ class JSON {
 		}
 		const array& asArray() const {
 			assert(_type == Type::array);
+			if(_packing != Packing::none)
+				return packedConstAccess();
 			return _value.as_array;
 		}
 		array& asArray() {
 			assert(_type == Type::array);
+			unpack();
 			return _value.as_array;
 		}
 		const number& asNumber() const {
@@ -237,6 +247,30 @@ class JSON {
 			assert(_type == Type::string);
 			return _value.as_string;
 		}
+		bool asBoolean() const {
+			assert(_type == Type::boolean);
+			return _value.as_boolean;
+		}
+
+		// Arrays made only of reals (or only of integers) can be stored as a plain buffer of numbers rather than an array of values (see ParseOptions::packNumericArrays).
+		// They are still arrays: The non-const generic interface (asArray, operator[], iteration...) converts them back to an array of values on first use. Const
+		// accessors never modify the value (it can be shared between threads) and expect unpacked arrays: On packed ones, they log an error and see an empty
+		// array (operator[] returns null). Read packed arrays through asFloats()/asIntegers(), copyTo() or to<>(), or call unpackArrays() on the document
+		// before handing it out.
+		bool isPackedFloats() const { return _type == Type::array && _packing == Packing::floats; }
+		bool isPackedIntegers() const { return _type == Type::array && _packing == Packing::integers; }
+		std::span<const float> asFloats() const {
+			assert(isPackedFloats());
+			return _value.as_floats;
+		}
+		std::span<const int> asIntegers() const {
+			assert(isPackedIntegers());
+			return _value.as_integers;
+		}
+		// Copies the count elements of this array of numbers to out, converting them to floats. Reads packed arrays directly.
+		void copyTo(float* out, size_t count) const;
+		// Converts all the packed arrays of this value, and of its descendants, back to arrays of values.
+		void unpackArrays();
 
 		// Interpret value as of type T
 		template<class T>
@@ -476,6 +510,7 @@ class JSON {
 		};
 
 		iterator begin() noexcept {
+			unpack();
 			if(_type == Type::array)
 				return _value.as_array.begin();
 			if(_type == Type::object)
@@ -485,6 +520,8 @@ class JSON {
 		}
 
 		const_iterator begin() const noexcept {
+			if(_packing != Packing::none)
+				return packedConstAccess().cbegin();
 			if(_type == Type::array)
 				return _value.as_array.cbegin();
 			if(_type == Type::object)
@@ -494,6 +531,7 @@ class JSON {
 		}
 
 		iterator end() noexcept {
+			unpack();
 			if(_type == Type::array)
 				return _value.as_array.end();
 			if(_type == Type::object)
@@ -503,6 +541,8 @@ class JSON {
 		}
 
 		const_iterator end() const noexcept {
+			if(_packing != Packing::none)
+				return packedConstAccess().cend();
 			if(_type == Type::array)
 				return _value.as_array.cend();
 			if(_type == Type::object)
@@ -513,10 +553,15 @@ class JSON {
 
 		const value& operator[](size_t idx) const {
 			assert(_type == Type::array);
+			if(_packing != Packing::none) {
+				packedConstAccess();
+				return null();
+			}
 			return _value.as_array[idx];
 		}
 		value& operator[](size_t idx) {
 			assert(_type == Type::array);
+			unpack();
 			return _value.as_array[idx];
 		}
 
@@ -552,22 +597,47 @@ class JSON {
 			ValueType(){};
 			~ValueType(){};
 
-			string as_string;
-			number as_number{0};
-			array  as_array;
-			object as_object;
-			bool   as_boolean;
-			null_t as_null;
+			string			   as_string;
+			number			   as_number{0};
+			array			   as_array;
+			object			   as_object;
+			bool			   as_boolean;
+			null_t			   as_null;
+			std::vector<float> as_floats;
+			std::vector<int>   as_integers;
+		};
+		enum class Packing : uint8_t {
+			none,
+			floats,
+			integers
 		};
-		Type	  _type = Type::null;
+		Type			  _type = Type::null;
+		Packing	  _packing = Packing::none; // Only relevant for arrays
 		ValueType _value = {};
 
+		inline void unpack() {
+			if(_packing != Packing::none)
+				unpackArray();
+		}
+		void unpackArray();
+		// Const generic access to a packed array, which can't be unpacked in place: Logs an error and returns an empty array.
+		const array&		packedConstAccess() const;
+		static const value& null();
+
 		void swap(value&& v) {
 			_type = v._type;
+			_packing = v._packing;
 			switch(_type) {
 				case Type::string: new(&_value.as_string) string{std::move(v._value.as_string)}; break;
 				case Type::number: new(&_value.as_number) number{std::move(v._value.as_number)}; break;
-				case Type::array: new(&_value.as_array) array{std::move(v._value.as_array)}; break;
+				case Type::array:
+					if(_packing == Packing::floats)
+						new(&_value.as_floats) std::vector<float>{std::move(v._value.as_floats)};
+					else if(_packing == Packing::integers)
+						new(&_value.as_integers) std::vector<int>{std::move(v._value.as_integers)};
+					else
+						new(&_value.as_array) array{std::move(v._value.as_array)};
+					break;
 				case Type::object: new(&_value.as_object) object{std::move(v._value.as_object)}; break;
 				case Type::boolean: _value.as_boolean = v._value.as_boolean; break;
 				case Type::null: new(&_value.as_null) null_t{std::move(v._value.as_null)}; break;
@@ -576,10 +646,18 @@ class JSON {
 
 		void copy(const value& v) {
 			_type = v._type;
+			_packing = v._packing;
 			switch(_type) {
 				case Type::string: new(&_value.as_string) string{v._value.as_string}; break;
 				case Type::number: new(&_value.as_number) number{v._value.as_number}; break;
-				case Type::array: new(&_value.as_array) array{v._value.as_array}; break;
+				case Type::array:
+					if(_packing == Packing::floats)
+						new(&_value.as_floats) std::vector<float>{v._value.as_floats};
+					else if(_packing == Packing::integers)
+						new(&_value.as_integers) std::vector<int>{v._value.as_integers};
+					else
+						new(&_value.as_array) array{v._value.as_array};
+					break;
 				case Type::object: new(&_value.as_object) object{v._value.as_object}; break;
 				case Type::boolean: _value.as_boolean = v._value.as_boolean; break;
 				case Type::null: new(&_value.as_null) null_t{v._value.as_null}; break;
@@ -587,31 +665,11 @@ class JSON {
 		}
 	};
 
-	static inline std::string toString(const array& value) {
-		std::string s;
-		s += '[';
-		for(const auto& v : value)
-			s += v.serialize() + ", ";
-		if(value.size() > 0) {
-			s.pop_back(); // Remove trailing ', '
-			s.pop_back();
-		}
-		s += ']';
-		return s;
-	}
-
-	static inline std::string toString(const object& value) {
-		std::string s;
-		s += '{';
-		for(const auto& v : value)
-			s += std::format("\"{}\": {}, ", v.first, v.second.serialize());
-		if(value.size() > 0) {
-			s.pop_back();
-			s.pop_back();
-		}
-		s += '}';
-		return s;
-	}
+	// Compact serialization, see JSON::Writer
+	static std::string toString(const array& value);
+	static std::string toString(std::span<const float> value);
+	static std::string toString(std::span<const int> value);
+	static std::string toString(const object& value);
 
 	struct KeyValue {
 		string key;
@@ -626,6 +684,16 @@ class JSON {
 	bool parse(std::istream&);
 	bool parse(char* data, size_t size);
 
+	struct ParseOptions {
+		// Walk a structural index of the input built ahead of time using SIMD instructions (see JSONStructuralIndex.hpp) rather than scanning it byte by byte.
+		bool useStructuralIndex = true;
+		// Store arrays made only of reals (or only of integers) as packed buffers of numbers, see value::asFloats(). Greatly reduces the memory used by numeric heavy documents.
+		bool packNumericArrays = false;
+	};
+	// Parses directly from a contiguous buffer (no stream involved). Preferred over parse(std::istream&) whenever the whole document is already in memory.
+	bool parse(std::string_view data);
+	bool parse(std::string_view data, const ParseOptions& options);
+
 	bool save(const std::filesystem::path&) const;
 	bool save(std::ostream&) const;
 
@@ -660,12 +728,53 @@ class JSON {
 	static bool expectImmediate(char c, std::istream&);
 	static bool expect(char c, std::istream&);
 
+	// Buffer parser: Same grammar as the stream parser above, but works with a simple pointer cursor over a contiguous buffer.
+	struct Cursor {
+		const char* cur;
+		const char* end;
+		bool		packNumericArrays = false;
+	};
+
+	inline static char skipWhitespace(Cursor& c) {
+		while(c.cur < c.end && isWhitespace(*c.cur))
+			++c.cur;
+		return c.cur < c.end ? *c.cur++ : '\0';
+	}
+
+	static object parseObject(Cursor&);
+	static array  parseArray(Cursor&);
+	static string parseString(Cursor&);
+	static number parseNumber(Cursor&);
+	static bool	  parseBoolean(Cursor&);
+	static null_t parseNull(Cursor&);
+	static value  parseValue(Cursor&);
+	// Parses the rest of an array (after '[') as a packed array of numbers, if it is one. Leaves c untouched otherwise.
+	static bool parsePackedArray(Cursor&, value& out);
+
+	static bool expectImmediate(const char* str, Cursor&);
+	static bool expect(char c, Cursor&);
+
+	// Indexed parser: Walks the structural index, only touching the input to read strings and scalars.
+	// idx always points to the next structural character to consume, *(idx - 1) is the last consumed one.
+	struct IndexCursor {
+		const char*		data;
+		const char*		end;
+		const uint32_t* idx;
+		const uint32_t* idxEnd;
+		bool			packNumericArrays = false;
+	};
+
+	static object parseObject(IndexCursor&);
+	static array  parseArray(IndexCursor&);
+	static string parseString(IndexCursor&);
+	static value  parseValue(IndexCursor&);
+
+
 	value _root;
 };
 
-inline std::ostream& operator<<(std::ostream& os, const JSON::value& value) {
-	return os << value.toString();
-}
+// Writes the JSON representation of value (see JSON::Writer).
+std::ostream& operator<<(std::ostream& os, const JSON::value& value);
 
 inline std::ostream& operator<<(std::ostream& os, const JSON& json) {
 	return os << json.getRoot();
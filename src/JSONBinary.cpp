@@ -0,0 +1,166 @@
+#include "JSONBinary.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+void JSON::BinaryWriter::beginContainer(JSONBinaryTag tag) {
+	writeTag(tag);
+	_openContainers.push_back(_buffer.size());
+	_containerCounts.push_back(0);
+	writeRaw(uint32_t{0}); // Patched by endContainer
+}
+
+void JSON::BinaryWriter::endContainer() {
+	assert(!_openContainers.empty());
+	std::memcpy(_buffer.data() + _openContainers.back(), &_containerCounts.back(), sizeof(uint32_t));
+	_openContainers.pop_back();
+	_containerCounts.pop_back();
+	valueWritten();
+}
+
+JSON::BinaryWriter& JSON::BinaryWriter::beginObject() {
+	beginContainer(JSONBinaryTag::Object);
+	return *this;
+}
+
+JSON::BinaryWriter& JSON::BinaryWriter::endObject() {
+	endContainer();
+	return *this;
+}
+
+JSON::BinaryWriter& JSON::BinaryWriter::beginArray() {
+	beginContainer(JSONBinaryTag::Array);
+	return *this;
+}
+
+JSON::BinaryWriter& JSON::BinaryWriter::endArray() {
+	endContainer();
+	return *this;
+}
+
+JSON::BinaryWriter& JSON::BinaryWriter::key(std::string_view k) {
+	auto it = _keyIndices.find(k);
+	if(it == _keyIndices.end()) {
+		const auto& stored = _keys.emplace_back(k);
+		it = _keyIndices.emplace(std::string_view{stored}, static_cast<uint32_t>(_keys.size() - 1)).first;
+	}
+	writeRaw(it->second);
+	return *this;
+}
+
+JSON::BinaryWriter& JSON::BinaryWriter::write(std::string_view str) {
+	writeTag(JSONBinaryTag::String);
+	writeRaw(static_cast<uint32_t>(str.size()));
+	_buffer.append(str);
+	valueWritten();
+	return *this;
+}
+
+JSON::BinaryWriter& JSON::BinaryWriter::write(int i) {
+	writeTag(JSONBinaryTag::Integer);
+	writeRaw(static_cast<int32_t>(i));
+	valueWritten();
+	return *this;
+}
+
+JSON::BinaryWriter& JSON::BinaryWriter::write(float f) {
+	writeTag(JSONBinaryTag::Real);
+	writeRaw(f);
+	valueWritten();
+	return *this;
+}
+
+JSON::BinaryWriter& JSON::BinaryWriter::write(bool b) {
+	writeTag(b ? JSONBinaryTag::True : JSONBinaryTag::False);
+	valueWritten();
+	return *this;
+}
+
+JSON::BinaryWriter& JSON::BinaryWriter::write(null_t) {
+	writeTag(JSONBinaryTag::Null);
+	valueWritten();
+	return *this;
+}
+
+JSON::BinaryWriter& JSON::BinaryWriter::write(std::span<const float> values) {
+	writeTag(JSONBinaryTag::RealArray);
+	writeRaw(static_cast<uint32_t>(values.size()));
+	_buffer.append(reinterpret_cast<const char*>(values.data()), values.size_bytes());
+	valueWritten();
+	return *this;
+}
+
+JSON::BinaryWriter& JSON::BinaryWriter::write(std::span<const int> values) {
+	writeTag(JSONBinaryTag::IntegerArray);
+	writeRaw(static_cast<uint32_t>(values.size()));
+	_buffer.append(reinterpret_cast<const char*>(values.data()), values.size_bytes());
+	valueWritten();
+	return *this;
+}
+
+JSON::BinaryWriter& JSON::BinaryWriter::write(const number& n) {
+	if(n.isReal())
+		return write(n.asReal());
+	return write(n.asInteger());
+}
+
+JSON::BinaryWriter& JSON::BinaryWriter::write(const array& a) {
+	// Arrays of reals (colors, vectors...) are stored natively.
+	const bool reals = !a.empty() && std::all_of(a.begin(), a.end(), [](const value& v) { return v.getType() == value::Type::number && v.asNumber().isReal(); });
+	if(reals) {
+		writeTag(JSONBinaryTag::RealArray);
+		writeRaw(static_cast<uint32_t>(a.size()));
+		for(const auto& v : a)
+			writeRaw(v.asNumber().asReal());
+		valueWritten();
+		return *this;
+	}
+	beginArray();
+	for(const auto& v : a)
+		write(v);
+	return endArray();
+}
+
+JSON::BinaryWriter& JSON::BinaryWriter::write(const object& o) {
+	beginObject();
+	for(const auto& [k, v] : o)
+		key(k).write(v);
+	return endObject();
+}
+
+JSON::BinaryWriter& JSON::BinaryWriter::write(const value& v) {
+	switch(v.getType()) {
+		case value::Type::string: return write(v.asString());
+		case value::Type::number: return write(v.asNumber());
+		case value::Type::array:
+			if(v.isPackedFloats())
+				return write(v.asFloats());
+			if(v.isPackedIntegers())
+				return write(v.asIntegers());
+			return write(v.asArray());
+		case value::Type::object: return write(v.asObject());
+		case value::Type::boolean: return write(v.asBoolean());
+		default: return write(null_t{});
+	}
+}
+
+std::string JSON::BinaryWriter::getEncoded() const {
+	assert(_openContainers.empty());
+	std::string r;
+	size_t		dictionarySize = sizeof(uint32_t);
+	for(const auto& k : _keys)
+		dictionarySize += sizeof(uint32_t) + k.size();
+	r.reserve(dictionarySize + _buffer.size());
+	const auto appendSize = [&](size_t size) {
+		const auto s = static_cast<uint32_t>(size);
+		r.append(reinterpret_cast<const char*>(&s), sizeof(s));
+	};
+	appendSize(_keys.size());
+	for(const auto& k : _keys) {
+		appendSize(k.size());
+		r.append(k);
+	}
+	r.append(_buffer);
+	return r;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <deque>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <JSON.hpp>
+
+// Compact binary encoding of JSON documents (used for the "BJSN" chunk of .scene files), decoded in a single pass by JSON::Document::parseBinary.
+// Layout (little-endian, no alignment):
+//   uint32 keyCount, then keyCount times: uint32 length, UTF-8 bytes  -- Key dictionary, object members refer to keys by index
+//   Root value: uint8 tag (JSONBinaryTag) followed by its payload:
+//     Null, False, True: None
+//     Integer: int32                  Real: float32
+//     String: uint32 length, bytes
+//     Array: uint32 count, count values
+//     Object: uint32 count, count times: uint32 key index, value
+//     RealArray: uint32 count, count float32      IntegerArray: uint32 count, count int32
+enum class JSONBinaryTag : uint8_t {
+	Null,
+	False,
+	True,
+	Integer,
+	Real,
+	String,
+	Array,
+	Object,
+	RealArray,
+	IntegerArray,
+};
+
+// Same interface as JSON::Writer, producing the binary encoding. Keys are deduplicated in a dictionary and arrays of floats are stored natively.
+class JSON::BinaryWriter {
+  public:
+	BinaryWriter() = default;
+	BinaryWriter(const BinaryWriter&) = delete;
+	BinaryWriter& operator=(const BinaryWriter&) = delete;
+
+	BinaryWriter& beginObject();
+	BinaryWriter& endObject();
+	BinaryWriter& beginArray();
+	BinaryWriter& endArray();
+	BinaryWriter& key(std::string_view);
+
+	BinaryWriter& write(std::string_view);
+	BinaryWriter& write(const char* str) { return write(std::string_view{str}); }
+	BinaryWriter& write(const std::string& str) { return write(std::string_view{str}); }
+	BinaryWriter& write(int);
+	BinaryWriter& write(uint32_t i) { return write(static_cast<int>(i)); }
+	BinaryWriter& write(size_t i) { return write(static_cast<int>(i)); }
+	BinaryWriter& write(float);
+	BinaryWriter& write(bool);
+	BinaryWriter& write(null_t);
+	BinaryWriter& write(std::span<const float>); // Array of numbers
+	BinaryWriter& write(std::span<const int>);
+	BinaryWriter& write(const number&);
+	BinaryWriter& write(const array&);
+	BinaryWriter& write(const object&);
+	BinaryWriter& write(const value&);
+
+	// Shorthand for key(k).write(v)
+	template<typename T>
+	BinaryWriter& write(std::string_view k, const T& v) {
+		return key(k).write(v);
+	}
+
+	// Complete encoding (key dictionary followed by the values written so far). All containers must be closed.
+	std::string getEncoded() const;
+
+  private:
+	std::string								  _buffer;			// Values
+	std::unordered_map<std::string_view, uint32_t> _keyIndices;		 // Key dictionary, views into _keys
+	std::deque<std::string>						   _keys;			 // Dictionary keys, by index (deque: stable references)
+	std::vector<size_t>							   _openContainers;	 // Offset of the count of each open container
+	std::vector<uint32_t>						   _containerCounts; // Number of values written to each open container
+
+	void valueWritten() {
+		if(!_containerCounts.empty())
+			++_containerCounts.back();
+	}
+	void writeTag(JSONBinaryTag tag) { _buffer += static_cast<char>(tag); }
+	template<typename T>
+	void writeRaw(const T& v) {
+		_buffer.append(reinterpret_cast<const char*>(&v), sizeof(T));
+	}
+	void beginContainer(JSONBinaryTag);
+	void endContainer();
+};
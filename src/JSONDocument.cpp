@@ -0,0 +1,633 @@
+#include "JSONDocument.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <JSONBinary.hpp>
+#include <JSONStructuralIndex.hpp>
+#include <Logger.hpp>
+
+struct JSON::Document::ParseStacks {
+	std::vector<Node>	nodes;
+	std::vector<Member> members;
+	bool				packNumericArrays = false;
+};
+
+struct JSON::Document::Tape {
+	std::string_view	  data;
+	JSONStructuralIndex	  index;
+	std::vector<uint32_t> closing; // Index of the matching closing bracket, for each opening bracket of the index
+	Arena				  arena;   // Materialized children
+	ParseStacks			  stacks;  // Materialization is not recursive: Deferred nodes only parse one level.
+	bool				  failed = false; // A deferred node was malformed, see hasError
+};
+
+void* JSON::Document::Arena::allocate(size_t size, size_t alignment) {
+	auto aligned = reinterpret_cast<std::byte*>((reinterpret_cast<uintptr_t>(_cursor) + alignment - 1) & ~(alignment - 1));
+	if(_cursor == nullptr || aligned + size > _end) {
+		const auto blockSize = std::max(size + alignment, _nextBlockSize);
+		_nextBlockSize = std::min(2 * _nextBlockSize, MaxBlockSize);
+		_blocks.push_back(std::make_unique_for_overwrite<std::byte[]>(blockSize));
+		_size += blockSize;
+		_cursor = _blocks.back().get();
+		_end = _cursor + blockSize;
+		aligned = reinterpret_cast<std::byte*>((reinterpret_cast<uintptr_t>(_cursor) + alignment - 1) & ~(alignment - 1));
+	}
+	_cursor = aligned + size;
+	return aligned;
+}
+
+JSON::Document::Document(const std::filesystem::path& path) {
+	parse(path);
+}
+
+JSON::Document::Document() = default;
+JSON::Document::Document(Document&&) noexcept = default;
+JSON::Document& JSON::Document::operator=(Document&&) noexcept = default;
+JSON::Document::~Document() = default;
+
+size_t JSON::Document::getArenaSize() const {
+	return _arena.getSize() + (_tape ? _tape->arena.getSize() : 0);
+}
+
+bool JSON::Document::hasError() const {
+	return _tape && _tape->failed;
+}
+
+bool JSON::Document::parse(const std::filesystem::path& path) {
+	return parse(path, ParseOptions{});
+}
+
+bool JSON::Document::parse(const std::filesystem::path& path, const ParseOptions& options) {
+	std::ifstream file{path, std::ios::binary | std::ios::ate};
+	if(!file) {
+		error("JSON::Document::parse error: Could not open ''{}'.\n", path);
+		return false;
+	}
+	const auto size = static_cast<size_t>(file.tellg());
+	clear();
+	_source = std::make_unique_for_overwrite<char[]>(size);
+	file.seekg(0, std::ios::beg);
+	if(!file.read(_source.get(), size)) {
+		error("JSON::Document::parse error: Could not read ''{}'.\n", path);
+		return false;
+	}
+	return parseSource(std::string_view{_source.get(), size}, options);
+}
+
+bool JSON::Document::parse(std::string_view data) {
+	return parse(data, ParseOptions{});
+}
+
+bool JSON::Document::parse(std::string_view data, const ParseOptions& options) {
+	clear();
+	return parseSource(data, options);
+}
+
+void JSON::Document::clear() {
+	_root = nullptr;
+	_tape.reset();
+	_arena = Arena{};
+	_source.reset();
+}
+
+bool JSON::Document::parseSource(std::string_view data, const ParseOptions& options) {
+	if(options.lazy) {
+		if(!buildTape(data))
+			return false;
+		Node root;
+		root._type = data[_tape->index.getPositions()[0]] == '{' ? Node::Type::object : Node::Type::array;
+		root._deferred = true;
+		root._size = 0;
+		root._tape = _tape.get();
+		_root = _arena.copy(std::span<const Node>{&root, 1});
+		return true;
+	}
+
+	Cursor		cursor{data.data(), data.data() + data.size()};
+	ParseStacks stacks{.packNumericArrays = options.packNumericArrays};
+	Node		root;
+	char		byte = skipWhitespace(cursor);
+	if(byte != '{' && byte != '[') {
+		error("JSON::Document::parse error: Expected '{{' or '[', got '{}'\n", byte);
+		return false;
+	}
+	if(!(byte == '{' ? parseObject(cursor, root, stacks) : parseArray(cursor, root, stacks)))
+		return false;
+	_root = _arena.copy(std::span<const Node>{&root, 1});
+	return true;
+}
+
+bool JSON::Document::parseObject(Cursor& c, Node& node, ParseStacks& stacks) {
+	const auto base = stacks.members.size();
+	while(true) {
+		char byte = skipWhitespace(c);
+		switch(byte) {
+			case '}': {
+				node._type = Node::Type::object;
+				node._size = static_cast<uint32_t>(stacks.members.size() - base);
+				node._members = _arena.copy(std::span<const Member>{stacks.members.data() + base, node._size});
+				stacks.members.resize(base);
+				return true;
+			}
+			case '"': {
+				Member member{.key = parseString(c, _arena)};
+				if(!expect(':', c) || !parseValue(c, member.value, stacks))
+					return false;
+				stacks.members.push_back(member);
+				break;
+			}
+			case ',': break;
+			default: error("JSON::Document::parseObject error: Unexpected character '{}'.\n", byte); return false;
+		}
+	}
+}
+
+bool JSON::Document::parseArray(Cursor& c, Node& node, ParseStacks& stacks) {
+	const auto base = stacks.nodes.size();
+	while(true) {
+		char byte = skipWhitespace(c);
+		switch(byte) {
+			case ']': {
+				node._type = Node::Type::array;
+				node._size = static_cast<uint32_t>(stacks.nodes.size() - base);
+				const std::span<const Node> elements{stacks.nodes.data() + base, node._size};
+				if(!stacks.packNumericArrays || !packArray(elements, node))
+					node._elements = _arena.copy(elements);
+				stacks.nodes.resize(base);
+				return true;
+			}
+			case ',': break;
+			case '\0': error("JSON::Document::parseArray error: Unexpected end of input.\n"); return false;
+			default: {
+				--c.cur; // Put back the first character of the value
+				Node element;
+				if(!parseValue(c, element, stacks))
+					return false;
+				stacks.nodes.push_back(element);
+				break;
+			}
+		}
+	}
+}
+
+bool JSON::Document::packArray(std::span<const Node> elements, Node& node) {
+	if(elements.empty())
+		return false;
+	const bool reals = elements[0]._isReal;
+	for(const auto& e : elements)
+		if(e._type != Node::Type::number || e._isReal != reals)
+			return false;
+	node._packed = true;
+	node._isReal = reals;
+	if(reals) {
+		auto floats = _arena.allocateArray<float>(elements.size());
+		std::transform(elements.begin(), elements.end(), floats, [](const Node& e) { return e._real; });
+		node._floats = floats;
+	} else {
+		auto integers = _arena.allocateArray<int>(elements.size());
+		std::transform(elements.begin(), elements.end(), integers, [](const Node& e) { return e._integer; });
+		node._integers = integers;
+	}
+	return true;
+}
+
+std::string_view JSON::Document::parseString(Cursor& c, Arena& arena) {
+	// We assume the leading '"' has already been consumed.
+	const char* begin = c.cur;
+	const char* stop = findQuoteOrBackslash(c.cur, c.end);
+	if(stop < c.end && *stop == '"') {
+		c.cur = stop + 1;
+		return {begin, stop};
+	}
+	// Escape sequences: Decode the string and store it in the arena.
+	const auto decoded = JSON::parseString(c);
+	auto	   ptr = arena.copy(std::span<const char>{decoded.data(), decoded.size()});
+	return {ptr, decoded.size()};
+}
+
+bool JSON::Document::parseValue(Cursor& c, Node& node, ParseStacks& stacks) {
+	char byte = skipWhitespace(c);
+	switch(byte) {
+		case '"': {
+			auto str = parseString(c, _arena);
+			node._type = Node::Type::string;
+			node._string = str.data();
+			node._size = static_cast<uint32_t>(str.size());
+			return true;
+		}
+		case '{': return parseObject(c, node, stacks);
+		case '[': return parseArray(c, node, stacks);
+		default: --c.cur; return parseScalar(c, node);
+	}
+}
+
+bool JSON::Document::parseScalar(Cursor& c, Node& node) {
+	const char byte = c.cur < c.end ? *c.cur : '\0';
+	switch(byte) {
+		case 't':
+		case 'f':
+			node._type = Node::Type::boolean;
+			node._boolean = JSON::parseBoolean(c);
+			return true;
+		case 'n':
+			JSON::parseNull(c);
+			node._type = Node::Type::null;
+			return true;
+		case '-':
+		case '0':
+		case '1':
+		case '2':
+		case '3':
+		case '4':
+		case '5':
+		case '6':
+		case '7':
+		case '8':
+		case '9': {
+			const auto n = JSON::parseNumber(c);
+			node._type = Node::Type::number;
+			node._isReal = n.isReal();
+			if(node._isReal)
+				node._real = n.asReal();
+			else
+				node._integer = n.asInteger();
+			return true;
+		}
+	}
+	error("JSON::Document::parseValue: Unexpected character '{}'.\n", byte);
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Lazy mode
+
+bool JSON::Document::buildTape(std::string_view data) {
+	_tape = std::make_unique<Tape>();
+	_tape->data = data;
+	if(!_tape->index.build(data)) {
+		error("JSON::Document::parse error: Unterminated string.\n");
+		return false;
+	}
+	// Match brackets up front: Deferred nodes use it to skip their unparsed children.
+	const auto&			  positions = _tape->index.getPositions();
+	std::vector<uint32_t> open;
+	_tape->closing.resize(positions.size());
+	for(uint32_t i = 0; i < positions.size(); ++i) {
+		const char byte = data[positions[i]];
+		if(byte == '{' || byte == '[') {
+			open.push_back(i);
+		} else if(byte == '}' || byte == ']') {
+			if(open.empty() || data[positions[open.back()]] != (byte == '}' ? '{' : '[')) {
+				error("JSON::Document::parse error: Unexpected '{}' (offset {}).\n", byte, positions[i]);
+				return false;
+			}
+			_tape->closing[open.back()] = i;
+			open.pop_back();
+		}
+	}
+	if(!open.empty()) {
+		error("JSON::Document::parse error: Unexpected end of input.\n");
+		return false;
+	}
+	Cursor c{data.data(), data.data() + data.size()};
+	char   byte = skipWhitespace(c);
+	if((byte != '{' && byte != '[') || positions.empty() || positions[0] != c.cur - 1 - data.data()) {
+		error("JSON::Document::parse error: Expected '{{' or '[', got '{}'\n", byte);
+		return false;
+	}
+	return true;
+}
+
+bool JSON::Document::materialize(const Node& n) {
+	// Deferred nodes live in arena memory and are never truly const: Only the cached content changes, not the logical value.
+	auto&		node = const_cast<Node&>(n);
+	auto&		tape = *node._tape;
+	const auto& positions = tape.index.getPositions();
+	const char* data = tape.data.data();
+	const char* end = data + tape.data.size();
+	const auto	open = node._size;
+	const auto	close = tape.closing[open];
+	const bool	isObject = node._type == Node::Type::object;
+
+	// Parses the value following the structural character at index i - 1, scalars are not part of the index.
+	auto parseChild = [&](uint32_t& i, Node& child) {
+		Cursor c{data + positions[i - 1] + 1, end};
+		char   byte = skipWhitespace(c);
+		if(byte == '{' || byte == '[') {
+			assert(data + positions[i] == c.cur - 1);
+			child._type = byte == '{' ? Node::Type::object : Node::Type::array;
+			child._deferred = true;
+			child._size = i;
+			child._tape = &tape;
+			i = tape.closing[i] + 1;
+			return true;
+		}
+		if(byte == '"') {
+			auto str = parseString(c, tape.arena);
+			child._type = Node::Type::string;
+			child._string = str.data();
+			child._size = static_cast<uint32_t>(str.size());
+			i += 2;
+			return true;
+		}
+		--c.cur;
+		return parseScalar(c, child);
+	};
+
+	auto&	   stack = tape.stacks;
+	const auto base = isObject ? stack.members.size() : stack.nodes.size();
+	uint32_t   i = open + 1;
+	// Empty arrays can't be detected from the index alone: [] and [0] both have consecutive brackets.
+	Cursor first{data + positions[open] + 1, end};
+	bool   empty = skipWhitespace(first) == (isObject ? '}' : ']');
+	while(!empty) {
+		bool ok = true;
+		if(isObject) {
+			Member member;
+			if(i + 2 < close && data[positions[i]] == '"' && data[positions[i + 2]] == ':') {
+				Cursor c{data + positions[i] + 1, end};
+				member.key = parseString(c, tape.arena);
+				i += 3;
+				ok = parseChild(i, member.value);
+			} else
+				ok = false;
+			if(ok)
+				stack.members.push_back(member);
+		} else {
+			Node element;
+			ok = parseChild(i, element);
+			if(ok)
+				stack.nodes.push_back(element);
+		}
+		if(ok && i < close && data[positions[i]] != ',')
+			ok = false;
+		if(!ok) {
+			// Nothing of a malformed container is kept: It would be indistinguishable from a valid (smaller) one.
+			error("JSON::Document: Invalid {} (offset {}).\n", isObject ? "object" : "array", positions[std::min(i, close)]);
+			node._deferred = false;
+			node._size = 0;
+			node._elements = nullptr;
+			if(isObject)
+				stack.members.resize(base);
+			else
+				stack.nodes.resize(base);
+			tape.failed = true;
+			return false;
+		}
+		if(i++ == close)
+			break;
+	}
+
+	node._deferred = false;
+	if(isObject) {
+		node._size = static_cast<uint32_t>(stack.members.size() - base);
+		node._members = tape.arena.copy(std::span<const Member>{stack.members.data() + base, node._size});
+		stack.members.resize(base);
+	} else {
+		node._size = static_cast<uint32_t>(stack.nodes.size() - base);
+		node._elements = tape.arena.copy(std::span<const Node>{stack.nodes.data() + base, node._size});
+		stack.nodes.resize(base);
+	}
+	return true;
+}
+
+bool JSON::Document::Node::materialize() const {
+	if((_type != Type::array && _type != Type::object) || _packed)
+		return true;
+	bool ok = !_deferred || Document::materialize(*this);
+	if(_type == Type::object) {
+		for(const auto& m : asObject())
+			ok = m.value.materialize() && ok;
+	} else {
+		for(const auto& n : asArray())
+			ok = n.materialize() && ok;
+	}
+	return ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Binary encoding (see JSONBinary.hpp)
+
+struct JSON::Document::BinaryCursor {
+	const char*					  begin;
+	const char*					  cur;
+	const char*					  end;
+	std::vector<std::string_view> keys;
+
+	template<typename T>
+	bool read(T& v) {
+		if(end - cur < static_cast<ptrdiff_t>(sizeof(T)))
+			return false;
+		std::memcpy(&v, cur, sizeof(T));
+		cur += sizeof(T);
+		return true;
+	}
+	bool read(std::string_view& str) {
+		uint32_t size = 0;
+		if(!read(size) || static_cast<size_t>(end - cur) < size)
+			return false;
+		str = {cur, size};
+		cur += size;
+		return true;
+	}
+	// Cheap sanity check before allocating count elements: Each one takes at least elementSize bytes.
+	bool canHold(uint32_t count, size_t elementSize) const { return static_cast<size_t>(end - cur) / elementSize >= count; }
+};
+
+bool JSON::Document::parseBinary(std::string_view data) {
+	clear();
+	BinaryCursor c{data.data(), data.data(), data.data() + data.size()};
+	uint32_t	 keyCount = 0;
+	if(!c.read(keyCount) || !c.canHold(keyCount, sizeof(uint32_t))) {
+		error("JSON::Document::parseBinary error: Invalid key dictionary.\n");
+		return false;
+	}
+	c.keys.resize(keyCount);
+	for(auto& k : c.keys)
+		if(!c.read(k)) {
+			error("JSON::Document::parseBinary error: Invalid key dictionary.\n");
+			return false;
+		}
+	Node root;
+	if(!parseBinaryValue(c, root))
+		return false;
+	if(root.getType() != Node::Type::object && root.getType() != Node::Type::array) {
+		error("JSON::Document::parseBinary error: Root must be an object or an array.\n");
+		return false;
+	}
+	_root = _arena.copy(std::span<const Node>{&root, 1});
+	return true;
+}
+
+bool JSON::Document::parseBinaryValue(BinaryCursor& c, Node& node) {
+	const auto invalid = [&]() {
+		error("JSON::Document::parseBinary error: Invalid or truncated data (offset {}).\n", c.cur - c.begin);
+		return false;
+	};
+	uint8_t tag = 0;
+	if(!c.read(tag))
+		return invalid();
+	switch(static_cast<JSONBinaryTag>(tag)) {
+		case JSONBinaryTag::Null: node._type = Node::Type::null; return true;
+		case JSONBinaryTag::False:
+		case JSONBinaryTag::True:
+			node._type = Node::Type::boolean;
+			node._boolean = static_cast<JSONBinaryTag>(tag) == JSONBinaryTag::True;
+			return true;
+		case JSONBinaryTag::Integer:
+			node._type = Node::Type::number;
+			node._isReal = false;
+			return c.read(node._integer) || invalid();
+		case JSONBinaryTag::Real:
+			node._type = Node::Type::number;
+			node._isReal = true;
+			return c.read(node._real) || invalid();
+		case JSONBinaryTag::String: {
+			std::string_view str;
+			if(!c.read(str))
+				return invalid();
+			node._type = Node::Type::string;
+			node._string = str.data();
+			node._size = static_cast<uint32_t>(str.size());
+			return true;
+		}
+		case JSONBinaryTag::Array: {
+			uint32_t count = 0;
+			if(!c.read(count) || !c.canHold(count, 1))
+				return invalid();
+			// Counts are known up front: Children are decoded in place, no temporary stacks.
+			auto elements = _arena.allocateArray<Node>(count);
+			for(uint32_t i = 0; i < count; ++i)
+				if(!parseBinaryValue(c, elements[i]))
+					return false;
+			node._type = Node::Type::array;
+			node._size = count;
+			node._elements = elements;
+			return true;
+		}
+		case JSONBinaryTag::Object: {
+			uint32_t count = 0;
+			if(!c.read(count) || !c.canHold(count, sizeof(uint32_t) + 1))
+				return invalid();
+			auto members = _arena.allocateArray<Member>(count);
+			for(uint32_t i = 0; i < count; ++i) {
+				uint32_t keyIndex = 0;
+				if(!c.read(keyIndex) || keyIndex >= c.keys.size())
+					return invalid();
+				members[i].key = c.keys[keyIndex];
+				if(!parseBinaryValue(c, members[i].value))
+					return false;
+			}
+			node._type = Node::Type::object;
+			node._size = count;
+			node._members = members;
+			return true;
+		}
+		case JSONBinaryTag::RealArray:
+		case JSONBinaryTag::IntegerArray: {
+			const bool reals = static_cast<JSONBinaryTag>(tag) == JSONBinaryTag::RealArray;
+			uint32_t   count = 0;
+			if(!c.read(count) || !c.canHold(count, sizeof(float)))
+				return invalid();
+			auto elements = _arena.allocateArray<Node>(count);
+			for(uint32_t i = 0; i < count; ++i) {
+				elements[i]._type = Node::Type::number;
+				elements[i]._isReal = reals;
+				if(reals)
+					c.read(elements[i]._real);
+				else
+					c.read(elements[i]._integer);
+			}
+			node._type = Node::Type::array;
+			node._size = count;
+			node._elements = elements;
+			return true;
+		}
+	}
+	return invalid();
+}
+
+const JSON::Document::Node* JSON::Document::Node::find(std::string_view key) const {
+	assert(_type == Type::object);
+	for(const auto& m : asObject())
+		if(m.key == key)
+			return &m.value;
+	return nullptr;
+}
+
+const JSON::Document::Node& JSON::Document::Node::operator[](std::string_view key) const {
+	static const Node Null;
+	auto			  n = find(key);
+	return n ? *n : Null;
+}
+
+const JSON::Document::Node& JSON::Document::Node::packedGenericAccess() const {
+	static const Node Null;
+	error("JSON::Document: Generic access to a packed array of {} numbers, use asFloats()/asIntegers(), copyTo() or to<>().\n", _size);
+	return Null;
+}
+
+void JSON::Document::Node::copyTo(float* out, size_t count) const {
+	if(isPackedFloats()) {
+		assert(_size == count);
+		std::copy_n(_floats, count, out);
+	} else if(isPackedIntegers()) {
+		assert(_size == count);
+		std::transform(_integers, _integers + count, out, [](int i) { return static_cast<float>(i); });
+	} else {
+		const auto elements = asArray();
+		assert(elements.size() == count);
+		for(size_t i = 0; i < count; ++i)
+			out[i] = elements[i].to<float>();
+	}
+}
+
+JSON::Document::Node::const_iterator JSON::Document::Node::begin() const {
+	assert(_type == Type::array || _type == Type::object);
+	resolve();
+	if(_packed) {
+		packedGenericAccess();
+		return {nullptr, sizeof(Node)};
+	}
+	if(_type == Type::object)
+		return {reinterpret_cast<const std::byte*>(&_members->value), sizeof(Member)};
+	return {reinterpret_cast<const std::byte*>(_elements), sizeof(Node)};
+}
+
+JSON::Document::Node::const_iterator JSON::Document::Node::end() const {
+	assert(_type == Type::array || _type == Type::object);
+	resolve();
+	if(_packed)
+		return {nullptr, sizeof(Node)};
+	if(_type == Type::object)
+		return {reinterpret_cast<const std::byte*>(&_members->value) + _size * sizeof(Member), sizeof(Member)};
+	return {reinterpret_cast<const std::byte*>(_elements + _size), sizeof(Node)};
+}
+
+JSON::value JSON::Document::Node::toValue() const {
+	switch(_type) {
+		case Type::object: {
+			JSON::object o;
+			for(const auto& m : asObject())
+				o.emplace(std::string{m.key}, m.value.toValue());
+			return o;
+		}
+		case Type::array: {
+			if(isPackedFloats())
+				return value{std::vector<float>(_floats, _floats + _size)};
+			if(isPackedIntegers())
+				return value{std::vector<int>(_integers, _integers + _size)};
+			JSON::array a;
+			a.reserve(size());
+			for(const auto& n : asArray())
+				a.push_back(n.toValue());
+			return a;
+		}
+		case Type::string: return std::string{asString()};
+		case Type::number: return _isReal ? value{_real} : value{_integer};
+		case Type::boolean: return _boolean;
+		default: return null_t{};
+	}
+}
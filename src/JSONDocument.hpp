@@ -0,0 +1,349 @@
+#pragma once
+
+#include <memory>
+#include <span>
+
+#include <JSON.hpp>
+
+// Read-only JSON document optimized for loading: Every node, key and escaped string lives in a monotonic arena owned by the document,
+// objects are flat spans of key/value pairs (kept in file order, looked up linearly) and strings without escape sequences are views into the source buffer.
+// Parsing makes a handful of allocations regardless of the document size, and destruction simply releases the arena blocks.
+// In lazy mode (see ParseOptions), parsing only builds a tape of the structural characters of the input: Objects and arrays are parsed the first time their
+// content is accessed, skipping subtrees that are never used altogether. Accessing a lazy document is not thread safe, even through const references: Either use
+// it from a single thread, or call Node::materialize() on the parts shared between threads first. Malformed deferred subtrees are only detected when they
+// are materialized: They are then seen as empty, and hasError() is set.
+// Use JSON (the DOM) to build or modify documents.
+class JSON::Document {
+  public:
+	class Node;
+	struct Member;
+
+	Document();
+	Document(const std::filesystem::path&);
+	Document(const Document&) = delete;
+	Document(Document&&) noexcept;
+	Document& operator=(const Document&) = delete;
+	Document& operator=(Document&&) noexcept;
+	~Document();
+
+	struct ParseOptions {
+		// Defer the parsing of objects and arrays until their first access.
+		bool lazy = false;
+		// Store arrays made only of reals (or only of integers) as packed buffers of numbers, see Node::isPackedFloats(). Ignored in lazy mode.
+		bool packNumericArrays = false;
+	};
+	// Reads the whole file, the document keeps the file content alive.
+	bool parse(const std::filesystem::path&);
+	bool parse(const std::filesystem::path&, const ParseOptions& options);
+	// The document references data: It must outlive the document.
+	bool parse(std::string_view data);
+	bool parse(std::string_view data, const ParseOptions& options);
+	// Decodes the binary encoding produced by JSON::BinaryWriter (see JSONBinary.hpp). Same lifetime requirement as above.
+	bool parseBinary(std::string_view data);
+
+	inline const Node& getRoot() const;
+	inline const Node& operator[](std::string_view key) const;
+	inline const Node& operator[](size_t idx) const;
+
+	// Total memory reserved by the arena(s), in bytes.
+	size_t getArenaSize() const;
+	// Lazy mode: A deferred object or array turned out to be malformed when it was materialized (see Node::materialize).
+	bool hasError() const;
+
+  private:
+	class Arena {
+	  public:
+		void*		  allocate(size_t size, size_t alignment);
+		inline size_t getSize() const { return _size; }
+
+		template<typename T>
+		T* copy(std::span<const T> data) {
+			auto ptr = static_cast<T*>(allocate(data.size_bytes(), alignof(T)));
+			std::copy(data.begin(), data.end(), ptr);
+			return ptr;
+		}
+		// Default constructed array of count elements.
+		template<typename T>
+		T* allocateArray(size_t count) {
+			auto ptr = static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+			std::uninitialized_default_construct_n(ptr, count);
+			return ptr;
+		}
+
+	  private:
+		static constexpr size_t					  MinBlockSize = 16 * 1024;
+		static constexpr size_t					  MaxBlockSize = 4 * 1024 * 1024;
+		std::vector<std::unique_ptr<std::byte[]>> _blocks;
+		std::byte*								  _cursor = nullptr;
+		std::byte*								  _end = nullptr;
+		size_t									  _nextBlockSize = MinBlockSize;
+		size_t									  _size = 0;
+	};
+
+	// Temporary storage used while parsing: Children are accumulated on these stacks until their parent is closed, then copied to the arena in one go.
+	struct ParseStacks;
+	// Lazy mode state, shared by all deferred nodes (heap allocated so they can point to it even if the document is moved).
+	struct Tape;
+	// Bounds checked reader over a binary encoded document.
+	struct BinaryCursor;
+
+	Arena					_arena;
+	std::unique_ptr<char[]> _source; // File content, when parsed from a path
+	std::unique_ptr<Tape>	_tape;
+	const Node*				_root = nullptr;
+
+	// Releases the previous content: Reusing a document for another parse doesn't grow its arena.
+	void					clear();
+	// Parses data, which is either _source or referenced by the caller.
+	bool					parseSource(std::string_view data, const ParseOptions&);
+	bool					parseValue(Cursor&, Node&, ParseStacks&);
+	bool					packArray(std::span<const Node> elements, Node&);
+	bool					parseObject(Cursor&, Node&, ParseStacks&);
+	bool					parseArray(Cursor&, Node&, ParseStacks&);
+	static bool				parseScalar(Cursor&, Node&);
+	static std::string_view parseString(Cursor&, Arena&);
+	bool					parseBinaryValue(BinaryCursor&, Node&);
+
+	bool		buildTape(std::string_view data);
+	static bool materialize(const Node&);
+};
+
+class JSON::Document::Node {
+  public:
+	using Type = JSON::value::Type;
+
+	Node() = default;
+
+	inline Type	  getType() const { return _type; }
+	inline bool	  isNull() const { return _type == Type::null; }
+	inline size_t size() const {
+		assert(_type == Type::array || _type == Type::object || _type == Type::string);
+		resolve();
+		return _size;
+	}
+
+	// Returns nullptr if this object doesn't have the key.
+	const Node*	 find(std::string_view key) const;
+	inline bool	 contains(std::string_view key) const { return find(key) != nullptr; }
+	// Returns a null node if the key doesn't exist.
+	const Node& operator[](std::string_view key) const;
+	inline const Node& operator[](size_t idx) const {
+		assert(_type == Type::array);
+		resolve();
+		if(_packed)
+			return packedGenericAccess();
+		assert(idx < _size);
+		return _elements[idx];
+	}
+
+	inline std::span<const Node> asArray() const {
+		assert(_type == Type::array);
+		resolve();
+		if(_packed) {
+			packedGenericAccess();
+			return {};
+		}
+		return {_elements, _size};
+	}
+	inline std::span<const Member> asObject() const;
+	inline std::string_view asString() const {
+		assert(_type == Type::string);
+		return {_string, _size};
+	}
+
+	// Arrays made only of reals (or only of integers), when parsed with ParseOptions::packNumericArrays. Like JSON::value, they are still arrays of size()
+	// elements but the generic interface (asArray, operator[], iteration) sees them as empty (and logs an error): Read them through asFloats()/asIntegers(),
+	// copyTo() or to<>() (e.g. to<glm::mat4>()).
+	inline bool					  isPackedFloats() const { return _packed && _isReal; }
+	inline bool					  isPackedIntegers() const { return _packed && !_isReal; }
+	inline std::span<const float> asFloats() const {
+		assert(isPackedFloats());
+		return {_floats, _size};
+	}
+	inline std::span<const int> asIntegers() const {
+		assert(isPackedIntegers());
+		return {_integers, _size};
+	}
+	// Copies the count elements of this array of numbers to out, converting them to floats. Reads packed arrays directly.
+	void copyTo(float* out, size_t count) const;
+
+	// Strict access (no conversion), see JSON::value::as
+	template<class T>
+	T as() const;
+	template<class T>
+	T as(const T& defaultValue) const {
+		if(_type == Type::null)
+			return defaultValue;
+		return as<T>();
+	}
+
+	// Access with implicit conversions (e.g. integer to float), see JSON::value::to
+	template<class T>
+	T to() const;
+	template<class T>
+	T to(const T& defaultValue) const {
+		if(_type == Type::null)
+			return defaultValue;
+		return to<T>();
+	}
+
+	// Quick access to property with cast to specified type and default value
+	template<typename T>
+	T operator()(std::string_view key, const T& defaultValue) const {
+		auto n = find(key);
+		if(n && n->_type != Type::null)
+			return n->as<T>();
+		return defaultValue;
+	}
+
+	// Same as operator(), but allows for implicit type conversion
+	template<typename T>
+	T get(std::string_view key, const T& defaultValue) const {
+		auto n = find(key);
+		if(n && n->_type != Type::null)
+			return n->to<T>();
+		return defaultValue;
+	}
+
+	// Iterates over the elements of an array, or the values of an object (like JSON::value).
+	class const_iterator {
+	  public:
+		using iterator_category = std::forward_iterator_tag;
+		using difference_type = std::ptrdiff_t;
+		using value_type = Node;
+		using pointer = const Node*;
+		using reference = const Node&;
+
+		const_iterator(const std::byte* ptr, size_t stride) : _ptr(ptr), _stride(stride) {}
+
+		reference		operator*() const { return *reinterpret_cast<const Node*>(_ptr); }
+		pointer			operator->() const { return reinterpret_cast<const Node*>(_ptr); }
+		const_iterator& operator++() {
+			_ptr += _stride;
+			return *this;
+		}
+		const_iterator operator++(int) {
+			auto tmp = *this;
+			++(*this);
+			return tmp;
+		}
+		friend bool operator==(const const_iterator& a, const const_iterator& b) { return a._ptr == b._ptr; }
+		friend bool operator!=(const const_iterator& a, const const_iterator& b) { return a._ptr != b._ptr; }
+
+	  private:
+		const std::byte* _ptr;
+		size_t			 _stride;
+	};
+
+	const_iterator begin() const;
+	const_iterator end() const;
+
+	// Deep copy to a JSON::value, for the (small) parts of a document that must outlive it.
+	JSON::value toValue() const;
+
+	// Lazy mode: Parses all the deferred descendants of this node now. Returns false if one of them is malformed (it is then empty). Subtrees found malformed
+	// by an earlier access are only reported by Document::hasError.
+	// Materialized nodes are never modified again, they can be read from multiple threads.
+	bool materialize() const;
+
+  private:
+	Type	 _type = Type::null;
+	bool	 _isReal = false;	// Number stored as a float (it had a decimal point or an exponent in the source)
+	bool	 _deferred = false; // Object or array not parsed yet (lazy mode): _size is the index of its opening bracket in the tape
+	bool	 _packed = false;	// Packed array of numbers (_floats if _isReal, _integers otherwise)
+	uint32_t _size = 0;
+	union {
+		const Node*	  _elements = nullptr;
+		const Member* _members;
+		const float*  _floats;
+		const int*	  _integers;
+		const char*	  _string;
+		int			  _integer;
+		float		  _real;
+		bool		  _boolean;
+		Tape*		  _tape; // Deferred nodes
+	};
+
+	inline void resolve() const {
+		if(_deferred)
+			Document::materialize(*this);
+	}
+	const Node& packedGenericAccess() const; // Logs an error and returns a null node
+
+	friend class JSON::Document;
+};
+
+struct JSON::Document::Member {
+	std::string_view key;
+	Node			 value;
+};
+
+inline std::span<const JSON::Document::Member> JSON::Document::Node::asObject() const {
+	assert(_type == Type::object);
+	resolve();
+	return {_members, _size};
+}
+
+inline const JSON::Document::Node& JSON::Document::getRoot() const {
+	static const Node Null;
+	return _root ? *_root : Null;
+}
+inline const JSON::Document::Node& JSON::Document::operator[](std::string_view key) const {
+	return getRoot()[key];
+}
+inline const JSON::Document::Node& JSON::Document::operator[](size_t idx) const {
+	return getRoot()[idx];
+}
+
+template<>
+inline int JSON::Document::Node::as<int>() const {
+	assert(_type == Type::number && !_isReal);
+	return _integer;
+}
+template<>
+inline float JSON::Document::Node::as<float>() const {
+	assert(_type == Type::number && _isReal);
+	return _real;
+}
+template<>
+inline bool JSON::Document::Node::as<bool>() const {
+	assert(_type == Type::boolean);
+	return _boolean;
+}
+template<>
+inline std::string_view JSON::Document::Node::as<std::string_view>() const {
+	return asString();
+}
+template<>
+inline std::string JSON::Document::Node::as<std::string>() const {
+	return std::string{asString()};
+}
+
+template<>
+inline int JSON::Document::Node::to<int>() const {
+	if(_type == Type::string) {
+		int i = 0;
+		std::from_chars(_string, _string + _size, i);
+		return i;
+	}
+	assert(_type == Type::number);
+	return _isReal ? static_cast<int>(_real) : _integer;
+}
+template<>
+inline float JSON::Document::Node::to<float>() const {
+	if(_type == Type::string) {
+		float f = 0;
+		std::from_chars(_string, _string + _size, f);
+		return f;
+	}
+	assert(_type == Type::number);
+	return _isReal ? _real : static_cast<float>(_integer);
+}
+template<>
+inline bool JSON::Document::Node::to<bool>() const {
+	return as<bool>();
+}
+template<>
+inline std::string JSON::Document::Node::to<std::string>() const {
+	return as<std::string>();
+}
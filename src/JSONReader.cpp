@@ -0,0 +1,209 @@
+#include "JSONReader.hpp"
+
+#include <cmath>
+#include <limits>
+
+#include <JSONStructuralIndex.hpp>
+
+JSON::Reader::Reader(std::string_view data) : _begin(data.data()), _cursor{data.data(), data.data() + data.size()} {}
+
+JSON::value::Type JSON::Reader::peek() {
+	if(_error)
+		return value::Type::null;
+	switch(peekChar()) {
+		case '{': return value::Type::object;
+		case '[': return value::Type::array;
+		case '"': return value::Type::string;
+		case 't':
+		case 'f': return value::Type::boolean;
+		case '-':
+		case '0':
+		case '1':
+		case '2':
+		case '3':
+		case '4':
+		case '5':
+		case '6':
+		case '7':
+		case '8':
+		case '9': return value::Type::number;
+		default: return value::Type::null;
+	}
+}
+
+bool JSON::Reader::expectNumber() {
+	if(_error)
+		return false;
+	char byte = peekChar();
+	if(byte != '-' && (byte < '0' || byte > '9')) {
+		error("JSON::Reader error: Expected a number, got '{}' (offset {}).\n", byte, getOffset());
+		return fail();
+	}
+	return true;
+}
+
+bool JSON::Reader::read(int32_t& i) {
+	if(!expectNumber())
+		return false;
+	i = parseNumber(_cursor).toInteger();
+	return true;
+}
+
+bool JSON::Reader::read(uint32_t& i) {
+	if(!expectNumber())
+		return false;
+	// Not through parseNumber: Its integers are signed 32 bits, values above INT_MAX would overflow.
+	uint64_t   u = 0;
+	const auto r = std::from_chars(_cursor.cur, _cursor.end, u);
+	bool	   valid = r.ec == std::errc{};
+	if(valid && r.ptr < _cursor.end && (*r.ptr == '.' || *r.ptr == 'e' || *r.ptr == 'E')) { // Integral values written as reals (e.g. 1.0 or 1e3)
+		double	   d = 0;
+		const auto rd = std::from_chars(_cursor.cur, _cursor.end, d);
+		valid = rd.ec == std::errc{} && d == std::floor(d);
+		u = valid ? static_cast<uint64_t>(d) : 0;
+		_cursor.cur = rd.ptr;
+	} else if(valid)
+		_cursor.cur = r.ptr;
+	if(!valid || u > std::numeric_limits<uint32_t>::max()) {
+		error("JSON::Reader error: Expected an unsigned 32-bit integer (offset {}).\n", getOffset());
+		return fail();
+	}
+	i = static_cast<uint32_t>(u);
+	return true;
+}
+
+bool JSON::Reader::read(float& f) {
+	if(!expectNumber())
+		return false;
+	f = parseNumber(_cursor).toReal();
+	return true;
+}
+
+bool JSON::Reader::read(bool& b) {
+	if(_error)
+		return false;
+	char byte = peekChar();
+	if(byte != 't' && byte != 'f') {
+		error("JSON::Reader error: Expected a boolean, got '{}' (offset {}).\n", byte, getOffset());
+		return fail();
+	}
+	b = parseBoolean(_cursor);
+	return true;
+}
+
+bool JSON::Reader::read(std::string& str) {
+	if(_error || !expect('"', _cursor))
+		return fail();
+	str = parseString(_cursor);
+	return true;
+}
+
+bool JSON::Reader::read(float* values, size_t count) {
+	size_t i = 0;
+	if(!readArray([&]() { return i < count && read(values[i++]); }))
+		return false;
+	if(i != count) {
+		error("JSON::Reader error: Expected an array of {} numbers, got {} (offset {}).\n", count, i, getOffset());
+		return fail();
+	}
+	return true;
+}
+
+std::string_view JSON::Reader::readKey() {
+	// We assume the leading '"' has already been consumed.
+	std::string_view key;
+	const char*		 stop = findQuoteOrBackslash(_cursor.cur, _cursor.end);
+	if(stop < _cursor.end && *stop == '"') {
+		key = {_cursor.cur, stop};
+		_cursor.cur = stop + 1;
+	} else {
+		_key = parseString(_cursor);
+		key = _key;
+	}
+	if(!expect(':', _cursor))
+		fail();
+	return key;
+}
+
+bool JSON::Reader::skipString() {
+	// We assume the leading '"' has already been consumed.
+	while(true) {
+		const char* stop = findQuoteOrBackslash(_cursor.cur, _cursor.end);
+		if(stop >= _cursor.end) {
+			error("JSON::Reader error: Unterminated string.\n");
+			_cursor.cur = _cursor.end;
+			return fail();
+		}
+		_cursor.cur = stop + 1;
+		if(*stop == '"')
+			return true;
+		if(_cursor.cur >= _cursor.end) { // Input ending with a backslash
+			error("JSON::Reader error: Unterminated string.\n");
+			return fail();
+		}
+		++_cursor.cur; // Skip the escaped character
+	}
+}
+
+bool JSON::Reader::skip() {
+	if(_error)
+		return false;
+	char byte = skipWhitespace(_cursor);
+	switch(byte) {
+		case '"': return skipString();
+		case '{':
+		case '[': {
+			size_t depth = 1;
+			while(depth > 0 && _cursor.cur < _cursor.end) {
+				switch(*_cursor.cur++) {
+					case '"':
+						if(!skipString())
+							return false;
+						break;
+					case '{':
+					case '[': ++depth; break;
+					case '}':
+					case ']': --depth; break;
+				}
+			}
+			if(depth > 0) {
+				error("JSON::Reader::skip error: Unexpected end of input.\n");
+				return fail();
+			}
+			return true;
+		}
+		case 't':
+		case 'f':
+			--_cursor.cur;
+			parseBoolean(_cursor);
+			return true;
+		case 'n':
+			--_cursor.cur;
+			parseNull(_cursor);
+			return true;
+		case '-':
+		case '0':
+		case '1':
+		case '2':
+		case '3':
+		case '4':
+		case '5':
+		case '6':
+		case '7':
+		case '8':
+		case '9':
+			--_cursor.cur;
+			parseNumber(_cursor);
+			return true;
+	}
+	error("JSON::Reader::skip error: Unexpected character '{}' (offset {}).\n", byte, getOffset());
+	return fail();
+}
+
+std::string_view JSON::Reader::readRaw() {
+	peekChar();
+	const char* begin = _cursor.cur;
+	if(!skip())
+		return {};
+	return {begin, _cursor.cur};
+}
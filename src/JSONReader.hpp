@@ -0,0 +1,117 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include <JSON.hpp>
+#include <Logger.hpp>
+
+// Pull parser: Reads a document value by value directly from the source buffer, without building any tree.
+// Containers are walked with readObject/readArray, which call back for each member/element. The callback must consume exactly one value
+// (using one of the read functions, readRaw or skip) and return false to abort. Errors are logged and sticky (see hasError).
+// Use it to extract a known schema from large documents (see glTF.hpp), JSON or JSON::Document are simpler for everything else.
+class JSON::Reader {
+  public:
+	// The reader references data: It must outlive the reader (and any string_view returned by it).
+	Reader(std::string_view data);
+
+	// Type of the next value, without consuming it. Returns Type::null on error or at the end of the input.
+	value::Type peek();
+
+	// bool onMember(std::string_view key). The key is only valid until the value is consumed.
+	template<typename Func>
+	bool readObject(Func&& onMember);
+	// bool onElement()
+	template<typename Func>
+	bool readArray(Func&& onElement);
+
+	bool read(int32_t&);
+	bool read(uint32_t&);
+	bool read(float&);
+	bool read(bool&);
+	bool read(std::string&);
+	// Reads an array of values of the same type.
+	template<typename T>
+	bool read(std::vector<T>&);
+	// Reads an array of exactly count numbers.
+	bool read(float* values, size_t count);
+
+	// Skips the next value (containers are only scanned for matching brackets, not validated).
+	bool skip();
+	// Skips the next value and returns its source text, or an empty string_view on error.
+	std::string_view readRaw();
+
+	inline bool	  hasError() const { return _error; }
+	inline size_t getOffset() const { return static_cast<size_t>(_cursor.cur - _begin); }
+
+  private:
+	const char* _begin;
+	Cursor		_cursor;
+	bool		_error = false;
+	std::string _key; // Decoded key, only used when a key has escape sequences.
+
+	inline char peekChar() {
+		char byte = skipWhitespace(_cursor);
+		if(byte != '\0')
+			--_cursor.cur;
+		return byte;
+	}
+	inline bool fail() {
+		_error = true;
+		return false;
+	}
+	bool			 expectNumber();
+	bool			 skipString();
+	std::string_view readKey();
+};
+
+template<typename Func>
+bool JSON::Reader::readObject(Func&& onMember) {
+	if(_error || !expect('{', _cursor))
+		return fail();
+	if(peekChar() == '}') {
+		++_cursor.cur;
+		return true;
+	}
+	while(true) {
+		if(!expect('"', _cursor))
+			return fail();
+		const auto key = readKey();
+		if(_error || !onMember(key))
+			return fail();
+		char byte = skipWhitespace(_cursor);
+		if(byte == '}')
+			return true;
+		if(byte != ',') {
+			error("JSON::Reader::readObject error: Expected ',' or '}}', got '{}' (offset {}).\n", byte, getOffset());
+			return fail();
+		}
+	}
+}
+
+template<typename Func>
+bool JSON::Reader::readArray(Func&& onElement) {
+	if(_error || !expect('[', _cursor))
+		return fail();
+	if(peekChar() == ']') {
+		++_cursor.cur;
+		return true;
+	}
+	while(true) {
+		if(!onElement())
+			return fail();
+		char byte = skipWhitespace(_cursor);
+		if(byte == ']')
+			return true;
+		if(byte != ',') {
+			error("JSON::Reader::readArray error: Expected ',' or ']', got '{}' (offset {}).\n", byte, getOffset());
+			return fail();
+		}
+	}
+}
+
+template<typename T>
+bool JSON::Reader::read(std::vector<T>& values) {
+	values.clear();
+	return readArray([&]() { return read(values.emplace_back()); });
+}
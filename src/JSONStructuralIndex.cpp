@@ -0,0 +1,195 @@
+#include "JSONStructuralIndex.hpp"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
+
+#if defined(JSON_SIMD_AVX2)
+	#include <immintrin.h>
+#elif defined(JSON_SIMD_SSE2)
+	#include <emmintrin.h>
+#endif
+
+namespace {
+
+struct BlockMasks {
+	uint64_t quote = 0;
+	uint64_t backslash = 0;
+	uint64_t structural = 0;
+};
+
+enum CharacterClass : uint8_t {
+	Other = 0,
+	Quote = 1,
+	Backslash = 2,
+	Structural = 4,
+};
+
+constexpr std::array<uint8_t, 256> CharacterClasses = []() {
+	std::array<uint8_t, 256> table{};
+	table['"'] = Quote;
+	table['\\'] = Backslash;
+	for(auto c : {'{', '}', '[', ']', ':', ','})
+		table[static_cast<uint8_t>(c)] = Structural;
+	return table;
+}();
+
+BlockMasks classifyScalar(const char* block) {
+	BlockMasks m;
+	for(uint64_t i = 0; i < 64; ++i) {
+		const auto c = CharacterClasses[static_cast<uint8_t>(block[i])];
+		m.quote |= static_cast<uint64_t>(c & Quote) << i;
+		m.backslash |= static_cast<uint64_t>((c & Backslash) >> 1) << i;
+		m.structural |= static_cast<uint64_t>((c & Structural) >> 2) << i;
+	}
+	return m;
+}
+
+#if defined(JSON_SIMD_SSE2)
+BlockMasks classifySSE2(const char* block) {
+	BlockMasks	  m;
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i lowercase = _mm_set1_epi8(0x20);
+	const __m128i openBrace = _mm_set1_epi8('{'); // '[' | 0x20 == '{'
+	const __m128i closeBrace = _mm_set1_epi8('}'); // ']' | 0x20 == '}'
+	const __m128i colon = _mm_set1_epi8(':');
+	const __m128i comma = _mm_set1_epi8(',');
+	for(int i = 0; i < 4; ++i) {
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+		const __m128i folded = _mm_or_si128(v, lowercase);
+		const __m128i structural = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, openBrace), _mm_cmpeq_epi8(folded, closeBrace)),
+												_mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma)));
+		m.quote |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)))) << (16 * i);
+		m.backslash |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, backslash)))) << (16 * i);
+		m.structural |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(structural))) << (16 * i);
+	}
+	return m;
+}
+#endif
+
+#if defined(JSON_SIMD_AVX2)
+BlockMasks classifyAVX2(const char* block) {
+	BlockMasks	  m;
+	const __m256i quote = _mm256_set1_epi8('"');
+	const __m256i backslash = _mm256_set1_epi8('\\');
+	const __m256i lowercase = _mm256_set1_epi8(0x20);
+	const __m256i openBrace = _mm256_set1_epi8('{');
+	const __m256i closeBrace = _mm256_set1_epi8('}');
+	const __m256i colon = _mm256_set1_epi8(':');
+	const __m256i comma = _mm256_set1_epi8(',');
+	for(int i = 0; i < 2; ++i) {
+		const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32 * i));
+		const __m256i folded = _mm256_or_si256(v, lowercase);
+		const __m256i structural = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(folded, openBrace), _mm256_cmpeq_epi8(folded, closeBrace)),
+												   _mm256_or_si256(_mm256_cmpeq_epi8(v, colon), _mm256_cmpeq_epi8(v, comma)));
+		m.quote |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)))) << (32 * i);
+		m.backslash |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, backslash)))) << (32 * i);
+		m.structural |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(structural))) << (32 * i);
+	}
+	return m;
+}
+#endif
+
+// Returns the mask of characters escaped by a backslash. prevEscaped carries the escape state of the first character of the next block.
+// Each backslash sequence escapes the character following it if its length is odd, which is computed without branches by adding
+// the start of each sequence to the sequence itself and looking at where the carry lands (see simdjson).
+uint64_t findEscaped(uint64_t backslash, uint64_t& prevEscaped) {
+	if(backslash == 0) {
+		const auto escaped = prevEscaped;
+		prevEscaped = 0;
+		return escaped;
+	}
+	backslash &= ~prevEscaped; // An escaped backslash does not escape anything
+	const uint64_t followsEscape = backslash << 1 | prevEscaped;
+	constexpr uint64_t EvenBits = 0x5555555555555555ULL;
+	const uint64_t oddSequenceStarts = backslash & ~EvenBits & ~followsEscape;
+	const uint64_t sequencesStartingOnEvenBits = oddSequenceStarts + backslash;
+	prevEscaped = sequencesStartingOnEvenBits < oddSequenceStarts ? 1 : 0; // Carry out of the block
+	const uint64_t invertMask = sequencesStartingOnEvenBits << 1;
+	return (EvenBits ^ invertMask) & followsEscape;
+}
+
+// Bit i of the result is the XOR of bits [0, i] of the input: Set for characters between an opening quote (included) and its closing quote (excluded).
+uint64_t prefixXor(uint64_t bits) {
+	bits ^= bits << 1;
+	bits ^= bits << 2;
+	bits ^= bits << 4;
+	bits ^= bits << 8;
+	bits ^= bits << 16;
+	bits ^= bits << 32;
+	return bits;
+}
+
+} // namespace
+
+bool JSONStructuralIndex::build(std::string_view data, Implementation impl) {
+	_positions.clear();
+	if(data.size() > std::numeric_limits<uint32_t>::max())
+		return false;
+	_positions.reserve(data.size() / 8);
+
+	uint64_t prevEscaped = 0;
+	uint64_t prevInString = 0;
+	char	 padded[64];
+	for(size_t offset = 0; offset < data.size(); offset += 64) {
+		const char* block = data.data() + offset;
+		if(data.size() - offset < 64) {
+			std::memset(padded, ' ', sizeof(padded));
+			std::memcpy(padded, block, data.size() - offset);
+			block = padded;
+		}
+
+		BlockMasks m;
+		switch(impl) {
+#if defined(JSON_SIMD_AVX2)
+			case Implementation::AVX2: m = classifyAVX2(block); break;
+#endif
+#if defined(JSON_SIMD_SSE2)
+			case Implementation::SSE2: m = classifySSE2(block); break;
+#endif
+			default: m = classifyScalar(block); break;
+		}
+
+		const uint64_t quotes = m.quote & ~findEscaped(m.backslash, prevEscaped);
+		const uint64_t inString = prefixXor(quotes) ^ prevInString;
+		prevInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+
+		uint64_t structurals = (m.structural & ~inString) | quotes;
+		while(structurals != 0) {
+			_positions.push_back(static_cast<uint32_t>(offset + std::countr_zero(structurals)));
+			structurals &= structurals - 1;
+		}
+	}
+	// Still in a string at the end of the input: Unterminated string.
+	return prevInString == 0;
+}
+
+const char* findQuoteOrBackslash(const char* begin, const char* end) {
+#if defined(JSON_SIMD_AVX2)
+	const __m256i quote = _mm256_set1_epi8('"');
+	const __m256i backslash = _mm256_set1_epi8('\\');
+	for(; end - begin >= 32; begin += 32) {
+		const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+		const auto	  mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash))));
+		if(mask != 0)
+			return begin + std::countr_zero(mask);
+	}
+#endif
+#if defined(JSON_SIMD_SSE2)
+	{
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i backslash = _mm_set1_epi8('\\');
+		for(; end - begin >= 16; begin += 16) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+			const auto	  mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash))));
+			if(mask != 0)
+				return begin + std::countr_zero(mask);
+		}
+	}
+#endif
+	while(begin < end && *begin != '"' && *begin != '\\')
+		++begin;
+	return begin;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#if defined(__AVX2__)
+	#define JSON_SIMD_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define JSON_SIMD_SSE2
+#endif
+
+// First stage of the indexed JSON parser.
+// Classifies the whole input 64 bytes at a time and records the offset of every structural character ('{', '}', '[', ']', ':', ',') outside of strings,
+// and of every unescaped quote (so each string is described by two consecutive entries: its opening and its closing quote).
+// Scalars (numbers, true, false, null) are not indexed: they always directly follow a structural character.
+class JSONStructuralIndex {
+  public:
+	enum class Implementation {
+		Scalar,
+		SSE2,
+		AVX2,
+	};
+
+	// Best implementation available in this build.
+	static constexpr Implementation BestImplementation =
+#if defined(JSON_SIMD_AVX2)
+		Implementation::AVX2;
+#elif defined(JSON_SIMD_SSE2)
+		Implementation::SSE2;
+#else
+		Implementation::Scalar;
+#endif
+
+	// Returns false if the input is malformed (unterminated string) or too large to be indexed with 32bit offsets.
+	bool build(std::string_view data, Implementation impl = BestImplementation);
+
+	inline const std::vector<uint32_t>& getPositions() const { return _positions; }
+
+  private:
+	std::vector<uint32_t> _positions;
+};
+
+// Returns a pointer to the first '"' or '\' in [begin, end), or end if there is none.
+const char* findQuoteOrBackslash(const char* begin, const char* end);
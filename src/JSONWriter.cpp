@@ -0,0 +1,198 @@
+#include "JSONWriter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+
+JSON::Writer::Writer(std::ostream& os) : _stream(&os) {}
+
+JSON::Writer::~Writer() {
+	flush();
+}
+
+void JSON::Writer::flush() {
+	if(!_stream)
+		return;
+	_stream->write(_buffer.data(), _buffer.size());
+	_buffer.clear();
+}
+
+JSON::Writer& JSON::Writer::beginObject() {
+	separator();
+	_buffer += '{';
+	_needComma = false;
+	return *this;
+}
+
+JSON::Writer& JSON::Writer::endObject() {
+	_buffer += '}';
+	valueWritten();
+	return *this;
+}
+
+JSON::Writer& JSON::Writer::beginArray() {
+	separator();
+	_buffer += '[';
+	_needComma = false;
+	return *this;
+}
+
+JSON::Writer& JSON::Writer::endArray() {
+	_buffer += ']';
+	valueWritten();
+	return *this;
+}
+
+JSON::Writer& JSON::Writer::key(std::string_view k) {
+	separator();
+	writeEscaped(k);
+	_buffer += ':';
+	_needComma = false;
+	return *this;
+}
+
+JSON::Writer& JSON::Writer::write(std::string_view str) {
+	separator();
+	writeEscaped(str);
+	valueWritten();
+	return *this;
+}
+
+template<typename T>
+void JSON::Writer::writeNumber(T n) {
+	std::array<char, 32> buffer;
+	auto				 r = std::to_chars(buffer.data(), buffer.data() + buffer.size(), n);
+	_buffer.append(buffer.data(), r.ptr);
+}
+
+JSON::Writer& JSON::Writer::write(int i) {
+	separator();
+	writeNumber(i);
+	valueWritten();
+	return *this;
+}
+
+JSON::Writer& JSON::Writer::write(uint32_t i) {
+	separator();
+	writeNumber(i);
+	valueWritten();
+	return *this;
+}
+
+JSON::Writer& JSON::Writer::write(size_t i) {
+	separator();
+	writeNumber(i);
+	valueWritten();
+	return *this;
+}
+
+JSON::Writer& JSON::Writer::write(float f) {
+	separator();
+	if(!std::isfinite(f)) {
+		_buffer += "null"; // Not representable in JSON
+	} else {
+		std::array<char, 32> buffer;
+		auto				 r = std::to_chars(buffer.data(), buffer.data() + buffer.size(), f);
+		_buffer.append(buffer.data(), r.ptr);
+		// Keep integral floats as reals when reading them back (to_chars writes 1.0f as "1").
+		if(std::find_if(buffer.data(), r.ptr, [](char c) { return c == '.' || c == 'e'; }) == r.ptr)
+			_buffer += ".0";
+	}
+	valueWritten();
+	return *this;
+}
+
+JSON::Writer& JSON::Writer::write(bool b) {
+	separator();
+	_buffer += b ? "true" : "false";
+	valueWritten();
+	return *this;
+}
+
+JSON::Writer& JSON::Writer::write(null_t) {
+	separator();
+	_buffer += "null";
+	valueWritten();
+	return *this;
+}
+
+JSON::Writer& JSON::Writer::write(std::span<const float> values) {
+	beginArray();
+	for(const auto& f : values)
+		write(f);
+	return endArray();
+}
+
+JSON::Writer& JSON::Writer::write(std::span<const int> values) {
+	beginArray();
+	for(const auto& i : values)
+		write(i);
+	return endArray();
+}
+
+JSON::Writer& JSON::Writer::write(const number& n) {
+	if(n.isReal())
+		return write(n.asReal());
+	return write(n.asInteger());
+}
+
+JSON::Writer& JSON::Writer::write(const array& a) {
+	beginArray();
+	for(const auto& v : a)
+		write(v);
+	return endArray();
+}
+
+JSON::Writer& JSON::Writer::write(const object& o) {
+	beginObject();
+	for(const auto& [k, v] : o)
+		key(k).write(v);
+	return endObject();
+}
+
+JSON::Writer& JSON::Writer::write(const value& v) {
+	switch(v.getType()) {
+		case value::Type::string: return write(v.asString());
+		case value::Type::number: return write(v.asNumber());
+		case value::Type::array:
+			if(v.isPackedFloats())
+				return write(v.asFloats());
+			if(v.isPackedIntegers())
+				return write(v.asIntegers());
+			return write(v.asArray());
+		case value::Type::object: return write(v.asObject());
+		case value::Type::boolean: return write(v.asBoolean());
+		default: return write(null_t{});
+	}
+}
+
+void JSON::Writer::writeEscaped(std::string_view str) {
+	static constexpr char Hex[] = "0123456789abcdef";
+	_buffer += '"';
+	size_t runStart = 0;
+	for(size_t i = 0; i < str.size(); ++i) {
+		const auto c = static_cast<unsigned char>(str[i]);
+		if(c >= 0x20 && c != '"' && c != '\\')
+			continue;
+		_buffer.append(str.data() + runStart, i - runStart);
+		runStart = i + 1;
+		_buffer += '\\';
+		switch(c) {
+			case '"': _buffer += '"'; break;
+			case '\\': _buffer += '\\'; break;
+			case '\n': _buffer += 'n'; break;
+			case '\r': _buffer += 'r'; break;
+			case '\t': _buffer += 't'; break;
+			case '\b': _buffer += 'b'; break;
+			case '\f': _buffer += 'f'; break;
+			default:
+				_buffer += "u00";
+				_buffer += Hex[c >> 4];
+				_buffer += Hex[c & 0xF];
+				break;
+		}
+	}
+	_buffer.append(str.data() + runStart, str.size() - runStart);
+	_buffer += '"';
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include <JSON.hpp>
+
+// Streaming serializer: Appends compact JSON directly to a growable buffer, without building any tree.
+// When constructed with a stream, the buffer is flushed to it whenever it grows past FlushThreshold, and on flush() / destruction.
+// Numbers use std::to_chars (shortest representation that round-trips), strings are escaped in a single pass.
+// Commas are handled automatically: Just call key() before each member value.
+class JSON::Writer {
+  public:
+	Writer() = default;
+	Writer(std::ostream& os);
+	Writer(const Writer&) = delete;
+	Writer& operator=(const Writer&) = delete;
+	~Writer();
+
+	Writer& beginObject();
+	Writer& endObject();
+	Writer& beginArray();
+	Writer& endArray();
+	Writer& key(std::string_view);
+
+	Writer& write(std::string_view);
+	Writer& write(const char* str) { return write(std::string_view{str}); }
+	Writer& write(const std::string& str) { return write(std::string_view{str}); }
+	Writer& write(int);
+	Writer& write(uint32_t);
+	Writer& write(size_t);
+	Writer& write(float);
+	Writer& write(bool);
+	Writer& write(null_t);
+	Writer& write(std::span<const float>); // Array of numbers
+	Writer& write(std::span<const int>);
+	Writer& write(const number&);
+	Writer& write(const array&);
+	Writer& write(const object&);
+	Writer& write(const value&);
+
+	// Shorthand for key(k).write(v)
+	template<typename T>
+	Writer& write(std::string_view k, const T& v) {
+		return key(k).write(v);
+	}
+
+	// Content not yet flushed to the stream (everything when no stream is used).
+	inline std::string_view getBuffer() const { return _buffer; }
+	void					flush();
+
+  private:
+	static constexpr size_t FlushThreshold = 64 * 1024;
+
+	std::string	  _buffer;
+	std::ostream* _stream = nullptr;
+	bool		  _needComma = false;
+
+	inline void separator() {
+		if(_needComma)
+			_buffer += ',';
+	}
+	inline void valueWritten() {
+		_needComma = true;
+		if(_stream && _buffer.size() > FlushThreshold)
+			flush();
+	}
+	void writeEscaped(std::string_view);
+	template<typename T>
+	void writeNumber(T);
+};
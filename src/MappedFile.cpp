@@ -0,0 +1,152 @@
+#include "MappedFile.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#include <Logger.hpp>
+
+MappedFile::MappedFile(const std::filesystem::path& path, Access access) {
+	open(path, access);
+}
+
+MappedFile::MappedFile(MappedFile&& o) noexcept {
+	*this = std::move(o);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& o) noexcept {
+	if(this != &o) {
+		close();
+		_data = std::exchange(o._data, nullptr);
+		_size = std::exchange(o._size, 0);
+		_opened = std::exchange(o._opened, false);
+#if defined(_WIN32)
+		_file = std::exchange(o._file, nullptr);
+		_mapping = std::exchange(o._mapping, nullptr);
+#else
+		_file = std::exchange(o._file, -1);
+#endif
+	}
+	return *this;
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::open(const std::filesystem::path& path, Access access) {
+	close();
+	const DWORD flags = access == Access::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : (access == Access::Random ? FILE_FLAG_RANDOM_ACCESS : FILE_ATTRIBUTE_NORMAL);
+	HANDLE		file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+	if(file == INVALID_HANDLE_VALUE) {
+		error("MappedFile: Could not open '{}'.\n", path.string());
+		return false;
+	}
+	_file = file;
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(file, &size)) {
+		error("MappedFile: Could not get the size of '{}'.\n", path.string());
+		close();
+		return false;
+	}
+	_size = static_cast<size_t>(size.QuadPart);
+	_opened = true;
+	if(_size == 0)
+		return true;
+	_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(_mapping)
+		_data = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+	if(!_data) {
+		error("MappedFile: Could not map '{}' (error {}).\n", path.string(), GetLastError());
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close() {
+	if(_data)
+		UnmapViewOfFile(_data);
+	if(_mapping)
+		CloseHandle(_mapping);
+	if(_file)
+		CloseHandle(_file);
+	_data = nullptr;
+	_mapping = nullptr;
+	_file = nullptr;
+	_size = 0;
+	_opened = false;
+}
+
+void MappedFile::willNeed(size_t offset, size_t size) const {
+	if(!_data || offset >= _size)
+		return;
+	WIN32_MEMORY_RANGE_ENTRY range{const_cast<char*>(_data) + offset, std::min(size, _size - offset)};
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#else
+
+bool MappedFile::open(const std::filesystem::path& path, Access access) {
+	close();
+	_file = ::open(path.c_str(), O_RDONLY);
+	if(_file < 0) {
+		error("MappedFile: Could not open '{}'.\n", path.string());
+		return false;
+	}
+	struct stat st;
+	if(fstat(_file, &st) != 0) {
+		error("MappedFile: Could not get the size of '{}'.\n", path.string());
+		close();
+		return false;
+	}
+	_size = static_cast<size_t>(st.st_size);
+	_opened = true;
+	if(_size == 0)
+		return true;
+	void* ptr = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _file, 0);
+	if(ptr == MAP_FAILED) {
+		error("MappedFile: Could not map '{}'.\n", path.string());
+		close();
+		return false;
+	}
+	_data = static_cast<const char*>(ptr);
+	const int advice = access == Access::Sequential ? MADV_SEQUENTIAL : (access == Access::Random ? MADV_RANDOM : MADV_NORMAL);
+	madvise(ptr, _size, advice);
+	return true;
+}
+
+void MappedFile::close() {
+	if(_data)
+		munmap(const_cast<char*>(_data), _size);
+	if(_file >= 0)
+		::close(_file);
+	_data = nullptr;
+	_file = -1;
+	_size = 0;
+	_opened = false;
+}
+
+void MappedFile::willNeed(size_t offset, size_t size) const {
+	if(!_data || offset >= _size)
+		return;
+	// madvise requires a page aligned address.
+	const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	const size_t begin = offset / pageSize * pageSize;
+	const size_t end = std::min(offset + size, _size);
+	madvise(const_cast<char*>(_data) + begin, end - begin, MADV_WILLNEED);
+}
+
+#endif
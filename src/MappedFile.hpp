@@ -0,0 +1,48 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+// Read-only memory mapping of a whole file: Its content is paged in on demand by the OS instead of being copied to the heap, and can be evicted
+// under memory pressure. Spans/views into the mapping are valid as long as the MappedFile is alive (and not moved-from).
+class MappedFile {
+  public:
+	// Expected access pattern, forwarded to the OS (madvise on POSIX systems).
+	enum class Access {
+		Normal,
+		Sequential, // Read front to back (e.g. parsing): aggressive read-ahead
+		Random,		// Scattered accesses: no read-ahead
+	};
+
+	MappedFile() = default;
+	MappedFile(const std::filesystem::path&, Access = Access::Normal);
+	MappedFile(const MappedFile&) = delete;
+	MappedFile(MappedFile&&) noexcept;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile& operator=(MappedFile&&) noexcept;
+	~MappedFile();
+
+	bool open(const std::filesystem::path&, Access = Access::Normal);
+	void close();
+	// Hints that [offset, offset + size) will be needed soon (e.g. a buffer about to be read), pages are read asynchronously ahead of time.
+	void willNeed(size_t offset, size_t size) const;
+
+	inline bool					 isOpen() const { return _opened; }
+	inline explicit				 operator bool() const { return _opened; }
+	inline const char*			 data() const { return _data; }
+	inline size_t				 size() const { return _size; }
+	inline std::span<const char> span() const { return {_data, _size}; }
+	inline std::string_view		 view() const { return {_data, _size}; }
+
+  private:
+	const char* _data = nullptr;
+	size_t		_size = 0;
+	bool		_opened = false; // Empty files can be opened but not mapped (_data stays nullptr)
+#if defined(_WIN32)
+	void* _file = nullptr;
+	void* _mapping = nullptr;
+#else
+	int _file = -1;
+#endif
+};
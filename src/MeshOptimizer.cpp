@@ -0,0 +1,319 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include <Mesh.hpp>
+
+namespace MeshOptimizer {
+
+namespace {
+
+// Simulates a FIFO cache of cacheSize entries using timestamps: A vertex is in the cache if it was inserted less than cacheSize misses ago.
+// Advancing the time by cacheSize + 1 flushes the cache.
+class FIFOCache {
+  public:
+	FIFOCache(size_t vertexCount, uint32_t cacheSize) : _timestamps(vertexCount, 0), _cacheSize(cacheSize), _time(cacheSize + 1) {}
+
+	inline uint32_t access(uint32_t vertex) {
+		if(_time - _timestamps[vertex] > _cacheSize) {
+			_timestamps[vertex] = _time++;
+			return 1;
+		}
+		return 0;
+	}
+	inline uint32_t access(const uint32_t* triangle) { return access(triangle[0]) + access(triangle[1]) + access(triangle[2]); }
+	inline void		flush() { _time += _cacheSize + 1; }
+
+  private:
+	std::vector<uint32_t> _timestamps;
+	uint32_t			  _cacheSize;
+	uint32_t			  _time;
+};
+
+// Forsyth's scoring, modeling a LRU cache of ForsythCacheSize entries.
+constexpr uint32_t ForsythCacheSize = 32;
+constexpr uint32_t MaxTabulatedValence = 32;
+
+struct ForsythScores {
+	std::array<float, ForsythCacheSize>		   cache;
+	std::array<float, MaxTabulatedValence + 1> valence;
+
+	ForsythScores() {
+		for(uint32_t i = 0; i < ForsythCacheSize; ++i)
+			// The 3 most recent vertices were used by the last triangle: Using them again would only produce a degenerate triangle, or a strip-like order.
+			cache[i] = i < 3 ? 0.75f : std::pow(1.0f - static_cast<float>(i - 3) / (ForsythCacheSize - 3), 1.5f);
+		valence[0] = 0.0f;
+		for(uint32_t i = 1; i <= MaxTabulatedValence; ++i)
+			valence[i] = 2.0f / std::sqrt(static_cast<float>(i));
+	}
+
+	// Boosts vertices with few remaining triangles, to get rid of lone triangles early.
+	inline float operator()(int32_t cachePosition, uint32_t remainingTriangles) const {
+		if(remainingTriangles == 0)
+			return -1.0f;
+		const float valenceScore = remainingTriangles <= MaxTabulatedValence ? valence[remainingTriangles] : 2.0f / std::sqrt(static_cast<float>(remainingTriangles));
+		return (cachePosition >= 0 ? cache[cachePosition] : 0.0f) + valenceScore;
+	}
+};
+
+} // namespace
+
+Statistics analyze(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize) {
+	Statistics stats;
+	stats.triangles = indexCount / 3;
+	if(stats.triangles == 0)
+		return stats;
+	FIFOCache		  cache(vertexCount, cacheSize);
+	std::vector<bool> referenced(vertexCount, false);
+	for(size_t i = 0; i < indexCount; ++i) {
+		assert(indices[i] < vertexCount);
+		stats.cacheMisses += cache.access(indices[i]);
+		if(!referenced[indices[i]]) {
+			referenced[indices[i]] = true;
+			++stats.vertices;
+		}
+	}
+	stats.acmr = static_cast<float>(stats.cacheMisses) / stats.triangles;
+	stats.atvr = static_cast<float>(stats.cacheMisses) / stats.vertices;
+	return stats;
+}
+
+void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount) {
+	const size_t triangleCount = indexCount / 3;
+	if(triangleCount < 2)
+		return;
+	static const ForsythScores score;
+
+	// Triangles adjacent to each vertex. The first remainingTriangles[v] entries of a vertex's range are the ones not emitted yet.
+	std::vector<uint32_t> remainingTriangles(vertexCount, 0);
+	for(size_t i = 0; i < indexCount; ++i)
+		++remainingTriangles[indices[i]];
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	std::inclusive_scan(remainingTriangles.begin(), remainingTriangles.end(), adjacencyOffsets.begin() + 1);
+	std::vector<uint32_t> adjacency(indexCount);
+	{
+		std::vector<uint32_t> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for(size_t i = 0; i < indexCount; ++i)
+			adjacency[cursors[indices[i]]++] = static_cast<uint32_t>(i / 3);
+	}
+
+	std::vector<int32_t> cachePositions(vertexCount, -1);
+	std::vector<float>	 vertexScores(vertexCount);
+	for(size_t v = 0; v < vertexCount; ++v)
+		vertexScores[v] = score(-1, remainingTriangles[v]);
+
+	std::vector<float> triangleScores(triangleCount);
+	std::vector<bool>  emitted(triangleCount, false);
+	uint32_t		   bestTriangle = 0;
+	for(size_t t = 0; t < triangleCount; ++t) {
+		triangleScores[t] = vertexScores[indices[3 * t + 0]] + vertexScores[indices[3 * t + 1]] + vertexScores[indices[3 * t + 2]];
+		if(triangleScores[t] > triangleScores[bestTriangle])
+			bestTriangle = static_cast<uint32_t>(t);
+	}
+
+	std::vector<uint32_t> result(indexCount);
+	// The cache can temporarily hold 3 more vertices: The ones evicted by the last triangle, which scores have to be updated.
+	std::array<uint32_t, ForsythCacheSize + 3> cache, newCache;
+	uint32_t								   cacheCount = 0;
+	size_t									   nextCandidate = 0; // Fallback when no triangle adjacent to the cache is left.
+
+	for(size_t out = 0; out < triangleCount; ++out) {
+		if(bestTriangle == ~0u) {
+			while(emitted[nextCandidate])
+				++nextCandidate;
+			bestTriangle = static_cast<uint32_t>(nextCandidate);
+		}
+		const uint32_t* triangle = indices + 3 * bestTriangle;
+		std::copy(triangle, triangle + 3, result.data() + 3 * out);
+		emitted[bestTriangle] = true;
+
+		// Remove the triangle from the adjacency of its vertices.
+		for(uint32_t k = 0; k < 3; ++k) {
+			const uint32_t v = triangle[k];
+			auto		   begin = adjacency.begin() + adjacencyOffsets[v];
+			auto		   end = begin + remainingTriangles[v];
+			auto		   it = std::find(begin, end, bestTriangle);
+			assert(it != end);
+			std::iter_swap(it, end - 1);
+			--remainingTriangles[v];
+		}
+
+		// LRU: The vertices of the emitted triangle move to the front.
+		uint32_t newCacheCount = 0;
+		for(uint32_t k = 0; k < 3; ++k)
+			newCache[newCacheCount++] = triangle[k];
+		for(uint32_t i = 0; i < cacheCount; ++i) {
+			const uint32_t v = cache[i];
+			if(v != triangle[0] && v != triangle[1] && v != triangle[2])
+				newCache[newCacheCount++] = v;
+		}
+
+		for(uint32_t i = 0; i < newCacheCount; ++i) {
+			const uint32_t v = newCache[i];
+			cachePositions[v] = i < ForsythCacheSize ? static_cast<int32_t>(i) : -1;
+			vertexScores[v] = score(cachePositions[v], remainingTriangles[v]);
+		}
+
+		// Only the triangles adjacent to the vertices which moved in the cache changed score: The next one is chosen among them.
+		bestTriangle = ~0u;
+		float bestScore = -1.0f;
+		for(uint32_t i = 0; i < newCacheCount; ++i) {
+			const uint32_t v = newCache[i];
+			for(uint32_t a = adjacencyOffsets[v]; a < adjacencyOffsets[v] + remainingTriangles[v]; ++a) {
+				const uint32_t t = adjacency[a];
+				const float	   s = vertexScores[indices[3 * t + 0]] + vertexScores[indices[3 * t + 1]] + vertexScores[indices[3 * t + 2]];
+				triangleScores[t] = s;
+				if(s > bestScore) {
+					bestScore = s;
+					bestTriangle = t;
+				}
+			}
+		}
+
+		cacheCount = std::min(newCacheCount, ForsythCacheSize);
+		std::copy(newCache.begin(), newCache.begin() + cacheCount, cache.begin());
+	}
+
+	std::copy(result.begin(), result.end(), indices);
+}
+
+void optimizeOverdraw(uint32_t* indices, size_t indexCount, const Vertex* vertices, size_t vertexCount, float threshold) {
+	const size_t triangleCount = indexCount / 3;
+	if(triangleCount < 2)
+		return;
+
+	// Hard boundaries: Triangles missing the cache on all of their vertices, the order can be changed there without any penalty.
+	FIFOCache			  cache(vertexCount, CacheSize);
+	std::vector<uint32_t> hardBoundaries;
+	for(size_t t = 0; t < triangleCount; ++t)
+		if(cache.access(indices + 3 * t) == 3)
+			hardBoundaries.push_back(static_cast<uint32_t>(t));
+	hardBoundaries.push_back(static_cast<uint32_t>(triangleCount));
+	if(hardBoundaries.front() != 0)
+		hardBoundaries.insert(hardBoundaries.begin(), 0);
+
+	// Soft boundaries: Each hard cluster is split as soon as its ACMR (with a cold cache) is within threshold of the whole cluster's.
+	std::vector<uint32_t> clusters;
+	for(size_t c = 0; c + 1 < hardBoundaries.size(); ++c) {
+		const uint32_t start = hardBoundaries[c];
+		const uint32_t end = hardBoundaries[c + 1];
+		cache.flush();
+		uint32_t clusterMisses = 0;
+		for(uint32_t t = start; t < end; ++t)
+			clusterMisses += cache.access(indices + 3 * t);
+		const float clusterThreshold = threshold * static_cast<float>(clusterMisses) / (end - start);
+
+		clusters.push_back(start);
+		const size_t firstCluster = clusters.size() - 1;
+		cache.flush();
+		uint32_t misses = 0;
+		uint32_t triangles = 0;
+		for(uint32_t t = start; t < end; ++t) {
+			misses += cache.access(indices + 3 * t);
+			++triangles;
+			if(t + 1 < end && static_cast<float>(misses) <= clusterThreshold * triangles) {
+				clusters.push_back(t + 1);
+				cache.flush();
+				misses = 0;
+				triangles = 0;
+			}
+		}
+		// The last sub-cluster didn't reach the threshold: Merge it with the previous one.
+		if(triangles > 0 && clusters.size() - 1 > firstCluster)
+			clusters.pop_back();
+	}
+	clusters.push_back(static_cast<uint32_t>(triangleCount));
+
+	// Sort the clusters by how much they face away from the center of the mesh: Clusters on the outside are more likely to occlude the others.
+	const size_t		   clusterCount = clusters.size() - 1;
+	std::vector<glm::vec3> centroids(clusterCount), normals(clusterCount);
+	glm::vec3			   meshCentroid{0.0f};
+	float				   meshArea = 0.0f;
+	for(size_t c = 0; c < clusterCount; ++c) {
+		glm::vec3 centroid{0.0f}, normal{0.0f};
+		float	  area = 0.0f;
+		for(uint32_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+			const auto& p0 = vertices[indices[3 * t + 0]].pos;
+			const auto& p1 = vertices[indices[3 * t + 1]].pos;
+			const auto& p2 = vertices[indices[3 * t + 2]].pos;
+			const auto	n = glm::cross(p1 - p0, p2 - p0);
+			const float a = glm::length(n);
+			centroid += a * (p0 + p1 + p2) / 3.0f;
+			normal += n;
+			area += a;
+		}
+		meshCentroid += centroid;
+		meshArea += area;
+		centroids[c] = area > 0.0f ? centroid / area : centroid;
+		normals[c] = glm::length(normal) > 0.0f ? glm::normalize(normal) : normal;
+	}
+	if(meshArea > 0.0f)
+		meshCentroid /= meshArea;
+
+	std::vector<float> keys(clusterCount);
+	for(size_t c = 0; c < clusterCount; ++c)
+		keys[c] = glm::dot(centroids[c] - meshCentroid, normals[c]);
+	std::vector<uint32_t> order(clusterCount);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t l, uint32_t r) { return keys[l] > keys[r]; });
+
+	std::vector<uint32_t> result;
+	result.reserve(indexCount);
+	for(const auto c : order)
+		result.insert(result.end(), indices + 3 * clusters[c], indices + 3 * clusters[c + 1]);
+	std::copy(result.begin(), result.end(), indices);
+}
+
+size_t optimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t* remap) {
+	std::fill(remap, remap + vertexCount, ~0u);
+	uint32_t next = 0;
+	for(size_t i = 0; i < indexCount; ++i) {
+		auto& index = indices[i];
+		assert(index < vertexCount);
+		if(remap[index] == ~0u)
+			remap[index] = next++;
+		index = remap[index];
+	}
+	return next;
+}
+
+template<typename T>
+static void applyRemap(std::vector<T>& data, const std::vector<uint32_t>& remap, size_t newCount) {
+	std::vector<T> remapped(newCount);
+	for(size_t i = 0; i < data.size(); ++i)
+		if(remap[i] != ~0u)
+			remapped[remap[i]] = data[i];
+	data = std::move(remapped);
+}
+
+Report optimize(Mesh& mesh, const Options& options) {
+	auto& indices = mesh.getIndices();
+	auto& vertices = mesh.getVertices();
+	if(mesh.dynamic || indices.size() < 3 || indices.size() % 3 != 0)
+		return {};
+
+	Report report;
+	report.before = analyze(indices.data(), indices.size(), vertices.size());
+	if(options.vertexCache)
+		optimizeVertexCache(indices.data(), indices.size(), vertices.size());
+	if(options.overdraw)
+		optimizeOverdraw(indices.data(), indices.size(), vertices.data(), vertices.size(), options.overdrawThreshold);
+	if(options.vertexFetch) {
+		std::vector<uint32_t> remap(vertices.size());
+		const auto			  count = optimizeVertexFetch(indices.data(), indices.size(), vertices.size(), remap.data());
+		applyRemap(vertices, remap, count);
+		if(mesh.isSkinned()) {
+			applyRemap(mesh.getSkinVertexData().weights, remap, count);
+			applyRemap(mesh.getSkinVertexData().joints, remap, count);
+		}
+	}
+	report.after = analyze(indices.data(), indices.size(), vertices.size());
+	return report;
+}
+
+} // namespace MeshOptimizer
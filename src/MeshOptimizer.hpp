@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class Mesh;
+struct Vertex;
+
+// Post-import reordering of the triangles and vertices of indexed triangle lists, for the GPU caches:
+//  - optimizeVertexCache: Greedy triangle reordering for post-transform vertex cache locality (Tom Forsyth, "Linear-Speed Vertex Cache Optimisation").
+//  - optimizeOverdraw: Splits the cache optimized order into clusters and sorts them front-to-back from most viewpoints
+//    (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"), trading a bounded amount of cache efficiency.
+//  - optimizeVertexFetch: Renumbers vertices in first-use order (sequential vertex fetches, also benefits BLAS builds).
+// None of these modify the geometry: Only the order of the triangles (and vertices) changes, winding is preserved.
+namespace MeshOptimizer {
+
+// Simulated FIFO post-transform cache size, used by the statistics and the overdraw clustering.
+static constexpr uint32_t CacheSize = 16;
+
+struct Statistics {
+	size_t triangles = 0;
+	size_t vertices = 0; // Referenced vertices
+	size_t cacheMisses = 0;
+	float  acmr = 0.0f; // Average Cache Miss Ratio: Transformed vertices per triangle (0.5 is the ideal for large regular grids, 3 the worst)
+	float  atvr = 0.0f; // Average Transformed to Vertex Ratio: Transformed vertices per referenced vertex (1 is the ideal)
+};
+
+Statistics analyze(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = CacheSize);
+
+void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+// threshold: Maximum allowed ACMR degradation (e.g. 1.05: 5% more vertex shader invocations), indices are expected to be cache optimized.
+void optimizeOverdraw(uint32_t* indices, size_t indexCount, const Vertex* vertices, size_t vertexCount, float threshold = 1.05f);
+// Rewrites indices and returns the remap table (old index to new index, ~0u for unreferenced vertices) to apply to the vertex attributes.
+// Returns the number of referenced vertices.
+size_t optimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t* remap);
+
+struct Options {
+	bool  vertexCache = true;
+	bool  overdraw = true;
+	float overdrawThreshold = 1.05f;
+	bool  vertexFetch = true;
+};
+
+struct Report {
+	Statistics before;
+	Statistics after;
+};
+
+// Applies the selected passes to a triangle mesh (vertices, skin data and indices). Bounds are left untouched.
+// Dynamic meshes and meshes which aren't triangle lists are skipped (the returned report is then empty).
+Report optimize(Mesh& mesh, const Options& options = {});
+
+} // namespace MeshOptimizer
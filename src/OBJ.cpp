@@ -0,0 +1,303 @@
+#include "OBJ.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#include <ThreadPool.hpp>
+
+namespace OBJ {
+
+namespace {
+
+inline bool isDigit(char c) {
+	return static_cast<unsigned char>(c - '0') < 10;
+}
+
+inline bool isSpace(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline const char* skipSpaces(const char* cur, const char* end) {
+	while(cur < end && isSpace(*cur))
+		++cur;
+	return cur;
+}
+
+// Returns begin if there was no number. Values are capped (way) above the maximum number of elements of a table.
+const char* parseIndex(const char* begin, const char* end, int64_t& value) {
+	const char* cur = begin;
+	const bool	negative = cur < end && *cur == '-';
+	if(negative)
+		++cur;
+	const char* digits = cur;
+	int64_t		v = 0;
+	for(; cur < end && isDigit(*cur); ++cur)
+		if(v < (int64_t{1} << 40))
+			v = 10 * v + (*cur - '0');
+	if(cur == digits)
+		return begin;
+	value = negative ? -v : v;
+	return cur;
+}
+
+enum AttributeMask : uint8_t {
+	Position = 1 << 0,
+	TexCoord = 1 << 1,
+	Normal = 1 << 2,
+};
+
+struct Chunk {
+	Data data;
+	// Corners using relative indices, stored relative to the start of the chunk: The number of attributes declared in the previous chunks has to be added.
+	struct RelativeCorner {
+		uint32_t corner;
+		uint8_t	 attributes; // AttributeMask
+	};
+	std::vector<RelativeCorner> relativeCorners;
+};
+
+void parseChunk(std::string_view content, Chunk& chunk) {
+	auto&				data = chunk.data;
+	std::vector<Corner> polygon;
+	std::vector<uint8_t> polygonRelative; // AttributeMask, for each corner of polygon
+
+	// OBJ indices start at 1, negative ones are relative to the end of the table (-1 is the last declared element).
+	const auto resolve = [](int64_t index, size_t count, uint8_t& relative, AttributeMask attribute) -> uint32_t {
+		if(index > 0)
+			return static_cast<uint32_t>(index - 1);
+		if(index < 0) {
+			relative |= attribute;
+			return static_cast<uint32_t>(static_cast<int64_t>(count) + index); // Wraps around when referencing a previous chunk, fixed in parse().
+		}
+		return InvalidIndex;
+	};
+
+	const char* cur = content.data();
+	const char* end = cur + content.size();
+	while(cur < end) {
+		const char* lineEnd = static_cast<const char*>(std::memchr(cur, '\n', end - cur));
+		if(!lineEnd)
+			lineEnd = end;
+		cur = skipSpaces(cur, lineEnd);
+		const char* keywordBegin = cur;
+		while(cur < lineEnd && !isSpace(*cur))
+			++cur;
+		const std::string_view keyword{keywordBegin, static_cast<size_t>(cur - keywordBegin)};
+
+		if(keyword.empty() || keyword[0] == '#') {
+			// Empty line or comment
+		} else if(keyword == "v") {
+			glm::vec3 p{0.0f};
+			for(glm::vec3::length_type i = 0; i < 3; ++i)
+				cur = parseFloat(skipSpaces(cur, lineEnd), lineEnd, p[i]);
+			data.positions.push_back(p);
+		} else if(keyword == "vt") {
+			glm::vec2 uv{0.0f};
+			for(glm::vec2::length_type i = 0; i < 2; ++i)
+				cur = parseFloat(skipSpaces(cur, lineEnd), lineEnd, uv[i]);
+			data.texCoords.push_back(uv);
+		} else if(keyword == "vn") {
+			glm::vec3 n{0.0f};
+			for(glm::vec3::length_type i = 0; i < 3; ++i)
+				cur = parseFloat(skipSpaces(cur, lineEnd), lineEnd, n[i]);
+			data.normals.push_back(n);
+		} else if(keyword == "f") {
+			// v, v/vt, v//vn or v/vt/vn
+			polygon.clear();
+			polygonRelative.clear();
+			while(true) {
+				cur = skipSpaces(cur, lineEnd);
+				int64_t		index = 0;
+				const char* next = parseIndex(cur, lineEnd, index);
+				if(next == cur)
+					break;
+				Corner	c;
+				uint8_t relative = 0;
+				c.position = resolve(index, data.positions.size(), relative, Position);
+				cur = next;
+				if(cur < lineEnd && *cur == '/') {
+					next = parseIndex(++cur, lineEnd, index);
+					if(next != cur) // Empty in 'v//vn'
+						c.texCoord = resolve(index, data.texCoords.size(), relative, TexCoord);
+					cur = next;
+					if(cur < lineEnd && *cur == '/') {
+						next = parseIndex(++cur, lineEnd, index);
+						if(next != cur)
+							c.normal = resolve(index, data.normals.size(), relative, Normal);
+						cur = next;
+					}
+				}
+				polygon.push_back(c);
+				polygonRelative.push_back(relative);
+			}
+			if(polygon.size() < 3) {
+				++data.invalidFaces;
+			} else {
+				// Triangle fan around the first vertex
+				for(size_t i = 1; i + 1 < polygon.size(); ++i)
+					for(const auto v : {size_t{0}, i, i + 1}) {
+						if(polygonRelative[v])
+							chunk.relativeCorners.push_back({static_cast<uint32_t>(data.corners.size()), polygonRelative[v]});
+						data.corners.push_back(polygon[v]);
+					}
+			}
+		} else if(keyword == "o" || keyword == "g") {
+			cur = skipSpaces(cur, lineEnd);
+			const char* nameEnd = lineEnd;
+			while(nameEnd > cur && isSpace(nameEnd[-1]))
+				--nameEnd;
+			data.groups.push_back(Group{
+				.name = std::string{cur, nameEnd},
+				.object = keyword == "o",
+				.firstTriangle = data.corners.size() / 3,
+			});
+		} else if(keyword != "s" && keyword != "mtllib" && keyword != "usemtl") {
+			++data.unsupportedLines;
+		}
+		cur = lineEnd + 1;
+	}
+}
+
+} // namespace
+
+void parse(std::string_view content, Data& data, const ParseOptions& options) {
+	data = {};
+
+	// Split at the first line break after each multiple of chunkSize
+	std::vector<std::string_view> parts;
+	for(size_t begin = 0; begin < content.size();) {
+		size_t end = content.size();
+		if(options.chunkSize > 0 && begin + options.chunkSize < content.size()) {
+			end = content.find('\n', begin + options.chunkSize);
+			end = end == std::string_view::npos ? content.size() : end + 1;
+		}
+		parts.push_back(content.substr(begin, end - begin));
+		begin = end;
+	}
+
+	std::vector<Chunk> chunks(parts.size());
+	if(chunks.size() == 1) {
+		// Nothing to merge, and relative indices are already relative to the start of the file.
+		parseChunk(parts[0], chunks[0]);
+		data = std::move(chunks[0].data);
+		return;
+	}
+	{
+		ThreadPool::TaskQueue tasks;
+		for(size_t i = 0; i < chunks.size(); ++i)
+			tasks.start([&, i]() { parseChunk(parts[i], chunks[i]); });
+	}
+
+	// Element offsets of each chunk in the final tables
+	struct Offsets {
+		size_t positions = 0, texCoords = 0, normals = 0, corners = 0, groups = 0;
+	};
+	std::vector<Offsets> offsets(chunks.size() + 1);
+	for(size_t i = 0; i < chunks.size(); ++i) {
+		const auto& d = chunks[i].data;
+		offsets[i + 1] = Offsets{
+			.positions = offsets[i].positions + d.positions.size(),
+			.texCoords = offsets[i].texCoords + d.texCoords.size(),
+			.normals = offsets[i].normals + d.normals.size(),
+			.corners = offsets[i].corners + d.corners.size(),
+			.groups = offsets[i].groups + d.groups.size(),
+		};
+		data.unsupportedLines += d.unsupportedLines;
+		data.invalidFaces += d.invalidFaces;
+	}
+	data.positions.resize(offsets.back().positions);
+	data.texCoords.resize(offsets.back().texCoords);
+	data.normals.resize(offsets.back().normals);
+	data.corners.resize(offsets.back().corners);
+	data.groups.resize(offsets.back().groups);
+
+	ThreadPool::TaskQueue tasks;
+	for(size_t i = 0; i < chunks.size(); ++i)
+		tasks.start([&, i]() {
+			auto&		chunk = chunks[i];
+			const auto& o = offsets[i];
+			std::copy(chunk.data.positions.begin(), chunk.data.positions.end(), data.positions.begin() + o.positions);
+			std::copy(chunk.data.texCoords.begin(), chunk.data.texCoords.end(), data.texCoords.begin() + o.texCoords);
+			std::copy(chunk.data.normals.begin(), chunk.data.normals.end(), data.normals.begin() + o.normals);
+			std::copy(chunk.data.corners.begin(), chunk.data.corners.end(), data.corners.begin() + o.corners);
+			for(const auto& r : chunk.relativeCorners) {
+				auto& c = data.corners[o.corners + r.corner];
+				if(r.attributes & Position)
+					c.position += static_cast<uint32_t>(o.positions);
+				if(r.attributes & TexCoord)
+					c.texCoord += static_cast<uint32_t>(o.texCoords);
+				if(r.attributes & Normal)
+					c.normal += static_cast<uint32_t>(o.normals);
+			}
+			for(size_t g = 0; g < chunk.data.groups.size(); ++g) {
+				auto& group = data.groups[o.groups + g];
+				group = std::move(chunk.data.groups[g]);
+				group.firstTriangle += o.corners / 3;
+			}
+		});
+}
+
+const char* parseFloat(const char* begin, const char* end, float& value) {
+	// Exactly representable as doubles
+	static constexpr double PowersOf10[]{1e0,  1e1,	 1e2,  1e3,	 1e4,  1e5,	 1e6,  1e7,	 1e8,  1e9,	 1e10, 1e11,
+										 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+	constexpr int			MaxDigits = 15; // The mantissa is then exactly representable too (< 2^53)
+
+	const char* cur = begin;
+	const bool	negative = cur < end && *cur == '-';
+	if(cur < end && (*cur == '-' || *cur == '+'))
+		++cur;
+	const char* numberBegin = cur;
+
+	uint64_t mantissa = 0;
+	int		 digits = 0; // Significant digits
+	int		 exponent = 0;
+	bool	 hasDigits = false;
+	// Digits past MaxDigits are dropped, the number then goes through the slow path anyway.
+	const auto readDigit = [&](char c) {
+		hasDigits = true;
+		if(mantissa != 0 || c != '0')
+			++digits;
+		if(digits <= MaxDigits)
+			mantissa = 10 * mantissa + static_cast<uint64_t>(c - '0');
+	};
+	for(; cur < end && isDigit(*cur); ++cur)
+		readDigit(*cur);
+	if(cur < end && *cur == '.')
+		for(++cur; cur < end && isDigit(*cur); ++cur) {
+			readDigit(*cur);
+			--exponent;
+		}
+	if(hasDigits && cur < end && (*cur == 'e' || *cur == 'E')) {
+		const char* e = cur + 1;
+		const bool	negativeExponent = e < end && *e == '-';
+		if(e < end && (*e == '-' || *e == '+'))
+			++e;
+		if(e < end && isDigit(*e)) {
+			int exp = 0;
+			for(; e < end && isDigit(*e); ++e)
+				if(exp < 100000)
+					exp = 10 * exp + (*e - '0');
+			exponent += negativeExponent ? -exp : exp;
+			cur = e;
+		}
+	}
+
+	if(hasDigits && digits <= MaxDigits && exponent >= -22 && exponent <= 22) {
+		double d = static_cast<double>(mantissa);
+		d = exponent < 0 ? d / PowersOf10[-exponent] : d * PowersOf10[exponent];
+		value = static_cast<float>(negative ? -d : d);
+		return cur;
+	}
+
+	// Long mantissas, large exponents, inf and nan. from_chars doesn't accept a leading '+', the sign is handled here.
+	double d = 0.0;
+	auto   r = std::from_chars(numberBegin, end, d);
+	if(r.ec == std::errc::invalid_argument || r.ptr == numberBegin)
+		return begin;
+	value = static_cast<float>(negative ? -d : d);
+	return r.ptr;
+}
+
+} // namespace OBJ
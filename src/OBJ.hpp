@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+
+// Wavefront OBJ front-end: Parses the geometry (v, vt, vn, f, o and g statements) of an .obj file held in memory.
+// The file is split into line-aligned chunks parsed in parallel on the ThreadPool, each into its own tables, which are then concatenated.
+// Relative (negative) face indices depend on the attributes declared in the previous chunks: They are resolved during the concatenation.
+// Polygons are fan-triangulated. Materials (mtllib, usemtl), smoothing groups, lines and points are ignored.
+namespace OBJ {
+
+inline constexpr uint32_t InvalidIndex = 0xFFFFFFFF;
+
+// Vertex of a face, as 0-based indices into the attribute tables (InvalidIndex if not specified).
+// Indices are not validated by the parser: Out-of-range ones are left to the consumer (see Scene::loadOBJ).
+struct Corner {
+	uint32_t position = InvalidIndex;
+	uint32_t texCoord = InvalidIndex;
+	uint32_t normal = InvalidIndex;
+
+	bool operator==(const Corner&) const = default;
+};
+
+// Started by an 'o' (new object) or 'g' (new group in the current object) statement, spans the triangles up to the next one.
+struct Group {
+	std::string name;
+	bool		object = false;
+	size_t		firstTriangle = 0;
+};
+
+struct Data {
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> texCoords;
+	std::vector<glm::vec3> normals;
+	std::vector<Corner>	   corners; // 3 per triangle
+	std::vector<Group>	   groups;	// In order of appearance. Triangles before the first group belong to an unnamed object.
+	size_t				   unsupportedLines = 0;
+	size_t				   invalidFaces = 0; // Less than 3 vertices, skipped
+};
+
+struct ParseOptions {
+	size_t chunkSize = 4 * 1024 * 1024; // Approximate size of the chunks parsed in parallel, in bytes. 0: Parse the whole file on the calling thread.
+};
+
+void parse(std::string_view content, Data& data, const ParseOptions& options = {});
+
+// Decimal floating point number with an optional sign, fraction and exponent. Returns the end of the number, or begin if there was none.
+// Mantissas up to 15 digits with small exponents are converted with a single exact multiplication or division (the vast majority of
+// the numbers found in OBJ files), others fall back to std::from_chars.
+const char* parseFloat(const char* begin, const char* end, float& value);
+
+} // namespace OBJ
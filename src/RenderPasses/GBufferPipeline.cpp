@@ -166,8 +166,8 @@ void Editor::createGBufferPipeline() {
 		descriptorSetsLayoutsToAllocate.push_back(_gbufferDescriptorSetLayouts[1]);
 	_gbufferDescriptorPool.allocate(descriptorSetsLayoutsToAllocate);
 
-	auto										   bindingDescription = {Vertex::getBindingDescription()};
-	std::vector<VkVertexInputAttributeDescription> attributeDescriptions{Vertex::getAttributeDescriptions().begin(), Vertex::getAttributeDescriptions().end()};
+	auto										   bindingDescription = {PackedVertex::getBindingDescription()};
+	std::vector<VkVertexInputAttributeDescription> attributeDescriptions{PackedVertex::getAttributeDescriptions().begin(), PackedVertex::getAttributeDescriptions().end()};
 
 	VkPipelineVertexInputStateCreateInfo vertexInputInfo{
 		.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
@@ -303,14 +303,14 @@ void Editor::createGBufferPipeline() {
 			fragShader.getStageCreateInfo(VK_SHADER_STAGE_FRAGMENT_BIT),
 		};
 		auto bindingDescription = {
-			Vertex::getBindingDescription(),
+			PackedVertex::getBindingDescription(),
 			VkVertexInputBindingDescription{
 				.binding = 1,
 				.stride = sizeof(glm::vec4),
 				.inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
 			},
 		};
-		std::vector<VkVertexInputAttributeDescription> attributeDescriptions{Vertex::getAttributeDescriptions().begin(), Vertex::getAttributeDescriptions().end()};
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions{PackedVertex::getAttributeDescriptions().begin(), PackedVertex::getAttributeDescriptions().end()};
 		attributeDescriptions.push_back(VkVertexInputAttributeDescription{
 			.location = 5,
 			.binding = 1,
@@ -24,6 +24,7 @@ void Renderer::freeMeshesDeviceMemory() {
 
 	StaticOffsetTableSizeInBytes = 0;
 	StaticVertexBufferSizeInBytes = 0;
+	StaticVertexBufferCapacityInBytes = 0;
 	StaticJointsBufferSizeInBytes = 0;
 	StaticWeightsBufferSizeInBytes = 0;
 
@@ -60,15 +61,20 @@ void Renderer::allocateMeshes() {
 
 	updateMeshOffsetTable();
 	auto indexMemoryTypeBits = getMeshes()[0].getIndexBuffer().getMemoryRequirements().memoryTypeBits;
+	// Headroom for appendMeshes, proportional to the current size so that the reallocations (once it is exhausted) stay amortized.
+	const auto withHeadroom = [&](size_t size) { return size + std::max(size / 2, MinStaticHeadroomInBytes); };
+	StaticVertexBufferCapacityInBytes = withHeadroom(StaticVertexBufferSizeInBytes);
 	Vertices.init(*_device,
 				  VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
 					  VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-				  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, StaticVertexBufferSizeInBytes + MaxSkinnedVertexSizeInBytes, VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT );
-	Indices.init(*_device, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, StaticIndexBufferSizeInBytes,
-				 VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT);
+				  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, StaticVertexBufferCapacityInBytes + MaxSkinnedVertexSizeInBytes, VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT );
+	Indices.init(*_device, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				 withHeadroom(StaticIndexBufferSizeInBytes), VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT);
+	size_t meshCount = 0;
 	for(const auto& mesh : getMeshes()) {
 		if(!mesh.isValid() && !mesh.dynamic)
 			continue;
+		++meshCount;
 
 		Vertices.bind(mesh.getVertexBuffer());
 		Indices.bind(mesh.getIndexBuffer());
@@ -84,14 +90,76 @@ void Renderer::allocateMeshes() {
 	}
 
 	MotionVectors.init(*_device, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-					   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(glm::vec4) * MaxSkinnedVertexSizeInBytes / sizeof(Vertex), VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT);
+					   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(glm::vec4) * MaxSkinnedVertexSizeInBytes / sizeof(PackedVertex), VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT);
 
 	OffsetTable.init(*_device, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-					 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, StaticOffsetTableSizeInBytes + 1024 * sizeof(OffsetEntry), VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT);
+					 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, StaticOffsetTableSizeInBytes + std::max(StaticOffsetTableSizeInBytes / 2, MinOffsetTableHeadroom * sizeof(OffsetEntry)),
+					 VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT);
 
 	uploadMeshOffsetTable();
 
 	allocateSkinnedMeshes();
+
+	const auto vertexCount = StaticVertexBufferSizeInBytes / sizeof(PackedVertex);
+	print("Renderer: {} meshes, {} vertices ({:.2f} MB, {:.2f} MB unpacked), {} indices ({:.2f} MB), {:.2f} MB of skinning data.\n", meshCount, vertexCount,
+		  StaticVertexBufferSizeInBytes / (1024.0 * 1024.0), vertexCount * sizeof(Vertex) / (1024.0 * 1024.0), StaticIndexBufferSizeInBytes / sizeof(uint32_t),
+		  StaticIndexBufferSizeInBytes / (1024.0 * 1024.0), (StaticJointsBufferSizeInBytes + StaticWeightsBufferSizeInBytes) / (1024.0 * 1024.0));
+}
+
+bool Renderer::appendMeshes(size_t firstMesh) {
+	if(!Vertices)
+		return false;
+	auto& meshes = getMeshes();
+	// Same placement as StaticDeviceAllocator::bind
+	const auto placed = [](size_t offset, const VkMemoryRequirements& memReq) {
+		offset += memReq.size;
+		return offset % memReq.alignment == 0 ? offset : offset + memReq.alignment - offset % memReq.alignment;
+	};
+	size_t vertexEnd = Vertices.size();
+	size_t indexEnd = Indices.size();
+	for(size_t i = firstMesh; i < meshes.size(); ++i) {
+		const auto& mesh = meshes[i];
+		if(mesh.dynamic || mesh.isSkinned()) // Their reservations are only made by allocateMeshes and createAccelerationStructures
+			return false;
+		if(!mesh.isValid())
+			continue;
+		vertexEnd = placed(vertexEnd, mesh.getVertexBuffer().getMemoryRequirements());
+		indexEnd = placed(indexEnd, mesh.getIndexBuffer().getMemoryRequirements());
+	}
+	if(vertexEnd > StaticVertexBufferCapacityInBytes || indexEnd > Indices.capacity())
+		return false;
+	// New skinned instances need their own BLAS and vertices.
+	if(_scene->getRegistry().view<SkinnedMeshRendererComponent>().size() != _skinnedBLASBuildGeometryInfos.size())
+		return false;
+
+	// Entries of the existing meshes are unchanged, the material variants and the skinned entries follow the new ones.
+	if(!updateOffsetTables())
+		return false;
+	for(size_t i = firstMesh; i < meshes.size(); ++i) {
+		if(!meshes[i].isValid())
+			continue;
+		Vertices.bind(meshes[i].getVertexBuffer());
+		Indices.bind(meshes[i].getIndexBuffer());
+	}
+	assert(Vertices.size() == vertexEnd && Indices.size() == indexEnd);
+	return true;
+}
+
+bool Renderer::updateOffsetTables() {
+	updateMeshOffsetTable();
+	updateSkinnedMeshOffsetTable();
+	if(StaticOffsetTableSizeInBytes + SkinnedOffsetTableSizeInBytes > OffsetTable.capacity()) {
+		warn("Renderer::updateOffsetTables: Offset table capacity exceeded ({} > {} bytes), meshes have to be re-allocated.\n",
+			 StaticOffsetTableSizeInBytes + SkinnedOffsetTableSizeInBytes, OffsetTable.capacity());
+		return false;
+	}
+	uploadMeshOffsetTable();
+	uploadSkinnedMeshOffsetTable();
+	return true;
+}
+
+static uint64_t getMaterialVariantKey(const MeshRendererComponent& renderer) {
+	return (static_cast<uint64_t>(renderer.meshIndex.value) << 32) | renderer.materialIndex.value;
 }
 
 void Renderer::updateMeshOffsetTable() {
@@ -109,7 +177,7 @@ void Renderer::updateMeshOffsetTable() {
 		m.indexIntoOffsetTable = static_cast<uint32_t>(_offsetTable.size());
 		_offsetTable.push_back(OffsetEntry{
 			static_cast<uint32_t>(m.defaultMaterialIndex),
-			static_cast<uint32_t>(totalVertexSize / sizeof(Vertex)),
+			static_cast<uint32_t>(totalVertexSize / sizeof(PackedVertex)),
 			static_cast<uint32_t>(totalIndexSize / sizeof(uint32_t)),
 		});
 		totalVertexSize += vertexBufferMemReq.size;
@@ -120,11 +188,31 @@ void Renderer::updateMeshOffsetTable() {
 			StaticWeightsBufferSizeInBytes += m.getSkinWeightsBuffer().getMemoryRequirements().size;
 		}
 	}
+	_materialVariantEntries.clear();
+	for(auto&& [entity, renderer] : _scene->getRegistry().view<MeshRendererComponent>().each()) {
+		if(renderer.meshIndex == InvalidMeshIndex || renderer.materialIndex == InvalidMaterialIndex)
+			continue;
+		const auto& m = getMeshes()[renderer.meshIndex];
+		if((!m.isValid() && !m.dynamic) || renderer.materialIndex == m.defaultMaterialIndex)
+			continue;
+		if(_materialVariantEntries.try_emplace(getMaterialVariantKey(renderer), static_cast<uint32_t>(_offsetTable.size())).second) {
+			auto entry = _offsetTable[m.indexIntoOffsetTable];
+			entry.materialIndex = static_cast<uint32_t>(renderer.materialIndex);
+			_offsetTable.push_back(entry);
+		}
+	}
+
 	StaticVertexBufferSizeInBytes = totalVertexSize;
 	StaticIndexBufferSizeInBytes = totalIndexSize;
 	StaticOffsetTableSizeInBytes = static_cast<uint32_t>(sizeof(OffsetEntry) * _offsetTable.size());
 }
 
+uint32_t Renderer::getOffsetTableIndex(const MeshRendererComponent& renderer) const {
+	if(const auto it = _materialVariantEntries.find(getMaterialVariantKey(renderer)); it != _materialVariantEntries.end())
+		return it->second;
+	return getMeshes()[renderer.meshIndex].indexIntoOffsetTable;
+}
+
 void Renderer::uploadMeshOffsetTable() {
 	if(!_offsetTable.empty())
 		copyViaStagingBuffer(OffsetTable.buffer(), _offsetTable);
@@ -152,7 +240,7 @@ void Renderer::updateSkinnedMeshOffsetTable() {
 		skinnedMeshRenderer.indexIntoOffsetTable = static_cast<uint32_t>(_offsetTable.size() + _skinnedOffsetTable.size());
 		_skinnedOffsetTable.push_back(OffsetEntry{
 			static_cast<uint32_t>(skinnedMeshRenderer.materialIndex),
-			static_cast<uint32_t>((StaticVertexBufferSizeInBytes + totalVertexSize) / sizeof(Vertex)),
+			static_cast<uint32_t>((StaticVertexBufferCapacityInBytes + totalVertexSize) / sizeof(PackedVertex)),
 			static_cast<uint32_t>(_offsetTable[getMeshes()[skinnedMeshRenderer.meshIndex].indexIntoOffsetTable].indexOffset),
 		});
 		totalVertexSize += vertexBufferMemReq.size;
@@ -228,7 +316,7 @@ bool Renderer::updateSkinnedVertexBuffer() {
 				.dstOffset = _skinnedOffsetTable[skinnedMeshRenderer.indexIntoOffsetTable - StaticOffsetTableSizeInBytes / sizeof(OffsetEntry)].vertexOffset,
 				.size = static_cast<uint32_t>(_scene->getMeshes()[skinnedMeshRenderer.meshIndex].getVertices().size()),
 				.motionVectorsOffset = _skinnedOffsetTable[skinnedMeshRenderer.indexIntoOffsetTable - StaticOffsetTableSizeInBytes / sizeof(OffsetEntry)].vertexOffset -
-									   static_cast<uint32_t>(StaticVertexBufferSizeInBytes / sizeof(Vertex)),
+									   static_cast<uint32_t>(StaticVertexBufferCapacityInBytes / sizeof(PackedVertex)),
 			};
 			vkCmdPushConstants(commandBuffer, _vertexSkinningPipeline.getLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(VertexSkinningPushConstant), &constants);
 			vkCmdDispatch(commandBuffer, std::ceil(constants.size / 128.0), 1, 1);
@@ -247,7 +335,7 @@ constexpr VkAccelerationStructureGeometryKHR BaseVkAccelerationStructureGeometry
 					.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR,
 					.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT,
 					.vertexData = 0,
-					.vertexStride = sizeof(Vertex),
+					.vertexStride = sizeof(PackedVertex),
 					.maxVertex = 0,
 					.indexType = VK_INDEX_TYPE_UINT32,
 					.indexData = 0,
@@ -374,7 +462,7 @@ void Renderer::createAccelerationStructures() {
 
 			baseGeometry.geometry.triangles.vertexData = VkDeviceOrHostAddressConstKHR{
 				Vertices.buffer().getDeviceAddress() +
-				sizeof(Vertex) * _skinnedOffsetTable[skinnedMeshRenderer.indexIntoOffsetTable - StaticOffsetTableSizeInBytes / sizeof(OffsetEntry)].vertexOffset};
+				sizeof(PackedVertex) * _skinnedOffsetTable[skinnedMeshRenderer.indexIntoOffsetTable - StaticOffsetTableSizeInBytes / sizeof(OffsetEntry)].vertexOffset};
 			baseGeometry.geometry.triangles.maxVertex = static_cast<uint32_t>(mesh.getVertices().size() - 1);
 			baseGeometry.geometry.triangles.indexData = VkDeviceOrHostAddressConstKHR{mesh.getIndexBuffer().getDeviceAddress()};
 			geometries.push_back(baseGeometry);
@@ -406,8 +494,9 @@ void Renderer::createAccelerationStructures() {
 			_skinnedBLASBuildGeometryInfos.push_back(accelerationBuildGeometryInfo);
 			_skinnedBLASBuildRangeInfos.push_back(rangeInfos.back());
 		}
+		// With some headroom for appendBLAS
 		_blasMemory.init(*_device, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-						 totalBLASSize, VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT);
+						 totalBLASSize + std::max(totalBLASSize / 2, MinStaticHeadroomInBytes), VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT);
 		size_t runningOffset = 0;
 		_bottomLevelAccelerationStructures.resize(buildInfos.size());
 		for(size_t i = 0; i < buildInfos.size(); ++i) {
@@ -421,6 +510,7 @@ void Renderer::createAccelerationStructures() {
 		}
 		_blasMemory.reserve(runningOffset);
 
+		_blasScratchBufferSize = scratchBufferSize;
 		_blasScratchBuffer.create(*_device, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, scratchBufferSize);
 		_blasScratchMemory.allocate(*_device, _blasScratchBuffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR);
 		size_t	   offset = 0;
@@ -448,6 +538,73 @@ void Renderer::createAccelerationStructures() {
 	createTLAS();
 }
 
+bool Renderer::appendBLAS(size_t firstMesh) {
+	if(!_blasMemory)
+		return false;
+	auto& meshes = getMeshes();
+
+	std::vector<VkAccelerationStructureGeometryKHR>			 geometries;
+	std::vector<VkAccelerationStructureBuildGeometryInfoKHR> buildInfos;
+	std::vector<VkAccelerationStructureBuildRangeInfoKHR>	 rangeInfos;
+	std::vector<VkAccelerationStructureBuildSizesInfoKHR>	 buildSizesInfo;
+	std::vector<size_t>										 meshIndices;
+	geometries.reserve(meshes.size() - firstMesh); // Avoid reallocation since buildInfos will refer to this.
+	size_t totalBLASSize = 0;
+	size_t scratchBufferSize = 0;
+	auto   baseGeometry = BaseVkAccelerationStructureGeometryKHR;
+	auto   accelerationBuildGeometryInfo = BaseAccelerationStructureBuildGeometryInfo;
+	for(size_t i = firstMesh; i < meshes.size(); ++i) {
+		const auto& mesh = meshes[i];
+		if(!mesh.isValid())
+			continue;
+		assert(!mesh.dynamic); // See appendMeshes
+		baseGeometry.geometry.triangles.vertexData = VkDeviceOrHostAddressConstKHR{mesh.getVertexBuffer().getDeviceAddress()};
+		baseGeometry.geometry.triangles.maxVertex = static_cast<uint32_t>(mesh.getVertices().size() - 1);
+		baseGeometry.geometry.triangles.indexData = VkDeviceOrHostAddressConstKHR{mesh.getIndexBuffer().getDeviceAddress()};
+		geometries.push_back(baseGeometry);
+		accelerationBuildGeometryInfo.pGeometries = &geometries.back();
+
+		const uint32_t primitiveCount = static_cast<uint32_t>(mesh.getIndices().size() / 3);
+		const auto	   sizes = AccelerationStructure::getBuildSize(*_device, accelerationBuildGeometryInfo, primitiveCount);
+		// FIXME: Query this 256 alignment instead of hardcoding it.
+		totalBLASSize += static_cast<uint32_t>(std::ceil(sizes.accelerationStructureSize / 256.0)) * 256;
+		scratchBufferSize += sizes.buildScratchSize;
+		buildSizesInfo.push_back(sizes);
+		buildInfos.push_back(accelerationBuildGeometryInfo);
+		rangeInfos.push_back({
+			.primitiveCount = primitiveCount,
+			.primitiveOffset = 0,
+			.firstVertex = 0,
+			.transformOffset = 0,
+		});
+		meshIndices.push_back(i);
+	}
+	if(_blasMemory.size() + totalBLASSize > _blasMemory.capacity() || scratchBufferSize > _blasScratchBufferSize)
+		return false;
+	if(buildInfos.empty())
+		return true;
+
+	// The scratch buffer is shared with the updates of the skinned BLAS: The device must be idle.
+	size_t	   scratchOffset = 0;
+	const auto scratchBufferAddr = _blasScratchBuffer.getDeviceAddress();
+	for(size_t i = 0; i < buildInfos.size(); ++i) {
+		auto& blas = _bottomLevelAccelerationStructures.emplace_back();
+		blas.create(*_device, _blasMemory.buffer(), _blasMemory.size(), buildSizesInfo[i].accelerationStructureSize);
+		_blasMemory.reserve(static_cast<uint32_t>(std::ceil(buildSizesInfo[i].accelerationStructureSize / 256.0)) * 256);
+		meshes[meshIndices[i]].blasIndex = _bottomLevelAccelerationStructures.size() - 1;
+		buildInfos[i].dstAccelerationStructure = blas;
+		buildInfos[i].scratchData = {.deviceAddress = scratchBufferAddr + scratchOffset};
+		scratchOffset += buildSizesInfo[i].buildScratchSize;
+	}
+	std::vector<VkAccelerationStructureBuildRangeInfoKHR*> pRangeInfos;
+	for(auto& rangeInfo : rangeInfos)
+		pRangeInfos.push_back(&rangeInfo); // geometryCount is always 1 here.
+	_device->immediateSubmitCompute([&](const CommandBuffer& commandBuffer) {
+		vkCmdBuildAccelerationStructuresKHR(commandBuffer, static_cast<uint32_t>(buildInfos.size()), buildInfos.data(), pRangeInfos.data());
+	});
+	return true;
+}
+
 void Renderer::createBLAS(MeshIndex idx) {
 	auto& mesh = (*_scene)[idx];
 	assert(mesh.blasIndex == -1);
@@ -542,7 +699,7 @@ void Renderer::createTLAS() {
 
 			_accStructInstances.push_back(VkAccelerationStructureInstanceKHR{
 				.transform = transposedTransform,
-				.instanceCustomIndex = meshes[meshRendererComponent.meshIndex].indexIntoOffsetTable,
+				.instanceCustomIndex = getOffsetTableIndex(meshRendererComponent),
 				.mask = InstanceMask::Static,
 				.instanceShaderBindingTableRecordOffset = 0,
 				.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR,
@@ -821,8 +978,8 @@ void Renderer::createVertexSkinningPipeline(VkPipelineCache pipelineCache) {
 			auto& skinnedMeshRenderer = _scene->getRegistry().get<SkinnedMeshRendererComponent>(entity);
 			auto  vertexSize = getMeshes()[skinnedMeshRenderer.meshIndex].getVertexByteSize();
 			regions.push_back({
-				.srcOffset = _offsetTable[getMeshes()[skinnedMeshRenderer.meshIndex].indexIntoOffsetTable].vertexOffset * sizeof(Vertex),
-				.dstOffset = _skinnedOffsetTable[skinnedMeshRenderer.indexIntoOffsetTable - StaticOffsetTableSizeInBytes / sizeof(OffsetEntry)].vertexOffset * sizeof(Vertex),
+				.srcOffset = _offsetTable[getMeshes()[skinnedMeshRenderer.meshIndex].indexIntoOffsetTable].vertexOffset * sizeof(PackedVertex),
+				.dstOffset = _skinnedOffsetTable[skinnedMeshRenderer.indexIntoOffsetTable - StaticOffsetTableSizeInBytes / sizeof(OffsetEntry)].vertexOffset * sizeof(PackedVertex),
 				.size = vertexSize,
 			});
 		}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <unordered_map>
+
 #include <glm/glm.hpp>
 
 #include <DescriptorPool.hpp>
@@ -59,6 +61,16 @@ class Renderer {
 	void allocateMeshes();
 	void updateMeshOffsetTable();
 	void uploadMeshOffsetTable();
+	// Updates and uploads the static and skinned offset tables (e.g. after a change of material creating a new material variant). Returns false, without
+	// uploading anything, if they no longer fit in the capacity reserved by allocateMeshes: allocateMeshes has to be called again.
+	bool updateOffsetTables();
+	// Progressive loading: Binds the meshes [firstMesh, getMeshes().size()) (initialized, but not uploaded yet) to the headroom left by allocateMeshes after
+	// the static meshes, and updates the offset table. Returns false if they don't fit, if they are skinned or dynamic, or if skinned instances were added:
+	// allocateMeshes has to be called again.
+	bool appendMeshes(size_t firstMesh);
+	// Builds the BLAS of the (uploaded) meshes [firstMesh, getMeshes().size()) in the headroom left by createAccelerationStructures. The TLAS isn't updated.
+	// Returns false if they don't fit: createAccelerationStructures has to be called again.
+	bool appendBLAS(size_t firstMesh);
 
 	void allocateSkinnedMeshes();
 	void updateSkinnedMeshOffsetTable();
@@ -88,6 +100,8 @@ class Renderer {
 	size_t				  StaticVertexBufferSizeInBytes = 0;
 	size_t				  StaticIndexBufferSizeInBytes = 0;
 	size_t				  StaticOffsetTableSizeInBytes = 0;
+	// Space reserved for the static meshes, including the headroom for appendMeshes. The vertices of the skinned meshes start after it.
+	size_t				  StaticVertexBufferCapacityInBytes = 0;
 	size_t				  StaticJointsBufferSizeInBytes = 0;
 	size_t				  StaticWeightsBufferSizeInBytes = 0;
 
@@ -96,6 +110,10 @@ class Renderer {
 	Device* _device = nullptr;
 
 	std::vector<OffsetEntry> _offsetTable;
+	// Additional static entries for renderers using another material than the default one of their mesh (e.g. meshes shared after deduplication),
+	// indexed by getMaterialVariantKey.
+	std::unordered_map<uint64_t, uint32_t> _materialVariantEntries;
+	uint32_t							   getOffsetTableIndex(const MeshRendererComponent&) const;
 
 	// Data for dynamic (skinned) meshes.
 	const uint32_t											 MaxSkinnedBLAS = 1024;
@@ -106,6 +124,10 @@ class Renderer {
 	std::vector<VkAccelerationStructureBuildGeometryInfoKHR> _skinnedBLASBuildGeometryInfos;
 	std::vector<VkAccelerationStructureBuildRangeInfoKHR>	 _skinnedBLASBuildRangeInfos;
 
+	// Minimum headroom of the static buffers (in addition to half of their current size) for the content appended while a scene is progressively loaded.
+	const size_t MinStaticHeadroomInBytes = 16 * 1024 * 1024;
+	const size_t MinOffsetTableHeadroom = 1024; // In number of entries, for the skinned meshes and the material variants.
+
 	StaticDeviceAllocator							_blasMemory;
 	Buffer											_tlasBuffer;
 	DeviceMemory									_tlasMemory;
@@ -127,6 +149,7 @@ class Renderer {
 	// (the easiest is wimply to separate BLAS building into two pass, static and dynamic, sharing no memory).
 	Buffer		 _blasScratchBuffer; // Temporary buffer used for Acceleration Creation, big enough for all AC so they can be build in parallel
 	DeviceMemory _blasScratchMemory;
+	size_t		 _blasScratchBufferSize = 0;
 
 	std::vector<QueryPool> _updateQueryPools;
 	RollingBuffer<float>   _skinnedBLASUpdateTimes;
@@ -1,27 +1,45 @@
 #include "Scene.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <numeric>
 #include <string_view>
 
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 
+#include "Gltf.hpp"
 #include "JSON.hpp"
+#include "JSONBinary.hpp"
+#include "JSONWriter.hpp"
 #include "Logger.hpp"
 #include "STBImage.hpp"
 #include <Base64.hpp>
+#include <Hash.hpp>
+#include <MappedFile.hpp>
+#include <OBJ.hpp>
 #include <QuickTimer.hpp>
+#include <SceneFile.hpp>
 #include <Serialization.hpp>
 #include <ThreadPool.hpp>
+#include <VertexKernels.hpp>
 #include <vulkan/Material.hpp>
 
 Scene::Scene() {
+	_registry.on_construct<NodeComponent>().connect<&Scene::onConstructNodeComponent>(this);
 	_registry.on_destroy<NodeComponent>().connect<&Scene::onDestroyNodeComponent>(this);
+	_registry.on_construct<MeshRendererComponent>().connect<&Scene::onRendererChange>(this);
+	_registry.on_update<MeshRendererComponent>().connect<&Scene::onRendererChange>(this);
+	_registry.on_destroy<MeshRendererComponent>().connect<&Scene::onRendererChange>(this);
+	_registry.on_construct<SkinnedMeshRendererComponent>().connect<&Scene::onRendererChange>(this);
+	_registry.on_update<SkinnedMeshRendererComponent>().connect<&Scene::onRendererChange>(this);
+	_registry.on_destroy<SkinnedMeshRendererComponent>().connect<&Scene::onRendererChange>(this);
 	_root = _registry.create();
 	_registry.emplace<NodeComponent>(_root).name = "Root";
 }
 
-Scene::Scene(const std::filesystem::path& path) {
+Scene::Scene(const std::filesystem::path& path) : Scene() {
 	load(path);
 }
 
@@ -39,7 +57,7 @@ bool Scene::load(const std::filesystem::path& path) {
 	else if(ext == ".gltf" || ext == ".glb")
 		return loadglTF(canonicalPath);
 	else if(ext == ".png") {
-		Textures.push_back(Texture{
+		_textures->push_back(Texture{
 			.source = canonicalPath, .format = VK_FORMAT_R8G8B8A8_SRGB,
 			//.samplerDescription = JSON({"magFilter" : 9729, "minFilter" : 9986}),
 		});
@@ -57,6 +75,7 @@ struct GLBHeader {
 enum class GLBChunkType : uint32_t {
 	JSON = 0x4E4F534A,
 	BIN = 0x004E4942,
+	BJSN = 0x4E534A42, // JSON chunk using the binary encoding of JSONBinary.hpp (.scene files only)
 };
 
 struct GLBChunk {
@@ -65,138 +84,327 @@ struct GLBChunk {
 	char*		 data;
 };
 
-template<typename T>
-std::vector<T> extract(const JSON::value& object, const std::vector<std::vector<char>>& buffers, int accessorIndex) {
-	const auto& accessor = object["accessors"][accessorIndex];
-	if constexpr(std::is_same<T, float>()) {
-		assert(Scene::ComponentType(accessor["componentType"].as<int>()) == Scene::ComponentType::Float);
-		assert(accessor["type"].asString() == "SCALAR");
-	}
-	if constexpr(std::is_same<T, glm::vec2>()) {
-		assert(Scene::ComponentType(accessor["componentType"].as<int>()) == Scene::ComponentType::Float);
-		assert(accessor["type"].asString() == "VEC2");
-	}
-	if constexpr(std::is_same<T, glm::vec3>()) {
-		assert(Scene::ComponentType(accessor["componentType"].as<int>()) == Scene::ComponentType::Float);
-		assert(accessor["type"].asString() == "VEC3");
+struct GLBChunkView {
+	GLBChunkType		  type;
+	std::span<const char> data;
+};
+
+// Splits a GLB container (.glb, or version 0 scene file) into its chunks, checking that the header and every chunk fit in the file. The magic is checked by the caller.
+static bool readGLBChunks(std::span<const char> file, const std::filesystem::path& path, std::vector<GLBChunkView>& chunks) {
+	if(file.size() < sizeof(GLBHeader)) {
+		error("readGLBChunks: '{}' is too small to be a GLB file.\n", path.string());
+		return false;
 	}
-	if constexpr(std::is_same<T, glm::vec4>()) {
-		assert(Scene::ComponentType(accessor["componentType"].as<int>()) == Scene::ComponentType::Float);
-		assert(accessor["type"].asString() == "VEC4");
+	const GLBHeader header = *reinterpret_cast<const GLBHeader*>(file.data());
+	if(header.length > file.size() || header.length < sizeof(GLBHeader)) {
+		error("readGLBChunks: '{}' is truncated or corrupted (length: {} bytes, file size: {} bytes).\n", path.string(), header.length, file.size());
+		return false;
 	}
-	if constexpr(std::is_same<T, glm::quat>()) {
-		assert(Scene::ComponentType(accessor["componentType"].as<int>()) == Scene::ComponentType::Float);
-		assert(accessor["type"].asString() == "VEC4");
+	size_t offset = sizeof(GLBHeader);
+	while(offset < header.length) {
+		if(header.length - offset < offsetof(GLBChunk, data)) {
+			error("readGLBChunks: Chunk {} of '{}' is truncated (offset {}).\n", chunks.size(), path.string(), offset);
+			return false;
+		}
+		const GLBChunk chunk = *reinterpret_cast<const GLBChunk*>(file.data() + offset);
+		offset += offsetof(GLBChunk, data);
+		if(chunk.length > header.length - offset) {
+			error("readGLBChunks: Chunk {} of '{}' is out-of-bounds (offset {}, length {}).\n", chunks.size(), path.string(), offset, chunk.length);
+			return false;
+		}
+		chunks.push_back({chunk.type, file.subspan(offset, chunk.length)});
+		offset += chunk.length;
 	}
-	const auto& bufferView = object["bufferViews"][accessor["bufferView"].as<int>()];
-	auto		count = accessor["count"].as<int>();
-	const auto& buffer = buffers[bufferView["buffer"].as<int>()];
+	return true;
+}
+
+template<typename T>
+std::vector<T> extract(const GltfAsset& asset, const std::vector<std::span<const char>>& buffers, uint32_t accessorIndex) {
+	const auto& accessor = asset.accessors[accessorIndex];
+	assert(Scene::ComponentType(accessor.componentType) == Scene::ComponentType::Float);
+	if constexpr(std::is_same<T, float>())
+		assert(accessor.type == GltfAccessorType::Scalar);
+	if constexpr(std::is_same<T, glm::vec2>())
+		assert(accessor.type == GltfAccessorType::Vec2);
+	if constexpr(std::is_same<T, glm::vec3>())
+		assert(accessor.type == GltfAccessorType::Vec3);
+	if constexpr(std::is_same<T, glm::vec4>() || std::is_same<T, glm::quat>())
+		assert(accessor.type == GltfAccessorType::Vec4);
+	if constexpr(std::is_same<T, glm::mat4>())
+		assert(accessor.type == GltfAccessorType::Mat4);
+	const auto& bufferView = asset.bufferViews[accessor.bufferView];
+	const auto& buffer = buffers[bufferView.buffer];
 	auto		bufferData = buffer.data();
-	auto		cursor = accessor("byteOffset", 0) + bufferView("byteOffset", 0);
-	int			defaultStride = sizeof(T);
-	auto		stride = bufferView("byteStride", defaultStride);
+	size_t		cursor = accessor.byteOffset + bufferView.byteOffset;
+	size_t		stride = bufferView.byteStride ? bufferView.byteStride : sizeof(T);
 	assert(stride >= sizeof(T));
-	std::vector<T> data;
-	for(int i = 0; i < count; ++i) {
-		data.push_back(*reinterpret_cast<const T*>(bufferData + cursor));
-		cursor += stride;
-	}
+	std::vector<T> data(accessor.count);
+	VertexKernels::copy(data.data(), sizeof(T), bufferData + cursor, stride, sizeof(T), accessor.count);
 	return data;
 }
 
-template<typename T>
-JointIndices extractJoints(const char* data, size_t cursor) {
-	JointIndices ji;
-	for(int i = 0; i < 4; ++i)
-		ji.indices[i] = reinterpret_cast<const T*>(data + cursor)[i];
-	return ji;
-}
+// Decodes the geometry of a glTF primitive into a Mesh.
+// Once allocate() has sized the mesh, decodeVertices (on disjoint ranges) and decodeIndices can run concurrently.
+struct GltfPrimitiveDecoder {
+	// Primitives with more vertices are split into several ranges, decoded independently.
+	static constexpr size_t VertexRangeSize = 64 * 1024;
+
+	struct Attribute {
+		const char*					 data = nullptr; // Start of the first element, nullptr if the attribute is absent
+		size_t						 stride = 0;
+		VertexKernels::ComponentType componentType = VertexKernels::ComponentType::Float;
+		bool						 normalized = false;
+	};
+
+	const GltfAsset&						  asset;
+	const std::vector<std::span<const char>>& buffers;
+	const GltfPrimitive&					  primitive;
+	size_t									  meshIndex;
+	size_t									  vertexCount = 0;
+	Attribute								  position, normal, tangent, texCoord, weights, joints;
+	Scene::ComponentType					  jointsIndexType = Scene::ComponentType::UnsignedShort;
+
+	GltfPrimitiveDecoder(const GltfAsset& asset, const std::vector<std::span<const char>>& buffers, const GltfPrimitive& primitive, size_t meshIndex)
+		: asset(asset), buffers(buffers), primitive(primitive), meshIndex(meshIndex) {}
+
+	Attribute attribute(int32_t accessorIndex, size_t defaultStride, Scene::ComponentType expectedComponentType = Scene::ComponentType::Float,
+						GltfAccessorType expectedType = GltfAccessorType::Vec4) const {
+		if(accessorIndex == -1)
+			return {};
+		const auto& accessor = asset.accessors[accessorIndex];
+		assert(expectedComponentType == Scene::ComponentType::Any || static_cast<Scene::ComponentType>(accessor.componentType) == expectedComponentType);
+		assert(accessor.type == expectedType);
+		const auto& bufferView = asset.bufferViews[accessor.bufferView];
+		return {buffers[bufferView.buffer].data() + accessor.byteOffset + bufferView.byteOffset, bufferView.byteStride ? bufferView.byteStride : defaultStride,
+				static_cast<VertexKernels::ComponentType>(accessor.componentType), accessor.normalized};
+	}
+
+	// Vertex attribute of floats or, with KHR_mesh_quantization, of (normalized or not) 8/16bit integers. Converted to floats while decoding.
+	// Elements of vertex attributes are aligned to 4 bytes, even in tightly packed buffer views.
+	Attribute quantizedAttribute(int32_t accessorIndex, uint32_t components, GltfAccessorType expectedType, bool mustBeNormalized, const char* name) const {
+		if(accessorIndex == -1)
+			return {};
+		const auto& accessor = asset.accessors[accessorIndex];
+		const auto	type = static_cast<VertexKernels::ComponentType>(accessor.componentType);
+		const auto	size = VertexKernels::componentSize(type);
+		if(size == 0 || type == VertexKernels::ComponentType::Int || type == VertexKernels::ComponentType::UnsignedInt ||
+		   (mustBeNormalized && type != VertexKernels::ComponentType::Float && !accessor.normalized)) {
+			error("Error: Unsupported component type {} (normalized: {}) for {}.\n", accessor.componentType, accessor.normalized, name);
+			return {};
+		}
+		return attribute(accessorIndex, (size * components + 3) & ~size_t(3), Scene::ComponentType::Any, expectedType);
+	}
+
+	// Resolves the accessors and sizes the mesh (and its skin data). Returns false if the primitive isn't supported.
+	bool allocate(Mesh& mesh) {
+		const auto& a = primitive.attributes;
+		assert(a.position != -1);
+		const auto& positionAccessor = asset.accessors[a.position];
+		if(positionAccessor.type != GltfAccessorType::Vec3) {
+			error("Error: Unsupported accessor type '{}'.", toString(positionAccessor.type));
+			return false;
+		}
+		vertexCount = positionAccessor.count;
+		position = quantizedAttribute(a.position, 3, GltfAccessorType::Vec3, false, "POSITION");
+		if(!position.data)
+			return false;
+		// Quantized normals, tangents and weights are always normalized (the other combinations are invalid, we just ignore the attribute).
+		normal = quantizedAttribute(a.normal, 3, GltfAccessorType::Vec3, true, "NORMAL");
+		tangent = quantizedAttribute(a.tangent, 4, GltfAccessorType::Vec4, true, "TANGENT");
+		// TODO: Compute tangents if not present in file.
+		texCoord = quantizedAttribute(a.texCoord0, 2, GltfAccessorType::Vec2, false, "TEXCOORD_0");
+		if(a.weights0 != -1) {
+			weights = quantizedAttribute(a.weights0, 4, GltfAccessorType::Vec4, true, "WEIGHTS_0");
+			assert(a.joints0 != -1);
+			jointsIndexType = static_cast<Scene::ComponentType>(asset.accessors[a.joints0].componentType);
+			joints = attribute(a.joints0, 4 * sizeof(JointIndex), Scene::ComponentType::Any);
+		}
+
+		mesh.getVertices().resize(vertexCount);
+		if(weights.data)
+			mesh.setSkinVertexData(SkinVertexData{std::vector<glm::vec4>(vertexCount), std::vector<JointIndices>(vertexCount)});
+		return true;
+	}
+
+	static void decode(float* dst, size_t dstStride, const Attribute& attribute, uint32_t components, size_t begin, size_t count) {
+		VertexKernels::toFloat(dst, dstStride, attribute.data + begin * attribute.stride, attribute.stride, attribute.componentType, components, attribute.normalized,
+							   count);
+	}
+
+	void decodeVertices(Mesh& mesh, size_t begin, size_t end) const {
+		auto*		 vertices = mesh.getVertices().data() + begin;
+		const size_t count = end - begin;
+		decode(&vertices->pos.x, sizeof(Vertex), position, 3, begin, count);
+		if(normal.data)
+			decode(&vertices->normal.x, sizeof(Vertex), normal, 3, begin, count);
+		if(tangent.data) {
+			decode(&vertices->tangent.x, sizeof(Vertex), tangent, 4, begin, count);
+			for(size_t i = 0; i < count; ++i)
+				assert(vertices[i].tangent.w == -1.0f || vertices[i].tangent.w == 1.0f);
+		} else {
+			for(size_t i = 0; i < count; ++i)
+				vertices[i].tangent = glm::vec4(1.0);
+		}
+		if(texCoord.data)
+			decode(&vertices->texCoord.x, sizeof(Vertex), texCoord, 2, begin, count);
+		if(weights.data) {
+			auto& skin = mesh.getSkinVertexData();
+			decode(&skin.weights[begin].x, sizeof(glm::vec4), weights, 4, begin, count);
+			VertexKernels::toU16x4(skin.joints[begin].indices.data(), sizeof(JointIndices), joints.data + begin * joints.stride, joints.stride,
+								   static_cast<VertexKernels::ComponentType>(jointsIndexType), count);
+		}
+	}
+
+	void decodeIndices(Mesh& mesh) const {
+		auto& indices = mesh.getIndices();
+		if(primitive.indices == -1) {
+			// Compute indices ourselves
+			indices.resize(vertexCount);
+			VertexKernels::iota(indices.data(), vertexCount);
+			return;
+		}
+		const auto& indicesAccessor = asset.accessors[primitive.indices];
+		if(indicesAccessor.type != GltfAccessorType::Scalar) {
+			error("Error: Unsupported accessor type '{}'.", toString(indicesAccessor.type));
+			return;
+		}
+		const auto compType = static_cast<Scene::ComponentType>(indicesAccessor.componentType);
+		assert(compType == Scene::ComponentType::UnsignedByte || compType == Scene::ComponentType::UnsignedShort || compType == Scene::ComponentType::UnsignedInt);
+		const auto indicesType = static_cast<VertexKernels::ComponentType>(compType);
+		const auto indicesAttribute = attribute(primitive.indices, VertexKernels::componentSize(indicesType), compType, GltfAccessorType::Scalar);
+		indices.resize(indicesAccessor.count);
+		VertexKernels::widen(indices.data(), indicesAttribute.data, indicesAttribute.stride, indicesType, indicesAccessor.count);
+	}
+
+	void computeBounds(Mesh& mesh) const {
+		if(vertexCount == 0)
+			return;
+		const auto& positionAccessor = asset.accessors[primitive.attributes.position];
+		// min/max of quantized positions are in the quantized space, don't bother converting them.
+		if(position.componentType == VertexKernels::ComponentType::Float && positionAccessor.min.size() == 3 && positionAccessor.max.size() == 3) {
+			mesh.setBounds({
+				.min = glm::vec3{positionAccessor.min[0], positionAccessor.min[1], positionAccessor.min[2]},
+				.max = glm::vec3{positionAccessor.max[0], positionAccessor.max[1], positionAccessor.max[2]},
+			});
+		} else {
+			mesh.computeBounds();
+		}
+		if(!mesh.getBounds().isValid())
+			mesh.computeBounds();
+		assert(mesh.getBounds().isValid());
+	}
+};
 
 bool Scene::loadglTF(const std::filesystem::path& path) {
-	JSON						   json;
-	std::vector<std::vector<char>> buffers;
+	GltfAsset						   asset;
+	MappedFile						   file; // Referenced by json and buffers
+	std::string_view				   json;
+	std::vector<std::span<const char>> buffers;		   // Views into file, externalBuffers or decodedBuffers
+	std::vector<MappedFile>			   externalBuffers; // .bin files referenced by a .gltf
+	std::vector<std::vector<char>>	   decodedBuffers;	// Base64 encoded buffers embedded in a .gltf
+
+	if(!file.open(path, MappedFile::Access::Sequential)) {
+		error("Scene::loadglTf error: Could not open file '{}'.\n", path.string());
+		return false;
+	}
 
 	if(path.extension() == ".gltf") {
-		if(!json.parse(path)) {
+		json = file.view();
+		if(!asset.parse(json)) {
 			error("Scene::loadglTF error: Could not parse '{}'.\n", path.string());
 			return false;
 		}
 		// Load Buffers
-		const auto& obj = json.getRoot(); // FIXME: Assigning a vector::iterator to our JSON::value::iterator union causes a reading violation in _Orphan_me_unlocked_v3 (in debug
-										  // mode only). Maybe I'm doing something terribly wrong, but it looks a lot like a bug in MSVC stblib implementation. Relevant discussion:
-										  // https://stackoverflow.com/questions/32748870/visual-studio-const-iterator-assignment-error, however in this case the crash happens on
-										  // non-singular values (.begin() on a non-empty vector). const_iterator doesn't seem to be affected by this problem, so I'm creating a
-										  // const alias to force its use as a workaround.
-		for(const auto& bufferDesc : obj["buffers"]) {
-			buffers.push_back({});
-			auto&	   buffer = buffers.back();
-			size_t	   length = bufferDesc["byteLength"].as<int>();
-			const auto uri = bufferDesc["uri"].asString();
+		for(const auto& bufferDesc : asset.buffers) {
+			size_t		length = bufferDesc.byteLength;
+			const auto& uri = bufferDesc.uri;
 			if(uri.starts_with("data:")) {
 				// Inlined data
-				if(uri.starts_with("data:application/octet-stream;base64,")) {
-					const auto data = std::string_view(uri).substr(std::string("data:application/octet-stream;base64,").size());
-					buffer = std::move(decodeBase64(data));
+				constexpr std::string_view Base64Marker = ";base64,";
+				const auto				   separator = uri.find(Base64Marker);
+				const auto				   mimeType = std::string_view(uri).substr(5, separator == std::string::npos ? 0 : separator - 5);
+				if(separator != std::string::npos && (mimeType == "application/octet-stream" || mimeType == "application/gltf-buffer")) {
+					const auto data = std::string_view(uri).substr(separator + Base64Marker.size());
+					auto&	   buffer = decodedBuffers.emplace_back(Base64::decodedSize(data));
+					if(!Base64::decode(data, buffer.data())) {
+						error("Scene::loadglTF error: Invalid Base64 data in buffer {} of '{}'.\n", buffers.size(), path.string());
+						return false;
+					}
+					if(buffer.size() < length) {
+						error("Scene::loadglTF error: Buffer {} of '{}' is too small (size: {} bytes, expected {} bytes).\n", buffers.size(), path.string(), buffer.size(), length);
+						return false;
+					}
+					buffers.push_back({buffer.data(), buffer.size()});
 				} else {
 					warn("Scene::loadglTF: Unsupported data format ('{}'...)\n", uri.substr(0, 64));
 					return false;
 				}
 			} else {
 				// Load from file
-				auto		  filepath = path.parent_path() / uri;
-				std::ifstream buffer_file{filepath, std::ifstream::binary};
-				if(buffer_file) {
-					buffer.resize(length);
-					if(!buffer_file.read(buffer.data(), length)) {
-						error("Error while reading '{}' (rdstate: {}, size: {} bytes).\n", filepath, buffer_file.rdstate(), length);
-						return false;
-					}
-				} else {
+				auto		filepath = path.parent_path() / uri;
+				auto&		buffer = externalBuffers.emplace_back();
+				if(!buffer.open(filepath)) {
 					error("Could not open '{}'.", filepath);
 					return false;
 				}
+				if(buffer.size() < length) {
+					error("Error while reading '{}' (size: {} bytes, expected {} bytes).\n", filepath, buffer.size(), length);
+					return false;
+				}
+				buffers.push_back(buffer.span().first(length));
 			}
 		}
 	} else if(path.extension() == ".glb") {
-		std::ifstream file(path, std::ios::binary | std::ios::ate);
-		if(!file) {
-			error("Scene::loadglTf error: Could not open file '{}'.\n", path.string());
+		std::vector<GLBChunkView> chunks;
+		if(!readGLBChunks(file.span(), path, chunks))
+			return false;
+		if(const auto magic = reinterpret_cast<const GLBHeader*>(file.data())->magic; magic != 0x46546C67) {
+			error("Scene::loadglTF error: '{}' is not a GLB file (magic: {:#x}).\n", path.string(), magic);
 			return false;
 		}
-		std::streamsize size = file.tellg();
-		file.seekg(0, std::ios::beg);
-
-		std::vector<char> buffer(size);
-		if(file.read(buffer.data(), size)) {
-			GLBHeader header = *reinterpret_cast<GLBHeader*>(buffer.data());
-			assert(header.magic == 0x46546C67);
-			GLBChunk jsonChunk = *reinterpret_cast<GLBChunk*>(buffer.data() + sizeof(GLBHeader));
-			assert(jsonChunk.type == GLBChunkType::JSON);
-			jsonChunk.data = buffer.data() + sizeof(GLBHeader) + offsetof(GLBChunk, data);
-			if(!json.parse(jsonChunk.data, jsonChunk.length)) {
-				error("Scene::loadglTF: GLB ('{}') JSON chunk could not be parsed.\n", path.string());
+		if(chunks.empty() || chunks[0].type != GLBChunkType::JSON) {
+			error("Scene::loadglTF error: The first chunk of '{}' is not a JSON chunk.\n", path.string());
+			return false;
+		}
+		json = std::string_view{chunks[0].data.data(), chunks[0].data.size()};
+		if(!asset.parse(json)) {
+			error("Scene::loadglTF: GLB ('{}') JSON chunk could not be parsed.\n", path.string());
+			return false;
+		}
+		// BIN chunks are used in place, straight from the mapping.
+		for(size_t i = 1; i < chunks.size(); ++i) {
+			if(chunks[i].type != GLBChunkType::BIN) {
+				error("Scene::loadglTF error: Unexpected chunk type {:#x} in '{}' (chunk {}).\n", static_cast<uint32_t>(chunks[i].type), path.string(), i);
 				return false;
 			}
-			char* offset = buffer.data() + sizeof(GLBHeader) + offsetof(GLBChunk, data) + jsonChunk.length;
-			while(offset - buffer.data() < header.length) {
-				GLBChunk chunk = *reinterpret_cast<GLBChunk*>(offset);
-				assert(chunk.type == GLBChunkType::BIN);
-				chunk.data = offset + offsetof(GLBChunk, data);
-				offset += offsetof(GLBChunk, data) + chunk.length;
-				buffers.emplace_back().assign(chunk.data, chunk.data + chunk.length);
-			}
+			buffers.push_back(chunks[i].data);
 		}
 	} else {
 		warn("Scene::loadglTF: Extension '{}' not supported (filepath: '{}').", path.extension(), path.string());
 		return false;
 	}
-	const auto& object = json.getRoot();
+	for(const auto& extension : asset.extensionsRequired)
+		if(extension != "KHR_mesh_quantization")
+			warn("Scene::loadglTF: Required extension '{}' is not supported, '{}' may not be displayed correctly.\n", extension, path.string());
+	// Materials and textures: Lazily parsed document, only the parts actually used are materialized (the geometry and animations have already been read).
+	JSON::Document resources;
+	if(!resources.parse(json, JSON::Document::ParseOptions{.lazy = true})) {
+		error("Scene::loadglTF error: Could not parse materials of '{}'.\n", path.string());
+		return false;
+	}
+	const auto& object = resources.getRoot();
+	// Malformed parts are only detected when materialized: Check them all before modifying the scene. The document is then only read.
+	for(const auto key : {"images", "samplers", "textures", "materials"})
+		if(auto node = object.find(key); resources.hasError() || (node && !node->materialize())) {
+			error("Scene::loadglTF error: Invalid '{}' in '{}'.\n", key, path.string());
+			return false;
+		}
 
-	const auto textureOffset = static_cast<uint32_t>(Textures.size());
+	const auto textureOffset = static_cast<uint32_t>(_textures->size());
 
 	loadTextures(path, object);
 
-	const auto materialOffset = Materials.size();
+	const auto materialOffset = _materials->size();
 
 	if(object.contains("materials"))
 		for(const auto& mat : object["materials"])
@@ -206,213 +414,76 @@ bool Scene::loadglTF(const std::filesystem::path& path) {
 
 	std::vector<std::vector<MeshIndex>> gltfIndexToMeshIndices;
 
-	for(const auto& m : object["meshes"]) {
-		auto baseName = m("name", std::string("UnamedMesh"));
+	// Meshes are created serially (preserving the order of the primitives), their geometry is then decoded in parallel: Each task writes to its own, pre-sized,
+	// part of a mesh, so the result doesn't depend on scheduling.
+	std::vector<GltfPrimitiveDecoder> decoders;
+	const size_t					  firstMesh = _meshes.size();
+	for(const auto& m : asset.meshes) {
+		auto baseName = m.name.empty() ? std::string("UnamedMesh") : m.name;
 		gltfIndexToMeshIndices.emplace_back();
-		for(const auto& p : m["primitives"]) {
+		for(const auto& p : m.primitives) {
 			gltfIndexToMeshIndices.back().push_back(MeshIndex(_meshes.size()));
 			auto& mesh = _meshes.emplace_back();
-			mesh.name = baseName + "_" + p("name", std::string("Unamed"));
-			if(p.asObject().contains("material")) {
-				mesh.defaultMaterialIndex.value = materialOffset + p["material"].as<int>();
-			}
-
-			if(p.contains("mode"))
-				assert(p["mode"].as<int>() == 4); // We only supports triangles
-			const auto& positionAccessor = object["accessors"][p["attributes"]["POSITION"].as<int>()];
-			const auto& positionBufferView = object["bufferViews"][positionAccessor["bufferView"].as<int>()];
-			const auto& positionBuffer = buffers[positionBufferView["buffer"].as<int>()];
-
-			auto initAccessor = [&](const std::string& name, const char** bufferData, size_t* cursor, size_t* stride, const int defaultStride = 4 * sizeof(float),
-									ComponentType expectedComponentType = ComponentType::Float, const std::string& expectedType = "VEC4") {
-				const auto& accessor = object["accessors"][p["attributes"][name].as<int>()];
-				assert(expectedComponentType == ComponentType::Any || static_cast<ComponentType>(accessor["componentType"].as<int>()) == expectedComponentType);
-				assert(accessor["type"].as<std::string>() == expectedType);
-				const auto& bufferView = object["bufferViews"][accessor["bufferView"].as<int>()];
-				const auto& buffer = buffers[bufferView["buffer"].as<int>()];
-				*bufferData = buffer.data();
-				*cursor = accessor("byteOffset", 0) + bufferView("byteOffset", 0);
-				*stride = bufferView("byteStride", defaultStride);
-			};
-
-			const char* normalBufferData = nullptr;
-			size_t		normalCursor = 0;
-			size_t		normalStride = 0;
-			if(p["attributes"].contains("NORMAL"))
-				initAccessor("NORMAL", &normalBufferData, &normalCursor, &normalStride, sizeof(glm::vec3), ComponentType::Float, "VEC3");
-
-			const char* tangentBufferData = nullptr;
-			size_t		tangentCursor = 0;
-			size_t		tangentStride = 0;
-			if(p["attributes"].contains("TANGENT"))
-				initAccessor("TANGENT", &tangentBufferData, &tangentCursor, &tangentStride);
-			// TODO: Compute tangents if not present in file.
-
-			const char* texCoordBufferData = nullptr;
-			size_t		texCoordCursor = 0;
-			size_t		texCoordStride = 0;
-			if(p["attributes"].contains("TEXCOORD_0"))
-				initAccessor("TEXCOORD_0", &texCoordBufferData, &texCoordCursor, &texCoordStride, 2 * sizeof(float), ComponentType::Float, "VEC2");
-
-			bool		skinnedMesh = p["attributes"].contains("WEIGHTS_0");
-			const char* weightsBufferData = nullptr;
-			size_t		weightsCursor = 0;
-			size_t		weightsStride = 0;
-			const char* jointsBufferData = nullptr;
-			size_t		jointsCursor = 0;
-			size_t		jointsStride = 0;
-
-			ComponentType jointsIndexType = ComponentType::UnsignedShort;
-			if(skinnedMesh) {
-				initAccessor("WEIGHTS_0", &weightsBufferData, &weightsCursor, &weightsStride);
-				assert(p["attributes"].contains("JOINTS_0"));
-				jointsIndexType = static_cast<ComponentType>(object["accessors"][p["attributes"]["JOINTS_0"].as<int>()]["componentType"].as<int>());
-				initAccessor("JOINTS_0", &jointsBufferData, &jointsCursor, &jointsStride, 4 * sizeof(JointIndex), ComponentType::Any);
-			}
-			std::vector<glm::vec4>	  weights;
-			std::vector<JointIndices> joints;
-
-			if(positionAccessor["type"].asString() == "VEC3") {
-				assert(static_cast<ComponentType>(positionAccessor["componentType"].as<int>()) == ComponentType::Float); // TODO
-				size_t positionCursor = positionAccessor("byteOffset", 0) + positionBufferView("byteOffset", 0);
-				size_t positionStride = positionBufferView("byteStride", static_cast<int>(3 * sizeof(float)));
-
-				mesh.getVertices().reserve(positionAccessor["count"].as<int>());
-				for(size_t i = 0; i < positionAccessor["count"].as<int>(); ++i) {
-					Vertex v{glm::vec3{0.0, 0.0, 0.0}, glm::vec3{1.0, 1.0, 1.0}};
-					v.pos = *reinterpret_cast<const glm::vec3*>(positionBuffer.data() + positionCursor);
-					positionCursor += positionStride;
-
-					if(normalBufferData) {
-						v.normal = *reinterpret_cast<const glm::vec3*>(normalBufferData + normalCursor);
-						normalCursor += normalStride;
-					}
-
-					if(tangentBufferData) {
-						v.tangent = *reinterpret_cast<const glm::vec4*>(tangentBufferData + tangentCursor);
-						assert(v.tangent.w == -1.0f || v.tangent.w == 1.0f);
-						tangentCursor += tangentStride;
-					} else
-						v.tangent = glm::vec4(1.0);
-
-					if(texCoordBufferData) {
-						v.texCoord = *reinterpret_cast<const glm::vec2*>(texCoordBufferData + texCoordCursor);
-						texCoordCursor += texCoordStride;
-					}
-
-					if(skinnedMesh) {
-						weights.push_back(*reinterpret_cast<const glm::vec4*>(weightsBufferData + weightsCursor));
-						weightsCursor += weightsStride;
-						if(jointsIndexType != ComponentType::UnsignedShort) {
-							switch(jointsIndexType) {
-								case ComponentType::Byte: joints.push_back(extractJoints<int8_t>(jointsBufferData, jointsCursor)); break;
-								case ComponentType::UnsignedByte: joints.push_back(extractJoints<uint8_t>(jointsBufferData, jointsCursor)); break;
-								case ComponentType::Short: joints.push_back(extractJoints<int16_t>(jointsBufferData, jointsCursor)); break;
-								case ComponentType::Int: joints.push_back(extractJoints<int32_t>(jointsBufferData, jointsCursor)); break;
-								case ComponentType::UnsignedInt: joints.push_back(extractJoints<uint32_t>(jointsBufferData, jointsCursor)); break;
-							}
-						} else
-							joints.push_back(*reinterpret_cast<const JointIndices*>(jointsBufferData + jointsCursor));
-						jointsCursor += jointsStride;
-					}
-
-					mesh.getVertices().push_back(v);
-				}
-			} else {
-				error("Error: Unsupported accessor type '{}'.", positionAccessor["type"].asString());
+			mesh.name = baseName + "_" + (p.name.empty() ? std::string("Unamed") : p.name);
+			if(p.material != -1) {
+				mesh.defaultMaterialIndex.value = materialOffset + p.material;
 			}
+			assert(p.mode == 4); // We only supports triangles
+			decoders.emplace_back(asset, buffers, p, _meshes.size() - 1);
+		}
+	}
 
-			if(skinnedMesh)
-				mesh.setSkinVertexData(SkinVertexData{weights, joints});
-
-			if(positionAccessor.contains("min") && positionAccessor.contains("max")) {
-				mesh.setBounds({
-					.min = positionAccessor["min"].to<glm::vec3>(),
-					.max = positionAccessor["max"].to<glm::vec3>(),
-				});
-			} else {
-				mesh.computeBounds();
-			}
-			if(!mesh.getBounds().isValid())
-				mesh.computeBounds();
-			assert(mesh.getBounds().isValid());
-
-			if(p.contains("indices")) {
-				const auto& indicesAccessor = object["accessors"][p["indices"].as<int>()];
-				const auto& indicesBufferView = object["bufferViews"][indicesAccessor["bufferView"].as<int>()];
-				const auto& indicesBuffer = buffers[indicesBufferView["buffer"].as<int>()];
-				if(indicesAccessor["type"].asString() == "SCALAR") {
-					ComponentType compType = static_cast<ComponentType>(indicesAccessor["componentType"].as<int>());
-					assert(compType == ComponentType::UnsignedShort || compType == ComponentType::UnsignedInt); // TODO
-					size_t cursor = indicesAccessor("byteOffset", 0) + indicesBufferView("byteOffset", 0);
-					int	   defaultStride = 0;
-					switch(compType) {
-						case ComponentType::UnsignedShort: defaultStride = sizeof(unsigned short); break;
-						case ComponentType::UnsignedInt: defaultStride = sizeof(unsigned int); break;
-						default: assert(false);
-					}
-					size_t stride = indicesBufferView("byteStride", defaultStride);
-					mesh.getIndices().reserve(indicesAccessor["count"].as<int>());
-					for(size_t i = 0; i < indicesAccessor["count"].as<int>(); ++i) {
-						uint32_t idx = 0;
-						switch(compType) {
-							case ComponentType::UnsignedShort: idx = *reinterpret_cast<const unsigned short*>(indicesBuffer.data() + cursor); break;
-							case ComponentType::UnsignedInt: idx = *reinterpret_cast<const unsigned int*>(indicesBuffer.data() + cursor); break;
-							default: assert(false);
-						}
-						mesh.getIndices().push_back(idx);
-						cursor += stride;
-					}
-
-				} else {
-					error("Error: Unsupported accessor type '{}'.", indicesAccessor["type"].asString());
-				}
-			} else {
-				// Compute indices ourselves
-				mesh.getIndices().reserve(mesh.getVertices().size() / 3);
-				for(size_t i = 0; i < mesh.getVertices().size(); i += 3) {
-					mesh.getIndices().push_back(i + 0);
-					mesh.getIndices().push_back(i + 1);
-					mesh.getIndices().push_back(i + 2);
-				}
-			}
+	{
+		ThreadPool::TaskQueue tasks;
+		for(auto& d : decoders) {
+			auto& mesh = _meshes[d.meshIndex];
+			if(!d.allocate(mesh))
+				continue;
+			for(size_t begin = 0; begin < d.vertexCount; begin += GltfPrimitiveDecoder::VertexRangeSize)
+				tasks.start([&d, &mesh, begin]() { d.decodeVertices(mesh, begin, std::min(begin + GltfPrimitiveDecoder::VertexRangeSize, d.vertexCount)); });
+			tasks.start([&d, &mesh]() { d.decodeIndices(mesh); });
 		}
 	}
+	{
+		// Bounds depend on the complete set of vertices.
+		ThreadPool::TaskQueue tasks;
+		for(auto& d : decoders)
+			tasks.start([&d, this]() { d.computeBounds(_meshes[d.meshIndex]); });
+	}
 
 	std::vector<entt::entity>	  entities;
 	std::vector<std::vector<int>> entitiesChildren;
-	entities.reserve(object["nodes"].asArray().size());
-	entitiesChildren.reserve(object["nodes"].asArray().size());
+	entities.reserve(asset.nodes.size());
+	entitiesChildren.reserve(asset.nodes.size());
+	HierarchyBuilder			  hierarchy(*this);
 
-	for(const auto& node : object["nodes"]) {
+	for(const auto& node : asset.nodes) {
 		auto entity = _registry.create();
 		entities.push_back(entity);
 		entitiesChildren.emplace_back();
 		auto& n = _registry.emplace<NodeComponent>(entity);
-		n.name = node("name", std::string("Unamed Node"));
-		if(node.contains("matrix")) {
-			n.transform = node["matrix"].to<glm::mat4>();
+		n.name = node.name.empty() ? std::string("Unamed Node") : node.name;
+		if(node.matrix) {
+			n.transform = *node.matrix;
 		} else {
-			auto scale = glm::scale(glm::mat4(1.0f), node.get("scale", glm::vec3(1.0)));
-			auto rotation = glm::toMat4(node.get("rotation", glm::quat(1, 0, 0, 0)));
-			auto translation = glm::translate(glm::mat4(1.0f), node.get("translation", glm::vec3(0.0f)));
+			auto scale = glm::scale(glm::mat4(1.0f), node.scale);
+			auto rotation = glm::toMat4(node.rotation);
+			auto translation = glm::translate(glm::mat4(1.0f), node.translation);
 			n.transform = translation * rotation * scale;
 		}
 
-		if(node.contains("children"))
-			for(const auto& c : node["children"])
-				entitiesChildren.back().push_back(c.as<int>());
+		entitiesChildren.back().assign(node.children.begin(), node.children.end());
 
-		auto meshIndex = node("mesh", -1);
+		auto meshIndex = node.mesh;
 		if(meshIndex != -1) {
 			const auto& indices = gltfIndexToMeshIndices[meshIndex];
 			auto		addRenderer = [&](entt::entity entity, MeshIndex meshIndex) {
 				   if(getMeshes()[meshIndex].isSkinned()) {
-					   assert(node.contains("skin"));
+					   assert(node.skin != -1);
 					   _registry.emplace<SkinnedMeshRendererComponent>(entity, SkinnedMeshRendererComponent{
 																					   .meshIndex = MeshIndex(meshIndex),
 																					   .materialIndex = getMeshes()[meshIndex].defaultMaterialIndex,
-																					   .skinIndex = SkinIndex(node["skin"].as<int>() + _skins.size()),
+																					   .skinIndex = SkinIndex(node.skin + _skins.size()),
 																			   });
 				   } else
 					   _registry.emplace<MeshRendererComponent>(entity, MeshRendererComponent{
@@ -427,221 +498,329 @@ bool Scene::loadglTF(const std::filesystem::path& path) {
 			else {
 				for(const auto& idx : indices) {
 					auto  submesh = _registry.create();
-					auto& submeshNode = _registry.emplace<NodeComponent>(submesh);
-					addChild(entity, submesh);
+					_registry.emplace<NodeComponent>(submesh);
+					hierarchy.addChild(entity, submesh);
 					addRenderer(submesh, MeshIndex{idx});
 				}
 			}
 		}
 	}
 
-	for(const auto& scene : object["scenes"]) {
+	for(const auto& scene : asset.scenes) {
 		auto entity = _registry.create();
 		entities.push_back(entity);
 		entitiesChildren.emplace_back();
 		auto& node = _registry.emplace<NodeComponent>(entity);
-		addChild(_root, entity);
-		node.name = scene("name", std::string("Unamed Scene"));
-		if(scene.contains("nodes"))
-			for(const auto& n : scene["nodes"])
-				entitiesChildren.back().push_back(n.as<int>());
+		hierarchy.addChild(_root, entity);
+		node.name = scene.name.empty() ? std::string("Unamed Scene") : scene.name;
+		entitiesChildren.back().assign(scene.nodes.begin(), scene.nodes.end());
 	}
 
 	// Update nodes relationships now that they're all available
-	for(size_t entityIndex = 0; entityIndex < entitiesChildren.size(); ++entityIndex) {
-		for(const auto& childIdx : entitiesChildren[entityIndex])
-			addChild(entities[entityIndex], entities[childIdx]);
+	for(size_t entityIndex = 0; entityIndex < entitiesChildren.size(); ++entityIndex)
+		hierarchy.addChildren<int>(entities[entityIndex], entitiesChildren[entityIndex], entities);
+
+	for(const auto& skin : asset.skins) {
+		std::vector<glm::mat4>	  inverseBindMatrices = extract<glm::mat4>(asset, buffers, skin.inverseBindMatrices);
+		std::vector<entt::entity> joints;
+		for(const auto& nodeIndex : skin.joints)
+			joints.push_back(entities[nodeIndex]);
+		_skins.push_back({inverseBindMatrices, joints});
 	}
 
-	if(object.contains("skins"))
-		for(const auto& skin : object["skins"]) {
-			std::vector<glm::mat4>	  inverseBindMatrices = extract<glm::mat4>(object, buffers, skin["inverseBindMatrices"].as<int>());
-			std::vector<entt::entity> joints;
-			for(const auto& nodeIndex : skin["joints"])
-				joints.push_back(entities[nodeIndex.as<int>()]);
-			_skins.push_back({inverseBindMatrices, joints});
-		}
-
-	if(object.contains("animations"))
-		for(const auto& anim : object["animations"]) {
-			SkeletalAnimationClip animation;
-			entt::entity		  rootNode = entt::null;
-			for(const auto& channel : anim["channels"]) {
-				auto node = entities[channel["target"]["node"].as<int>()];
-				if(rootNode == entt::null || isAncestor(node, rootNode))
-					rootNode = node;
-				auto  path = SkeletalAnimationClip::parsePath(channel["target"]["path"].asString());
-				auto& sampler = anim["samplers"][channel["sampler"].as<int>()];
-				auto  input = extract<float>(object, buffers, sampler["input"].as<int>());
-				auto& nodeAnim = animation.nodeAnimations[node];
-				nodeAnim.entity = node;
-				auto interpolation = sampler.contains("interpolation") ? SkeletalAnimationClip::parseInterpolation(sampler["interpolation"].asString())
-																	   : SkeletalAnimationClip::Interpolation::Linear;
-				switch(path) {
-					case SkeletalAnimationClip::Path::Translation: {
-						nodeAnim.translationKeyFrames.interpolation = interpolation;
-						assert(object["accessors"][sampler["output"].as<int>()]["type"].asString() == "VEC3");
-						auto output = extract<glm::vec3>(object, buffers, sampler["output"].as<int>());
-						for(int i = 0; i < input.size(); ++i)
-							nodeAnim.translationKeyFrames.add(input[i], output[i]);
-						break;
-					}
-					case SkeletalAnimationClip::Path::Rotation: {
-						nodeAnim.rotationKeyFrames.interpolation = interpolation;
-						assert(object["accessors"][sampler["output"].as<int>()]["type"].asString() == "VEC4");
-						auto output = extract<glm::quat>(object, buffers, sampler["output"].as<int>()); // FIXME: quats are probably not in the expected format
-						for(int i = 0; i < input.size(); ++i)
-							nodeAnim.rotationKeyFrames.add(input[i], output[i]);
-						break;
-					}
-					case SkeletalAnimationClip::Path::Scale: {
-						nodeAnim.scaleKeyFrames.interpolation = interpolation;
-						assert(object["accessors"][sampler["output"].as<int>()]["type"].asString() == "VEC3");
-						auto output = extract<glm::vec3>(object, buffers, sampler["output"].as<int>());
-						for(int i = 0; i < input.size(); ++i)
-							nodeAnim.scaleKeyFrames.add(input[i], output[i]);
-						break;
-					}
-					case SkeletalAnimationClip::Path::Weights: {
-						nodeAnim.weightsKeyFrames.interpolation = interpolation;
-						if(object["accessors"][sampler["output"].as<int>()]["type"].asString() != "VEC4") {
-							warn("Ignoring SkeletalAnimation::Path::Weights of type '{}' (expected 'VEC4').\n",
-								 object["accessors"][sampler["output"].as<int>()]["type"].asString());
-							break;
-						}
-						auto output = extract<glm::vec4>(object, buffers, sampler["output"].as<int>());
-						for(int i = 0; i < input.size(); ++i)
-							nodeAnim.weightsKeyFrames.add(input[i], output[i]);
+	for(const auto& anim : asset.animations) {
+		SkeletalAnimationClip animation;
+		entt::entity		  rootNode = entt::null;
+		for(const auto& channel : anim.channels) {
+			auto node = entities[channel.target.node];
+			if(rootNode == entt::null || isAncestor(node, rootNode))
+				rootNode = node;
+			auto  path = channel.target.path;
+			auto& sampler = anim.samplers[channel.sampler];
+			auto  input = extract<float>(asset, buffers, sampler.input);
+			auto& nodeAnim = animation.nodeAnimations[node];
+			nodeAnim.entity = node;
+			auto interpolation = sampler.interpolation;
+			switch(path) {
+				case SkeletalAnimationClip::Path::Translation: {
+					nodeAnim.translationKeyFrames.interpolation = interpolation;
+					assert(asset.accessors[sampler.output].type == GltfAccessorType::Vec3);
+					auto output = extract<glm::vec3>(asset, buffers, sampler.output);
+					for(int i = 0; i < input.size(); ++i)
+						nodeAnim.translationKeyFrames.add(input[i], output[i]);
+					break;
+				}
+				case SkeletalAnimationClip::Path::Rotation: {
+					nodeAnim.rotationKeyFrames.interpolation = interpolation;
+					assert(asset.accessors[sampler.output].type == GltfAccessorType::Vec4);
+					auto output = extract<glm::quat>(asset, buffers, sampler.output); // FIXME: quats are probably not in the expected format
+					for(int i = 0; i < input.size(); ++i)
+						nodeAnim.rotationKeyFrames.add(input[i], output[i]);
+					break;
+				}
+				case SkeletalAnimationClip::Path::Scale: {
+					nodeAnim.scaleKeyFrames.interpolation = interpolation;
+					assert(asset.accessors[sampler.output].type == GltfAccessorType::Vec3);
+					auto output = extract<glm::vec3>(asset, buffers, sampler.output);
+					for(int i = 0; i < input.size(); ++i)
+						nodeAnim.scaleKeyFrames.add(input[i], output[i]);
+					break;
+				}
+				case SkeletalAnimationClip::Path::Weights: {
+					nodeAnim.weightsKeyFrames.interpolation = interpolation;
+					if(asset.accessors[sampler.output].type != GltfAccessorType::Vec4) {
+						warn("Ignoring SkeletalAnimation::Path::Weights of type '{}' (expected 'VEC4').\n", toString(asset.accessors[sampler.output].type));
 						break;
 					}
+					auto output = extract<glm::vec4>(asset, buffers, sampler.output);
+					for(int i = 0; i < input.size(); ++i)
+						nodeAnim.weightsKeyFrames.add(input[i], output[i]);
+					break;
 				}
 			}
-			if(rootNode != entt::null) {
-				if(!_registry.try_get<AnimationComponent>(rootNode)) {
-					auto& animComp = _registry.emplace<AnimationComponent>(rootNode);
-					animComp.animationIndex = AnimationIndex(Animations.size());
-				}
+		}
+		if(rootNode != entt::null) {
+			if(!_registry.try_get<AnimationComponent>(rootNode)) {
+				auto& animComp = _registry.emplace<AnimationComponent>(rootNode);
+				animComp.animationIndex = AnimationIndex(_animations->size());
 			}
-			Animations.push_back(animation);
 		}
+		_animations->push_back(animation);
+	}
 
-	computeBounds();  // FIXME?
-	markDirty(_root); // Also probably unnecessary
+	// Optimization reorders the vertices and indices: It comes first so that the registered hashes are the ones of the final content, which later imports
+	// (and loadScene) compare against.
+	if(optimizeImportedMeshes)
+		optimizeMeshes(firstMesh);
+	// After the creation of the renderers: Duplicates keep their own material.
+	if(deduplicateImportedMeshes)
+		deduplicateMeshes(firstMesh);
+
+	hierarchy.finish(sortImportedNodes);
+	computeBounds(); // FIXME?
 
 	return true;
 }
 
+// Builds a mesh from a range of triangles of an OBJ file: Corners sharing the same (position, texCoord, normal) triplet become a single vertex.
+// Returns the number of triangles dropped because they referenced an undefined position.
+static size_t buildOBJMesh(const OBJ::Data& data, size_t firstTriangle, size_t triangleCount, Mesh& mesh) {
+	struct CornerHash {
+		size_t operator()(const OBJ::Corner& c) const { return static_cast<size_t>(hash64(&c, sizeof(c))); }
+	};
+	std::unordered_map<OBJ::Corner, uint32_t, CornerHash> vertexIndices;
+	vertexIndices.reserve(triangleCount);
+
+	auto& vertices = mesh.getVertices();
+	auto& indices = mesh.getIndices();
+	indices.reserve(3 * triangleCount);
+	bool   authoredNormals = true;
+	size_t invalidTriangles = 0;
+	for(size_t t = firstTriangle; t < firstTriangle + triangleCount; ++t) {
+		const auto* triangle = &data.corners[3 * t];
+		if(triangle[0].position >= data.positions.size() || triangle[1].position >= data.positions.size() || triangle[2].position >= data.positions.size()) {
+			++invalidTriangles;
+			continue;
+		}
+		for(size_t i = 0; i < 3; ++i) {
+			auto c = triangle[i];
+			if(c.texCoord >= data.texCoords.size())
+				c.texCoord = OBJ::InvalidIndex;
+			if(c.normal >= data.normals.size())
+				c.normal = OBJ::InvalidIndex;
+			const auto [it, inserted] = vertexIndices.try_emplace(c, static_cast<uint32_t>(vertices.size()));
+			if(inserted) {
+				Vertex v{.pos = data.positions[c.position], .normal = glm::vec3{0.0f}, .tangent = glm::vec4{0.0f}, .texCoord = glm::vec2{0.0f}};
+				if(c.texCoord != OBJ::InvalidIndex) // OBJ texture coordinates have their origin at the bottom left
+					v.texCoord = glm::vec2{data.texCoords[c.texCoord].x, 1.0f - data.texCoords[c.texCoord].y};
+				if(c.normal != OBJ::InvalidIndex)
+					v.normal = glm::normalize(data.normals[c.normal]);
+				else
+					authoredNormals = false;
+				vertices.push_back(v);
+			}
+			indices.push_back(it->second);
+		}
+	}
+
+	// computeVertexNormals also generates the tangents: Keep the authored normals if all vertices have one.
+	std::vector<glm::vec3> normals;
+	if(authoredNormals) {
+		normals.reserve(vertices.size());
+		for(const auto& v : vertices)
+			normals.push_back(v.normal);
+	}
+	mesh.computeVertexNormals();
+	if(authoredNormals)
+		for(size_t i = 0; i < vertices.size(); ++i)
+			vertices[i].normal = normals[i];
+	mesh.computeBounds();
+	return invalidTriangles;
+}
+
 bool Scene::loadOBJ(const std::filesystem::path& path) {
-	std::ifstream file{path};
-	if(!file) {
+	QuickTimer qt(fmt::format("Loading OBJ '{}'", path.string()));
+	MappedFile file;
+	if(!file.open(path, MappedFile::Access::Sequential)) {
 		error("Scene::loadOBJ Error: Couldn't open '{}'.\n", path);
 		return false;
 	}
+	OBJ::Data data;
+	OBJ::parse(file.view(), data);
+	file.close();
+	if(data.unsupportedLines > 0)
+		warn("Scene::loadOBJ: Ignored {} lines with unsupported statements in '{}'.\n", data.unsupportedLines, path.string());
+	if(data.invalidFaces > 0)
+		warn("Scene::loadOBJ: Ignored {} faces with less than 3 vertices in '{}'.\n", data.invalidFaces, path.string());
+
+	// Hierarchy: Root -> Objects ('o') -> One node per non-empty group ('g'), each with its own mesh.
+	HierarchyBuilder hierarchy(*this);
+	auto			 rootEntity = _registry.create();
+	_registry.emplace<NodeComponent>(rootEntity).name = path.stem().string();
+	hierarchy.addChild(_root, rootEntity);
+
+	struct MeshRange {
+		MeshIndex mesh;
+		size_t	  firstTriangle;
+		size_t	  triangleCount;
+	};
+	std::vector<MeshRange> ranges;
+	const size_t		   firstMesh = _meshes.size();
+	const size_t		   triangleCount = data.corners.size() / 3;
+	entt::entity		   objectEntity = entt::null;
+	std::string			   objectName = path.stem().string();
+	// Triangles before the first statement belong to an implicit group
+	for(size_t g = 0; g <= data.groups.size(); ++g) {
+		const auto* group = g > 0 ? &data.groups[g - 1] : nullptr;
+		if(group && group->object) {
+			objectEntity = entt::null;
+			objectName = group->name;
+		}
+		const size_t first = group ? group->firstTriangle : 0;
+		const size_t count = (g < data.groups.size() ? data.groups[g].firstTriangle : triangleCount) - first;
+		if(count == 0)
+			continue;
+		if(objectEntity == entt::null) {
+			objectEntity = _registry.create();
+			_registry.emplace<NodeComponent>(objectEntity).name = objectName;
+			hierarchy.addChild(rootEntity, objectEntity);
+		}
+		const auto name = group && !group->object ? group->name : objectName;
+		auto	   entity = _registry.create();
+		_registry.emplace<NodeComponent>(entity).name = name;
+		hierarchy.addChild(objectEntity, entity);
+		ranges.push_back({MeshIndex{static_cast<uint32_t>(_meshes.size())}, first, count});
+		_meshes.emplace_back().name = name;
+		_registry.emplace<MeshRendererComponent>(entity, ranges.back().mesh);
+	}
 
-	entt::entity meshEntity = entt::null;
-	entt::entity sm = entt::null;
-	Mesh*		 m = nullptr;
-
-	auto  rootEntity = _registry.create();
-	auto& n = _registry.emplace<NodeComponent>(rootEntity);
-	addChild(_root, rootEntity);
-
-	std::vector<glm::vec2> uvs;
-	std::vector<glm::vec3> normals;
-	uint32_t			   vertexOffset = 0;
+	std::vector<size_t> invalidTriangles(ranges.size(), 0);
+	{
+		ThreadPool::TaskQueue tasks;
+		for(size_t i = 0; i < ranges.size(); ++i)
+			tasks.start([&, i]() { invalidTriangles[i] = buildOBJMesh(data, ranges[i].firstTriangle, ranges[i].triangleCount, _meshes[ranges[i].mesh]); });
+	}
+	if(const auto invalid = std::accumulate(invalidTriangles.begin(), invalidTriangles.end(), size_t{0}); invalid > 0)
+		warn("Scene::loadOBJ: Ignored {} triangles referencing undefined vertices in '{}'.\n", invalid, path.string());
+
+	if(optimizeImportedMeshes) // Before the deduplication, see loadglTF
+		optimizeMeshes(firstMesh);
+	if(deduplicateImportedMeshes)
+		deduplicateMeshes(firstMesh);
+	hierarchy.finish(sortImportedNodes);
+	computeBounds(); // Like loadglTF (and the asynchronous loads): The scene bounds would be left stale otherwise
+	return true;
+}
 
-	const auto nextMesh = [&]() {
-		meshEntity = _registry.create();
-		_registry.emplace<NodeComponent>(meshEntity);
-		addChild(rootEntity, meshEntity);
-	};
-	const auto nextSubMesh = [&]() {
-		if(m)
-			vertexOffset += static_cast<uint32_t>(m->getVertices().size());
-		m = &_meshes.emplace_back();
-		auto submeshEntity = _registry.create();
-		_registry.emplace<NodeComponent>(submeshEntity);
-		addChild(meshEntity, submeshEntity);
-		_registry.emplace<MeshRendererComponent>(submeshEntity, MeshIndex{static_cast<MeshIndex>(_meshes.size() - 1)});
-	};
+std::vector<uint64_t> Scene::computeMeshHashes(size_t firstMesh) const {
+	std::vector<uint64_t> hashes(_meshes.size() - std::min(firstMesh, _meshes.size()));
+	ThreadPool::TaskQueue tasks;
+	for(size_t i = 0; i < hashes.size(); ++i)
+		tasks.start([&, i]() { hashes[i] = _meshes[firstMesh + i].computeContentHash(); });
+	tasks.wait();
+	return hashes;
+}
 
-	nextMesh();
-	nextSubMesh();
+void Scene::registerMeshes(size_t firstMesh) {
+	firstMesh = std::min(firstMesh, _meshes.size());
+	const auto hashes = computeMeshHashes(firstMesh);
+	for(size_t i = 0; i < hashes.size(); ++i)
+		if(!_meshes[firstMesh + i].dynamic)
+			_meshHashes.emplace(hashes[i], MeshIndex(static_cast<uint32_t>(firstMesh + i)));
+}
 
-	std::string line;
-	Vertex		v{glm::vec3{0.0, 0.0, 0.0}, glm::vec3{1.0, 1.0, 1.0}};
-	while(std::getline(file, line)) {
-		// Ignore empty lines and comments
-		if(line.empty())
-			continue;
-		auto it = line.find_first_not_of(" \t");
-		if(it == std::string::npos || line[it] == '#')
-			continue;
-		if(line[0] == 'v') {
-			if(line[1] == 't') {
-				// Texture Coordinates
-				char*	  cur = line.data() + 3;
-				glm::vec2 uv;
-				for(glm::vec2::length_type i = 0; i < 2; ++i)
-					uv[i] = static_cast<float>(std::strtof(cur, &cur));
-				uvs.push_back(uv);
-			} else if(line[1] == 'n') {
-				// Normals
-				char*	  cur = line.data() + 3;
-				glm::vec3 n;
-				for(glm::vec3::length_type i = 0; i < 3; ++i)
-					n[i] = static_cast<float>(std::strtof(cur, &cur));
-				normals.push_back(glm::normalize(n));
-			} else {
-				// Vertices
-				char* cur = line.data() + 2;
-				for(glm::vec3::length_type i = 0; i < 3; ++i)
-					v.pos[i] = static_cast<float>(std::strtof(cur, &cur));
-				m->getVertices().push_back(v);
-			}
-		} else if(line[0] == 'f') {
-			char* cur = line.data() + 2;
-			for(size_t i = 0; i < 3; ++i) { // Supports only triangles.
-				auto vertexIndex = static_cast<uint32_t>(std::strtol(cur, &cur, 10));
-				assert(vertexIndex > 0 && vertexIndex != std::numeric_limits<long int>::max());
-				vertexIndex -= 1;			 // Indices starts at 1 in .obj
-				vertexIndex -= vertexOffset; // Indices are absolutes in the obj file, we're relative to the current submesh
-				m->getIndices().push_back(vertexIndex);
-				// Assuming vertices, uvs and normals have already been defined.
-				if(*cur == '/') {
-					++cur;
-					// Texture coordinate index
-					auto uvIndex = std::strtol(cur, &cur, 10);
-					if(uvIndex > 0 && uvIndex != std::numeric_limits<long int>::max())
-						m->getVertices()[vertexIndex].texCoord = uvs[uvIndex - 1];
-					// Normal index
-					if(*cur == '/') {
-						++cur;
-						auto normalIndex = std::strtol(cur, &cur, 10);
-						if(normalIndex > 0 && normalIndex != std::numeric_limits<long int>::max())
-							m->getVertices()[vertexIndex].normal = normals[normalIndex - 1];
-					}
+size_t Scene::deduplicateMeshes(size_t firstMesh) {
+	firstMesh = std::min(firstMesh, _meshes.size());
+	const auto hashes = computeMeshHashes(firstMesh);
+
+	// Serial pass, in order: The first occurrence of a geometry is kept.
+	std::vector<MeshIndex> remap(hashes.size(), InvalidMeshIndex);
+	std::vector<size_t>	   kept; // Current indices of the kept meshes, by final index (- firstMesh)
+	const auto			   currentIndex = [&](MeshIndex index) { return index < firstMesh ? index : kept[index - firstMesh]; };
+	for(size_t i = 0; i < hashes.size(); ++i) {
+		const auto& mesh = _meshes[firstMesh + i];
+		if(!mesh.dynamic) {
+			const auto [begin, end] = _meshHashes.equal_range(hashes[i]);
+			for(auto it = begin; it != end; ++it) {
+				const auto& candidate = _meshes[currentIndex(it->second)];
+				if(!candidate.dynamic && candidate.hasSameContent(mesh)) {
+					remap[i] = it->second;
+					break;
 				}
 			}
-		} else if(line[0] == 'o') {
-			// Next Mesh
-			if(m->getVertices().size() > 0)
-				nextMesh();
-		} else if(line[0] == 'g') {
-			// Next SubMesh
-			if(m->getVertices().size() > 0) {
-				m->computeVertexNormals();
-				m->computeBounds();
-				nextSubMesh();
-			}
-		} else {
-			warn("Unsupported OBJ command: '{}' (Full line: '{}')\n", line[0], line);
 		}
+		if(remap[i] != InvalidMeshIndex)
+			continue;
+		remap[i] = MeshIndex(static_cast<uint32_t>(firstMesh + kept.size()));
+		if(!mesh.dynamic)
+			_meshHashes.emplace(hashes[i], remap[i]);
+		kept.push_back(firstMesh + i);
 	}
-	// FIXME: Something's broken (see Raytracing debug view: Almost all black)
-	m->computeVertexNormals();
-	m->computeBounds();
-	return true;
+	const auto duplicates = hashes.size() - kept.size();
+	if(duplicates == 0)
+		return 0;
+
+	std::vector<Mesh> keptMeshes;
+	keptMeshes.reserve(kept.size());
+	for(const auto index : kept)
+		keptMeshes.push_back(std::move(_meshes[index]));
+	_meshes.resize(firstMesh);
+	for(auto& m : keptMeshes)
+		_meshes.push_back(std::move(m));
+
+	// Patched, so the update signals invalidate what depends on the mesh indices (e.g. the instance BVH, see onRendererChange).
+	const auto remapIndex = [&]<typename T>(entt::entity entity, const T& renderer) {
+		if(renderer.meshIndex != InvalidMeshIndex && renderer.meshIndex >= firstMesh)
+			_registry.patch<T>(entity, [&](T& r) { r.meshIndex = remap[r.meshIndex - firstMesh]; });
+	};
+	for(auto&& [entity, renderer] : _registry.view<MeshRendererComponent>().each())
+		remapIndex(entity, renderer);
+	for(auto&& [entity, renderer] : _registry.view<SkinnedMeshRendererComponent>().each())
+		remapIndex(entity, renderer);
+	return duplicates;
+}
+
+MeshOptimizer::Report Scene::optimizeMeshes(size_t firstMesh) {
+	QuickTimer						   qt("Mesh optimization");
+	std::vector<MeshOptimizer::Report> reports(_meshes.size() - std::min(firstMesh, _meshes.size()));
+	{
+		ThreadPool::TaskQueue tasks;
+		for(size_t i = 0; i < reports.size(); ++i)
+			tasks.start([&, i]() { reports[i] = MeshOptimizer::optimize(_meshes[firstMesh + i], meshOptimizerOptions); });
+	}
+	MeshOptimizer::Report total;
+	const auto			  accumulate = [](MeshOptimizer::Statistics& total, const MeshOptimizer::Statistics& stats) {
+		 total.triangles += stats.triangles;
+		 total.vertices += stats.vertices;
+		 total.cacheMisses += stats.cacheMisses;
+		 total.acmr = total.triangles > 0 ? static_cast<float>(total.cacheMisses) / total.triangles : 0.0f;
+		 total.atvr = total.vertices > 0 ? static_cast<float>(total.cacheMisses) / total.vertices : 0.0f;
+	};
+	for(const auto& r : reports) {
+		accumulate(total.before, r.before);
+		accumulate(total.after, r.after);
+	}
+	return total;
 }
 
 bool Scene::loadMaterial(const std::filesystem::path& path) {
@@ -649,10 +828,10 @@ bool Scene::loadMaterial(const std::filesystem::path& path) {
 		warn("Scene::loadMaterial: Extension '{}' not supported (filepath: '{}').", path.extension(), path.string());
 		return false;
 	}
-	JSON		json{path};
-	const auto& object = json.getRoot();
+	JSON::Document json{path};
+	const auto&	   object = json.getRoot();
 
-	const auto textureOffset = static_cast<uint32_t>(Textures.size());
+	const auto textureOffset = static_cast<uint32_t>(_textures->size());
 
 	loadTextures(path, object);
 
@@ -663,79 +842,145 @@ bool Scene::loadMaterial(const std::filesystem::path& path) {
 	return true;
 }
 
-bool Scene::loadMaterial(const JSON::value& mat, uint32_t textureOffset) {
+bool Scene::loadMaterial(const JSON::Document::Node& mat, uint32_t textureOffset) {
 	Material material = parseMaterial(mat, textureOffset);
 	// Change the default format of this texture now that we know it will be used as a normal map
 	if(material.properties.normalTexture != InvalidTextureIndex)
-		if(material.properties.normalTexture < Textures.size())
-			Textures[material.properties.normalTexture].format = VK_FORMAT_R8G8B8A8_UNORM;
+		if(material.properties.normalTexture < _textures->size())
+			(*_textures)[material.properties.normalTexture].format = VK_FORMAT_R8G8B8A8_UNORM;
 		else
 			warn("Scene::loadMaterial: Material '{}' refers to an out-of-bounds normal texture ({}).\n", material.name, material.properties.normalTexture);
 	// Change the default format of this texture now that we know it will be used as a metallicRoughnessTexture
 	if(material.properties.metallicRoughnessTexture != InvalidTextureIndex)
-		if(material.properties.metallicRoughnessTexture < Textures.size())
-			Textures[material.properties.metallicRoughnessTexture].format = VK_FORMAT_R8G8B8A8_UNORM;
+		if(material.properties.metallicRoughnessTexture < _textures->size())
+			(*_textures)[material.properties.metallicRoughnessTexture].format = VK_FORMAT_R8G8B8A8_UNORM;
 		else
 			warn("Scene::loadMaterial: Material '{}' refers to an out-of-bounds metallicRoughness texture ({}).\n", material.name, material.properties.metallicRoughnessTexture);
-	Materials.push_back(material);
+	_materials->push_back(material);
 	return true;
 }
 
-bool Scene::loadTextures(const std::filesystem::path& path, const JSON::value& json) {
+bool Scene::loadTextures(const std::filesystem::path& path, const JSON::Document::Node& json) {
+	// When undefined, a sampler with repeat wrapping and auto filtering should be used: This is what an empty description gives (see Resources.cpp).
+	const auto* samplers = json.find("samplers");
+	const auto	getSamplerDescription = [&](const JSON::Document::Node& texture) {
+		 const auto index = texture("sampler", -1);
+		 if(index < 0 || !samplers || samplers->getType() != JSON::value::Type::array || static_cast<size_t>(index) >= samplers->size() ||
+			(*samplers)[index].getType() != JSON::value::Type::object) {
+			 if(index >= 0)
+				 warn("Scene::loadTextures: Texture refers to an undefined sampler ({}), using the default one.\n", index);
+			 return JSON::object{};
+		 }
+		 return (*samplers)[index].toValue().asObject();
+	};
 	if(json.contains("textures"))
 		for(const auto& texture : json["textures"]) {
 			auto		imageIndex = texture["source"].as<int>();
 			const auto& image = json["images"][imageIndex];
 			if(image.contains("uri")) {
-				Textures.push_back(Texture{
+				_textures->push_back(Texture{
 					.source = path.parent_path() / json["images"][texture["source"].as<int>()]["uri"].asString(),
 					.format = VK_FORMAT_R8G8B8A8_SRGB,
-					.samplerDescription = json["samplers"][texture("sampler", 0)].asObject(), // When undefined, a sampler with repeat wrapping and auto filtering should be used.
+					.samplerDescription = getSamplerDescription(texture),
 				});
 			} else {
 				auto		bufferViewIndex = image["bufferView"].as<int>();
 				const auto& bufferView = json["bufferViews"][bufferViewIndex];
 				auto		mimeType = image["mimeType"].asString();
 				warn("Scene::loadTextures: Embeded textures are not yet supported (replaced by blank image). Type: '{}', BufferView: '{}'.\n", mimeType, bufferViewIndex);
-				Textures.push_back(Texture{
+				_textures->push_back(Texture{
 					.source = "data/blank.png",
 					.format = VK_FORMAT_R8G8B8A8_SRGB,
-					.samplerDescription = json["samplers"][texture("sampler", 0)].asObject(), // When undefined, a sampler with repeat wrapping and auto filtering should be used.
+					.samplerDescription = getSamplerDescription(texture),
 				});
 			}
 		}
 	return true;
 }
 
-bool Scene::save(const std::filesystem::path& path) {
+bool Scene::save(const std::filesystem::path& path, bool binaryJSON) {
 	QuickTimer qt(fmt::format("Save Scene to '{}'", path.string()));
-	JSON	   serialized{
-		  {"materials", JSON::array()},
-		  {"entities", JSON::array()},
-		  {"meshes", JSON::array()},
-	  };
-	auto& root = serialized.getRoot();
-
-	auto& mats = root["materials"].asArray();
-	for(const auto& mat : Materials)
-		mats.push_back(toJSON(mat));
-
-	auto&									 entities = root["entities"].asArray();
+
+	using namespace SceneFormat;
+	SceneFileWriter writer;
+
+	// Materials and textures are still described by a JSON document, json is either a JSON::Writer or a JSON::BinaryWriter.
+	const auto writeDocument = [&](auto& json) {
+		json.beginObject();
+
+		json.key("materials").beginArray();
+		for(const auto& mat : *_materials)
+			json.write(toJSON(mat));
+		json.endArray();
+
+		json.key("textures").beginArray();
+		for(const auto& t : *_textures) {
+			json.beginObject();
+			json.write("source", t.source.lexically_relative(path.parent_path()).string());
+			json.write("format", static_cast<int>(t.format));
+			json.write("sampler", t.samplerDescription);
+			json.endObject();
+		}
+		json.endArray();
+
+		json.endObject();
+	};
+	std::string document;
+	if(binaryJSON) {
+		JSON::BinaryWriter json;
+		writeDocument(json);
+		document = json.getEncoded();
+	} else {
+		JSON::Writer json;
+		writeDocument(json);
+		document = json.getBuffer();
+	}
+	writer.add(binaryJSON ? ChunkType::BJSN : ChunkType::JSON, std::span<const char>{document});
+
+	std::string strings;
+	const auto	addString = [&](const std::string& str, uint32_t& offset, uint32_t& length) {
+		 offset = static_cast<uint32_t>(strings.size());
+		 length = static_cast<uint32_t>(str.size());
+		 strings += str;
+	};
+
+	std::vector<MeshRecord> meshes(_meshes.size());
+	for(uint32_t i = 0; i < _meshes.size(); ++i) {
+		const auto& m = _meshes[i];
+		auto&		record = meshes[i];
+		addString(m.name, record.nameOffset, record.nameLength);
+		record.defaultMaterial = m.defaultMaterialIndex.value;
+		record.flags = (m.dynamic ? MeshRecord::Dynamic : 0) | (m.isSkinned() ? MeshRecord::Skinned : 0);
+		record.vertexChunk = writer.add(ChunkType::Vertices, std::span{m.getVertices()}, i);
+		record.indexChunk = writer.add(ChunkType::Indices, std::span{m.getIndices()}, i);
+		if(m.isSkinned()) {
+			record.skinWeightsChunk = writer.add(ChunkType::SkinWeights, std::span{m.getSkinVertexData().weights}, i);
+			record.skinJointsChunk = writer.add(ChunkType::SkinJoints, std::span{m.getSkinVertexData().joints}, i);
+		}
+		record.boundsMin = m.getBounds().min;
+		record.boundsMax = m.getBounds().max;
+	}
+
 	auto									 view = _registry.view<NodeComponent>();
-	std::unordered_map<entt::entity, size_t> entitiesIndices;
+	std::unordered_map<entt::entity, uint32_t> entitiesIndices;
+	for(uint32_t index = 0; const auto& entity : view)
+		entitiesIndices[entity] = index++; // Maps entity id to index in the entity table
+	const auto toIndex = [&](entt::entity entity) { return entity == entt::null ? InvalidIndex : entitiesIndices[entity]; };
+
+	std::vector<EntityRecord> entities;
+	entities.reserve(view.size());
 	for(const auto& entity : view) {
-		auto& n = _registry.get<NodeComponent>(entity);
-		JSON  nodeJSON{
-			 {"name", n.name},
-			 {"transform", toJSON(n.transform)},
-			 {"parent", -1},
-			 {"children", JSON::array()},
-		 };
+		const auto& n = _registry.get<NodeComponent>(entity);
+		auto&		record = entities.emplace_back();
+		record.transform = n.transform;
+		addString(n.name, record.nameOffset, record.nameLength);
+		record.parent = toIndex(n.parent);
+		record.firstChild = toIndex(n.first);
+		record.nextSibling = toIndex(n.next);
+		record.childCount = static_cast<uint32_t>(n.children);
 		if(auto* mesh = _registry.try_get<MeshRendererComponent>(entity); mesh != nullptr) {
-			nodeJSON["meshRenderer"] = JSON{
-				{"meshIndex", static_cast<int>(mesh->meshIndex)},
-				{"materialIndex", static_cast<int>(mesh->materialIndex)},
-			};
+			record.meshIndex = mesh->meshIndex.value;
+			record.materialIndex = mesh->materialIndex.value;
 		}
 		if(auto* comp = _registry.try_get<SkinnedMeshRendererComponent>(entity); comp != nullptr) {
 			warn("Scene::save: SkinnedMeshRendererComponents are not supported yet.");
@@ -743,162 +988,224 @@ bool Scene::save(const std::filesystem::path& path) {
 		if(auto* comp = _registry.try_get<AnimationComponent>(entity); comp != nullptr) {
 			warn("Scene::save: AnimationComponents are not supported yet.");
 		}
-		entitiesIndices[entity] = entities.size(); // Maps entity id to index in the file array, used to create children array
-		entities.push_back(nodeJSON);
-	}
-	// Add childrens
-	size_t index = 0;
-	for(const auto& entity : view) {
-		auto& n = _registry.get<NodeComponent>(entity);
-		for(auto c = n.first; c != entt::null; c = _registry.get<NodeComponent>(c).next)
-			entities[index]["children"].push(entitiesIndices[c]);
-		++index;
 	}
 
-	std::vector<GLBChunk> buffers;
-	buffers.push_back({
-		.type = GLBChunkType::JSON,
-	}); // This will become the main JSON chunk header
-	auto& meshes = root["meshes"].asArray();
-	for(const auto& m : _meshes) {
-		int	 offset = static_cast<int>(buffers.size());
-		JSON mesh{
-			{"name", m.name},
-			{"material", m.defaultMaterialIndex.value},
-			{"vertexArray", offset + 0},
-			{"indexArray", offset + 1},
-		};
-		buffers.push_back(GLBChunk{static_cast<uint32_t>(m.getVertexByteSize()), GLBChunkType::BIN, reinterpret_cast<char*>(const_cast<Vertex*>(m.getVertices().data()))});
-		buffers.push_back(GLBChunk{static_cast<uint32_t>(m.getIndexByteSize()), GLBChunkType::BIN, reinterpret_cast<char*>(const_cast<uint32_t*>(m.getIndices().data()))});
-		meshes.push_back(std::move(mesh));
-	}
+	writer.add(ChunkType::Meshes, std::span<const MeshRecord>{meshes});
+	writer.add(ChunkType::Entities, std::span<const EntityRecord>{entities});
+	writer.add(ChunkType::Strings, std::span<const char>{strings});
 
-	root["textures"] = JSON::array();
-	auto& textures = root["textures"].asArray();
-	for(const auto& t : Textures) {
-		textures.push_back(JSON{
-			{"source", t.source.lexically_relative(path.parent_path()).string()},
-			{"format", static_cast<int>(t.format)},
-			{"sampler", t.samplerDescription},
-		});
-	}
+	return writer.write(path);
+}
+
+bool Scene::loadScene(const std::filesystem::path& path) {
+	QuickTimer qt(fmt::format("Loading Scene '{}'", fmt::format(fg(fmt::color::royal_blue), path.string())));
+
+	// FIXME
+	_registry.clear();
+	_root = entt::null;
+	_materials->clear();
+	_textures->clear();
+	_meshes.clear();
+	_meshHashes.clear();
+	_meshBVHs.clear();
 
-	std::ofstream file(path, std::ios::binary);
-	if(!file) {
-		error("Scene::save error: Could not open '{}' file for writing.", path.string());
+	MappedFile file;
+	if(!file.open(path, MappedFile::Access::Random)) {
+		error("Scene::loadScene error: Could not open file '{}'.\n", path.string());
+		return false;
+	}
+	if(file.size() < sizeof(GLBHeader) || reinterpret_cast<const GLBHeader*>(file.data())->magic != SceneFormat::Magic) {
+		error("Scene::loadScene error: '{}' is not a scene file.\n", path.string());
 		return false;
 	}
 
-	auto jsonStr = root.toString();
-	buffers[0].length = static_cast<uint32_t>(jsonStr.size());
-	buffers[0].data = jsonStr.data();
+	bool loaded = false;
+	switch(const auto version = reinterpret_cast<const GLBHeader*>(file.data())->version; version) {
+		case 0: loaded = loadSceneV0(file, path); break;
+		case SceneFormat::Version: {
+			SceneFile sceneFile;
+			loaded = sceneFile.open(std::move(file), path) && loadSceneV2(sceneFile, path);
+			break;
+		}
+		default: error("Scene::loadScene error: Unsupported version {} of scene file '{}'.\n", version, path.string()); return false;
+	}
+	if(!loaded)
+		return false;
 
-	uint32_t totalLength = sizeof(GLBHeader);
-	for(const auto& buff : buffers)
-		totalLength += 2 * sizeof(uint32_t) + buff.length;
+	// Saved scenes are already deduplicated, only register their meshes for the next imports.
+	registerMeshes(0);
 
-	GLBHeader header{
-		.magic = 0x4e454353,
-		.version = 0,
-		.length = totalLength,
-	};
+	if(sortImportedNodes)
+		sortNodes();
+	markDirty(_root);
+	computeBounds();
+	return true;
+}
+
+bool Scene::loadSceneV2(const SceneFile& file, const std::filesystem::path& path) {
+	using namespace SceneFormat;
 
-	file.write(reinterpret_cast<char*>(&header), sizeof(header));
-	for(const auto& buff : buffers) {
-		file.write(reinterpret_cast<const char*>(&buff.length), sizeof(buff.length));
-		file.write(reinterpret_cast<const char*>(&buff.type), sizeof(buff.type));
-		file.write(buff.data, buff.length);
+	ChunkType			   documentType = ChunkType::JSON;
+	const std::string_view documentData = file.getDocument(documentType);
+	JSON::Document		   document;
+	if(!(documentType == ChunkType::BJSN ? document.parseBinary(documentData) : document.parse(documentData))) {
+		error("Scene::loadScene: Document chunk from scene file '{}' could not be parsed.\n", path.string());
+		return false;
+	}
+	const auto& root = document.getRoot();
+	for(const auto& t : root["textures"]) {
+		_textures->push_back(Texture{
+			.source = path.parent_path() / t["source"].asString(),
+			.format = static_cast<VkFormat>(t["format"].as<int>()),
+			.samplerDescription = t["sampler"].toValue().asObject(),
+		});
 	}
+	for(const auto& m : root["materials"])
+		loadMaterial(m, 0);
+	if(!file.validateMaterials(_materials->size(), path))
+		return false;
 
-	file.close();
+	loadMeshes(file);
+
+	// Entities are created in the order of the table, so relationships can be resolved by index.
+	const auto				  records = file.getEntities();
+	std::vector<entt::entity> entities(records.size());
+	_registry.create(entities.begin(), entities.end());
+	const auto toEntity = [&](uint32_t index) { return index == InvalidIndex ? entt::null : entities[index]; };
+	for(size_t i = 0; i < records.size(); ++i) {
+		const auto& r = records[i];
+		auto&		node = _registry.emplace<NodeComponent>(entities[i]);
+		node.name = file.getString(r.nameOffset, r.nameLength);
+		node.transform = r.transform;
+		node.parent = toEntity(r.parent);
+		node.first = toEntity(r.firstChild);
+		node.next = toEntity(r.nextSibling);
+		node.children = r.childCount;
+		if(r.meshIndex != InvalidIndex)
+			_registry.emplace<MeshRendererComponent>(entities[i], MeshRendererComponent{
+																	  .meshIndex = MeshIndex(r.meshIndex),
+																	  .materialIndex = MaterialIndex(r.materialIndex),
+																  });
+		if(r.parent == InvalidIndex && _root == entt::null)
+			_root = entities[i];
+	}
+	for(size_t i = 0; i < records.size(); ++i)
+		if(records[i].nextSibling != InvalidIndex)
+			_registry.get<NodeComponent>(entities[records[i].nextSibling]).prev = entities[i];
 
+	if(_root == entt::null) {
+		error("Scene::loadScene: Scene file '{}' has no root entity.\n", path.string());
+		return false;
+	}
 	return true;
 }
 
-bool Scene::loadScene(const std::filesystem::path& path) {
-	QuickTimer qt(fmt::format("Loading Scene '{}'", fmt::format(fg(fmt::color::royal_blue), path.string())));
+std::vector<MeshIndex> Scene::loadMeshes(const SceneFile& file, std::span<const uint32_t> selection, uint32_t materialOffset) {
+	const auto records = file.getMeshes();
+	const auto count = selection.empty() ? records.size() : selection.size();
+
+	std::vector<MeshIndex> indices;
+	indices.reserve(count);
+	const auto firstMesh = _meshes.size();
+	for(size_t i = 0; i < count; ++i) {
+		const auto recordIndex = selection.empty() ? static_cast<uint32_t>(i) : selection[i];
+		assert(recordIndex < records.size());
+		const auto& r = records[recordIndex];
+		auto&		mesh = _meshes.emplace_back();
+		mesh.name = file.getString(r.nameOffset, r.nameLength);
+		mesh.defaultMaterialIndex = MaterialIndex{r.defaultMaterial + materialOffset};
+		mesh.dynamic = r.flags & SceneFormat::MeshRecord::Dynamic;
+		mesh.setBounds(Bounds{.min = r.boundsMin, .max = r.boundsMax});
+		indices.push_back(MeshIndex(static_cast<uint32_t>(_meshes.size() - 1)));
+	}
 
-	// FIXME
-	_registry.clear();
-	_root = entt::null;
-	Materials.clear();
-	Textures.clear();
-	_meshes.clear();
+	// Chunks are independent and aligned: Each mesh is copied once, straight from the mapping to its final destination, in parallel.
+	{
+		ThreadPool::TaskQueue tasks;
+		for(size_t i = 0; i < count; ++i)
+			tasks.start([&, i]() {
+				const auto& r = records[selection.empty() ? i : selection[i]];
+				auto&		mesh = _meshes[firstMesh + i];
+				const auto	vertices = file.getVertices(r);
+				const auto	meshIndices = file.getIndices(r);
+				mesh.getVertices().assign(vertices.begin(), vertices.end());
+				mesh.getIndices().assign(meshIndices.begin(), meshIndices.end());
+				if(r.flags & SceneFormat::MeshRecord::Skinned) {
+					const auto weights = file.getSkinWeights(r);
+					const auto joints = file.getSkinJoints(r);
+					mesh.setSkinVertexData(SkinVertexData{
+						.weights = {weights.begin(), weights.end()},
+						.joints = {joints.begin(), joints.end()},
+					});
+				}
+			});
+	}
+	return indices;
+}
 
-	std::ifstream file(path, std::ios::binary | std::ios::ate);
-	if(!file) {
-		error("Scene::loadScene error: Could not open file '{}'.\n", path.string());
+// Version 0: JSON (or BJSN) chunk followed by unaligned BIN chunks, parsed front to back.
+bool Scene::loadSceneV0(const MappedFile& file, const std::filesystem::path& path) {
+	file.willNeed(0, file.size());
+	std::vector<std::span<const char>> buffers; // BIN chunks, views into the mapping
+	std::vector<GLBChunkView>		   chunks;
+	if(!readGLBChunks(file.span(), path, chunks))
 		return false;
-	}
-	std::streamsize size = file.tellg();
-	file.seekg(0, std::ios::beg);
-
-	std::vector<char>			   filebuffer(size);
-	std::vector<std::vector<char>> buffers;
-	if(file.read(filebuffer.data(), size)) {
-		JSON	  json;
-		GLBHeader header = *reinterpret_cast<GLBHeader*>(filebuffer.data());
-		assert(header.magic == 0x4e454353);
-		GLBChunk jsonChunk = *reinterpret_cast<GLBChunk*>(filebuffer.data() + sizeof(GLBHeader));
-		assert(jsonChunk.type == GLBChunkType::JSON);
-		jsonChunk.data = filebuffer.data() + sizeof(GLBHeader) + offsetof(GLBChunk, data);
-		if(!json.parse(jsonChunk.data, jsonChunk.length)) {
+	if(!chunks.empty()) {
+		JSON::Document		   json;
+		const std::string_view jsonData{chunks[0].data.data(), chunks[0].data.size()};
+		bool				   parsed = false;
+		switch(chunks[0].type) {
+			// Packed: Entity transforms (16 reals each) and children lists make up most of the document.
+			case GLBChunkType::JSON: parsed = json.parse(jsonData, JSON::Document::ParseOptions{.packNumericArrays = true}); break;
+			case GLBChunkType::BJSN: parsed = json.parseBinary(jsonData); break;
+			default: error("Scene::loadScene: Unexpected first chunk in scene file '{}'.\n", path.string()); return false;
+		}
+		if(!parsed) {
 			error("Scene::loadScene: JSON chunk from scene file '{}' could not be parsed.\n", path.string());
 			return false;
 		}
-		char* offset = filebuffer.data() + sizeof(GLBHeader) + offsetof(GLBChunk, data) + jsonChunk.length;
-		while(offset - filebuffer.data() < header.length) {
-			GLBChunk chunk = *reinterpret_cast<GLBChunk*>(offset);
-			assert(chunk.type == GLBChunkType::BIN);
-			chunk.data = offset + offsetof(GLBChunk, data);
-			offset += offsetof(GLBChunk, data) + chunk.length;
-			buffers.emplace_back().assign(chunk.data, chunk.data + chunk.length);
+		for(size_t i = 1; i < chunks.size(); ++i) {
+			if(chunks[i].type != GLBChunkType::BIN) {
+				error("Scene::loadScene: Unexpected chunk type {:#x} in scene file '{}' (chunk {}).\n", static_cast<uint32_t>(chunks[i].type), path.string(), i);
+				return false;
+			}
+			buffers.push_back(chunks[i].data);
 		}
-
 		std::vector<entt::entity>		 entities;
 		std::vector<std::vector<size_t>> entitiesChildren;
-		const auto&						 root = json.getRoot(); // FIXME: See loadglTF
+		const auto&						 root = json.getRoot();
 		for(const auto& n : root["entities"]) {
 			auto entity = _registry.create();
 			entities.push_back(entity);
 			auto& node = _registry.emplace<NodeComponent>(entity);
 			node.name = n["name"].asString();
 			node.transform = n["transform"].to<glm::mat4>();
-			entitiesChildren.emplace_back();
-			for(const auto& c : n["children"])
-				entitiesChildren.back().push_back(c.asNumber().asInteger());
+			auto&		children = entitiesChildren.emplace_back();
+			const auto& childrenNode = n["children"];
+			if(childrenNode.isPackedIntegers())
+				children.assign(childrenNode.asIntegers().begin(), childrenNode.asIntegers().end());
+			else // Empty, or from a BJSN chunk
+				for(const auto& c : childrenNode)
+					children.push_back(c.as<int>());
 
 			if(n.contains("meshRenderer")) {
 				_registry.emplace<MeshRendererComponent>(entity, MeshRendererComponent{
-																	 .meshIndex = MeshIndex(n["meshRenderer"]["meshIndex"].asNumber().asInteger()),
-																	 .materialIndex = MaterialIndex(n["meshRenderer"]["materialIndex"].asNumber().asInteger()),
+																	 .meshIndex = MeshIndex(n["meshRenderer"]["meshIndex"].as<int>()),
+																	 .materialIndex = MaterialIndex(n["meshRenderer"]["materialIndex"].as<int>()),
 																 });
 			}
 		}
 
 		// Update nodes relationships now that they're all available
-		for(size_t entityIndex = 0; entityIndex < entitiesChildren.size(); ++entityIndex) {
-			auto& parentNode = _registry.get<NodeComponent>(entities[entityIndex]);
-			auto& children = entitiesChildren[entityIndex];
-			if(children.size() > 0) {
-				parentNode.first = entities[children[0]];
-				parentNode.children = children.size();
-				for(size_t idx = 0; idx < entitiesChildren[entityIndex].size(); ++idx) {
-					auto& childNode = _registry.get<NodeComponent>(entities[children[idx]]);
-					childNode.parent = entities[entityIndex];
-					if(idx > 0)
-						childNode.prev = entities[children[idx - 1]];
-					if(idx < children.size() - 1)
-						childNode.next = entities[children[idx + 1]];
-				}
-			}
-		}
+		HierarchyBuilder hierarchy(*this);
+		for(size_t entityIndex = 0; entityIndex < entitiesChildren.size(); ++entityIndex)
+			hierarchy.addChildren<size_t>(entities[entityIndex], entitiesChildren[entityIndex], entities);
 
 		for(const auto& t : root["textures"]) {
-			Textures.push_back(Texture{
+			_textures->push_back(Texture{
 				.source = path.parent_path() / t["source"].asString(),
 				.format = static_cast<VkFormat>(t["format"].as<int>()),
-				.samplerDescription = t["sampler"].asObject(),
+				.samplerDescription = t["sampler"].toValue().asObject(),
 			});
 		}
 
@@ -910,15 +1217,21 @@ bool Scene::loadScene(const std::filesystem::path& path) {
 			auto& mesh = _meshes.emplace_back();
 			mesh.name = m["name"].asString();
 			mesh.defaultMaterialIndex = MaterialIndex{static_cast<uint32_t>(m("material", 0))};
-			auto vertexArrayIndex = m["vertexArray"].as<int>() - 1; // Skipping the JSON chunk
-			mesh.getVertices().assign(reinterpret_cast<Vertex*>(buffers[vertexArrayIndex].data()),
-									  reinterpret_cast<Vertex*>(buffers[vertexArrayIndex].data() + buffers[vertexArrayIndex].size()));
-			auto indexArrayIndex = m["indexArray"].as<int>() - 1;
-			mesh.getIndices().assign(reinterpret_cast<uint32_t*>(buffers[indexArrayIndex].data()),
-									 reinterpret_cast<uint32_t*>(buffers[indexArrayIndex].data() + buffers[indexArrayIndex].size()));
+			// Chunks are not aligned in the file: Copied once, straight from the mapping to their final destination.
+			const auto vertexArray = m["vertexArray"].as<int>() - 1; // Skipping the JSON chunk
+			const auto indexArray = m["indexArray"].as<int>() - 1;
+			if(vertexArray < 0 || indexArray < 0 || static_cast<size_t>(std::max(vertexArray, indexArray)) >= buffers.size()) {
+				error("Scene::loadScene: Mesh '{}' of scene file '{}' references a missing BIN chunk.\n", mesh.name, path.string());
+				return false;
+			}
+			const auto vertices = buffers[vertexArray];
+			mesh.getVertices().resize(vertices.size() / sizeof(Vertex));
+			std::memcpy(mesh.getVertices().data(), vertices.data(), mesh.getVertices().size() * sizeof(Vertex));
+			const auto indices = buffers[indexArray];
+			mesh.getIndices().resize(indices.size() / sizeof(uint32_t));
+			std::memcpy(mesh.getIndices().data(), indices.data(), mesh.getIndices().size() * sizeof(uint32_t));
 			mesh.computeBounds();
 		}
-
 		// Find root (FIXME: There's probably a better way to do this. Should we order the nodes when saving so the root is always the first node in the array? It's also probably a
 		// win for performance, mmh...)
 		for(auto e : entities)
@@ -926,38 +1239,368 @@ bool Scene::loadScene(const std::filesystem::path& path) {
 				_root = e;
 				break;
 			}
-		markDirty(_root);
-		computeBounds();
 		return true;
 	}
+	error("Scene::loadScene: Scene file '{}' is empty.\n", path.string());
 	return false;
 }
 
+struct Scene::AsyncLoad {
+	using State = LoadHandle::State;
+	enum class Stage {
+		Resources,
+		Meshes,
+		Nodes,
+		Finalize
+	};
+
+	std::filesystem::path path;
+	std::atomic<State>	  state = State::Parsing;
+	std::atomic<bool>	  cancelled = false;
+
+	// Written by the loading task, then only accessed by the main thread once state is Publishing.
+	Scene							   staging;
+	std::vector<Material>			   materials;
+	std::vector<Texture>			   textures;
+	std::vector<SkeletalAnimationClip> animations;
+	// Material indices lower than materialBase refer to materials already loaded when the load started (e.g. the default material), see loadAsync.
+	uint32_t				  materialBase = 0;
+	std::vector<uint64_t>	  meshHashes;
+	std::vector<entt::entity> nodes; // Staging entities in depth-first order (parents first), without the staging root
+
+	// Publication state
+	Stage										   stage = Stage::Resources;
+	size_t										   nextMesh = 0;
+	size_t										   nextNode = 0;
+	uint32_t									   materialOffset = 0;
+	uint32_t									   textureOffset = 0;
+	std::vector<MeshIndex>						   meshMap;
+	std::unordered_map<entt::entity, entt::entity> nodeMap;
+	std::atomic<size_t>							   publishedMeshes = 0;
+	std::atomic<size_t>							   publishedNodes = 0;
+
+	void parse() {
+		if(!cancelled && !staging.load(path)) {
+			state = State::Failed;
+			return;
+		}
+		if(cancelled) {
+			state = State::Cancelled;
+			return;
+		}
+		// Hashes for the deduplication against the meshes of the destination scene (see Scene::publish)
+		meshHashes.resize(staging._meshes.size());
+		{
+			ThreadPool::TaskQueue tasks;
+			for(size_t i = 0; i < meshHashes.size(); ++i)
+				tasks.start([&, i]() { meshHashes[i] = staging._meshes[i].computeContentHash(); });
+		}
+		std::vector<entt::entity> stack;
+		const auto				  pushChildren = [&](entt::entity entity) {
+			 const auto first = stack.size();
+			 for(auto c = staging._registry.get<NodeComponent>(entity).first; c != entt::null; c = staging._registry.get<NodeComponent>(c).next)
+				 stack.push_back(c);
+			 std::reverse(stack.begin() + first, stack.end());
+		};
+		pushChildren(staging._root);
+		while(!stack.empty()) {
+			const auto entity = stack.back();
+			stack.pop_back();
+			nodes.push_back(entity);
+			pushChildren(entity);
+		}
+		state = cancelled ? State::Cancelled : State::Publishing;
+	}
+
+	MaterialIndex remapMaterial(MaterialIndex index) const {
+		if(index == InvalidMaterialIndex || index < materialBase)
+			return index;
+		return MaterialIndex(index - materialBase + materialOffset);
+	}
+};
+
+Scene::LoadHandle Scene::loadAsync(const std::filesystem::path& path) {
+	auto  load = std::make_shared<AsyncLoad>();
+	auto& staging = load->staging;
+	load->path = path;
+	staging._materials = &load->materials;
+	staging._textures = &load->textures;
+	staging._animations = &load->animations;
+	staging.deduplicateImportedMeshes = deduplicateImportedMeshes;
+	staging.optimizeImportedMeshes = optimizeImportedMeshes;
+	staging.meshOptimizerOptions = meshOptimizerOptions;
+	staging.sortImportedNodes = false; // Nodes are sorted once published
+	// Imported meshes without material use the index 0 (the default material of the editor): Placeholders preserve the indices of the already loaded
+	// materials in the staging scene. .scene files replace all the materials of the staging scene, their indices are all relative to the file.
+	if(path.extension() != ".scene") {
+		load->materialBase = static_cast<uint32_t>(_materials->size());
+		load->materials.resize(load->materialBase);
+	}
+	ThreadPool::GetInstance().queue([load]() { load->parse(); });
+	_loads.push_back(load);
+	return LoadHandle(load);
+}
+
+std::vector<Scene::LoadHandle> Scene::getLoads() const {
+	std::vector<LoadHandle> handles;
+	for(const auto& load : _loads)
+		handles.push_back(LoadHandle(load));
+	return handles;
+}
+
+Scene::PublishResult Scene::publishLoads(const PublishBudget& budget) {
+	PublishBudget remaining = budget;
+	PublishResult result{.firstMesh = _meshes.size()};
+	// Loads are published as soon as they're parsed, not necessarily in the order of the calls to loadAsync.
+	for(auto& load : _loads) {
+		if(load->state != AsyncLoad::State::Publishing)
+			continue;
+		if(load->cancelled) {
+			load->state = AsyncLoad::State::Cancelled;
+			continue;
+		}
+		publish(*load, remaining, result);
+		if(remaining.meshes == 0 || remaining.nodes == 0)
+			break;
+	}
+	std::erase_if(_loads, [](const auto& load) { return LoadHandle(load).isFinished(); });
+	result.meshes = _meshes.size() > result.firstMesh;
+	return result;
+}
+
+void Scene::publish(AsyncLoad& load, PublishBudget& budget, PublishResult& result) {
+	using Stage = AsyncLoad::Stage;
+	auto& staging = load.staging;
+
+	if(load.stage == Stage::Resources) {
+		load.textureOffset = static_cast<uint32_t>(_textures->size());
+		load.materialOffset = static_cast<uint32_t>(_materials->size());
+		for(auto& texture : load.textures)
+			_textures->push_back(std::move(texture));
+		for(size_t i = load.materialBase; i < load.materials.size(); ++i) {
+			auto& material = load.materials[i];
+			for(auto* texture : {&material.properties.albedoTexture, &material.properties.normalTexture, &material.properties.metallicRoughnessTexture,
+								 &material.properties.emissiveTexture})
+				if(*texture != InvalidTextureIndex)
+					*texture += load.textureOffset;
+			_materials->push_back(std::move(material));
+		}
+		load.meshMap.resize(staging._meshes.size(), InvalidMeshIndex);
+		result.resources |= !load.textures.empty() || load.materials.size() > load.materialBase;
+		load.stage = Stage::Meshes;
+	}
+
+	if(load.stage == Stage::Meshes) {
+		for(; load.nextMesh < staging._meshes.size() && budget.meshes > 0; ++load.nextMesh, --budget.meshes) {
+			auto&	   mesh = staging._meshes[load.nextMesh];
+			const auto hash = load.meshHashes[load.nextMesh];
+			auto	   index = InvalidMeshIndex;
+			if(deduplicateImportedMeshes && !mesh.dynamic) {
+				const auto [begin, end] = _meshHashes.equal_range(hash);
+				for(auto it = begin; it != end && index == InvalidMeshIndex; ++it)
+					if(!_meshes[it->second].dynamic && _meshes[it->second].hasSameContent(mesh))
+						index = it->second;
+			}
+			if(index == InvalidMeshIndex) {
+				mesh.defaultMaterialIndex = load.remapMaterial(mesh.defaultMaterialIndex);
+				index = MeshIndex(static_cast<uint32_t>(_meshes.size()));
+				if(!mesh.dynamic)
+					_meshHashes.emplace(hash, index);
+				_meshes.push_back(std::move(mesh));
+			}
+			load.meshMap[load.nextMesh] = index;
+			++load.publishedMeshes;
+		}
+		if(load.nextMesh == staging._meshes.size())
+			load.stage = Stage::Nodes;
+	}
+
+	if(load.stage == Stage::Nodes) {
+		// One builder per batch: The last children are searched for once per parent and batch.
+		HierarchyBuilder hierarchy(*this);
+		for(; load.nextNode < load.nodes.size() && budget.nodes > 0; ++load.nextNode, --budget.nodes) {
+			const auto	source = load.nodes[load.nextNode];
+			const auto& sourceNode = staging._registry.get<NodeComponent>(source);
+			const auto	entity = _registry.create();
+			auto&		node = _registry.emplace<NodeComponent>(entity);
+			node.name = sourceNode.name;
+			node.transform = sourceNode.transform;
+			load.nodeMap[source] = entity;
+			// Parents are published first (depth-first order), children are appended in order.
+			hierarchy.addChild(sourceNode.parent == staging._root ? _root : load.nodeMap.at(sourceNode.parent), entity);
+			if(const auto* renderer = staging._registry.try_get<MeshRendererComponent>(source); renderer)
+				_registry.emplace<MeshRendererComponent>(entity, MeshRendererComponent{
+																	 .meshIndex = renderer->meshIndex == InvalidMeshIndex ? InvalidMeshIndex : load.meshMap[renderer->meshIndex],
+																	 .materialIndex = load.remapMaterial(renderer->materialIndex),
+																 });
+			++load.publishedNodes;
+			result.nodes = true;
+		}
+		if(load.nextNode == load.nodes.size())
+			load.stage = Stage::Finalize;
+	}
+
+	if(load.stage == Stage::Finalize) {
+		// Skins and animations reference nodes: Published once all the nodes are, with the components using them.
+		const auto skinOffset = static_cast<uint32_t>(_skins.size());
+		for(auto& skin : staging._skins) {
+			for(auto& joint : skin.joints)
+				joint = load.nodeMap.at(joint);
+			_skins.push_back(std::move(skin));
+		}
+		const auto animationOffset = static_cast<uint32_t>(_animations->size());
+		for(auto& animation : load.animations) {
+			decltype(animation.nodeAnimations) nodeAnimations;
+			for(auto& [entity, nodeAnimation] : animation.nodeAnimations) {
+				nodeAnimation.entity = load.nodeMap.at(entity);
+				nodeAnimations.emplace(nodeAnimation.entity, std::move(nodeAnimation));
+			}
+			animation.nodeAnimations = std::move(nodeAnimations);
+			_animations->push_back(std::move(animation));
+		}
+		for(const auto source : load.nodes) {
+			const auto entity = load.nodeMap.at(source);
+			if(const auto* renderer = staging._registry.try_get<SkinnedMeshRendererComponent>(source); renderer)
+				_registry.emplace<SkinnedMeshRendererComponent>(entity, SkinnedMeshRendererComponent{
+																			.meshIndex = load.meshMap[renderer->meshIndex],
+																			.materialIndex = load.remapMaterial(renderer->materialIndex),
+																			.skinIndex = SkinIndex(renderer->skinIndex + skinOffset),
+																		});
+			if(const auto* animation = staging._registry.try_get<AnimationComponent>(source); animation) {
+				auto& component = _registry.emplace<AnimationComponent>(entity, *animation);
+				if(component.animationIndex != InvalidAnimationIndex)
+					component.animationIndex = AnimationIndex(component.animationIndex + animationOffset);
+			}
+		}
+		if(sortImportedNodes)
+			sortNodes();
+		computeBounds(); // The nodes were marked dirty as they were published
+		load.state = AsyncLoad::State::Done;
+		result.finished = true;
+	}
+}
+
+Scene::LoadHandle::State Scene::LoadHandle::getState() const {
+	return _load->state;
+}
+
+bool Scene::LoadHandle::isFinished() const {
+	const auto state = getState();
+	return state == State::Done || state == State::Failed || state == State::Cancelled;
+}
+
+const std::filesystem::path& Scene::LoadHandle::getPath() const {
+	return _load->path;
+}
+
+float Scene::LoadHandle::getProgress() const {
+	switch(getState()) {
+		case State::Parsing: return 0.0f;
+		case State::Publishing: {
+			// Sizes of the staging scene are fixed once parsed.
+			const auto total = _load->meshHashes.size() + _load->nodes.size();
+			return 0.5f + 0.5f * static_cast<float>(_load->publishedMeshes + _load->publishedNodes) / std::max<size_t>(1, total + 1);
+		}
+		default: return 1.0f;
+	}
+}
+
+size_t Scene::LoadHandle::getPublishedMeshes() const {
+	return _load->publishedMeshes;
+}
+
+void Scene::LoadHandle::cancel() {
+	_load->cancelled = true;
+}
+
 bool Scene::update(float deltaTime) {
 	QuickTimer qt(_updateTimes);
-	bool	   hierarchicalChanges = false;
-	if(!_dirtyNodes.empty()) {
-		// Update all cached globalTransform
-		// FIXME: We could restrict ourselves to _dirtyNodes by computing they common ancestor for example (simply iterating over _dirtyNodes will traverse the same nodes multiple
-		// times)
-		auto&																	   node = _registry.get<NodeComponent>(_root);
-		std::function<void(const glm::mat4& parentTransform, NodeComponent& node)> updateChildrenGlobalTransforms = [&](const glm::mat4& parentTransform,
-																														NodeComponent&	 parentNode) {
-			auto child = parentNode.first;
-			while(child != entt::null) {
-				auto& childNode = _registry.get<NodeComponent>(child);
-				childNode.globalTransform = parentTransform * childNode.transform;
-				updateChildrenGlobalTransforms(childNode.globalTransform, childNode);
-				child = childNode.next;
+	if(_dirtyNodes.empty())
+		return false;
+
+	if(!_hierarchy.isValid())
+		_hierarchy.rebuild(_registry, _root);
+
+	_dirtyIndices.clear();
+	for(const auto entity : _dirtyNodes)
+		if(const auto index = _hierarchy.indexOf(entity); index != TransformHierarchy::InvalidIndex) // Skip destroyed and detached nodes
+			_dirtyIndices.push_back(index);
+	_dirtyNodes.clear();
+	std::sort(_dirtyIndices.begin(), _dirtyIndices.end());
+
+	// Roots of the dirty subtrees: Subtrees are contiguous in the hierarchy, once sorted the dirty nodes inside a previous subtree can be skipped.
+	uint32_t nodeCount = 0;
+	auto	 rootsEnd = _dirtyIndices.begin();
+	for(auto it = _dirtyIndices.begin(); it != _dirtyIndices.end(); ++it)
+		if(rootsEnd == _dirtyIndices.begin() || *it >= _hierarchy.subtreeEnd(*(rootsEnd - 1))) {
+			*rootsEnd++ = *it;
+			nodeCount += _hierarchy.subtreeEnd(*it) - *it;
+		}
+	_dirtyIndices.erase(rootsEnd, _dirtyIndices.end());
+	if(_dirtyIndices.empty())
+		return false;
+	_instanceBVHMoved = true;
+
+	// Scene bounds are only grown to include the moved meshes, see getBounds().
+	const bool	growBounds = _bounds.isValid();
+	const auto	entities = _hierarchy.getEntities();
+	const auto	world = _hierarchy.getWorldTransforms();
+	const auto& meshRenderers = _registry.storage<MeshRendererComponent>();
+	const auto& skinnedMeshRenderers = _registry.storage<SkinnedMeshRendererComponent>();
+
+	const auto updateRange = [&](uint32_t first, uint32_t last, Bounds& bounds) {
+		_hierarchy.update(first, last);
+		if(growBounds)
+			for(auto i = first; i < last; ++i) {
+				auto meshIndex = meshRenderers.contains(entities[i])		  ? meshRenderers.get(entities[i]).meshIndex
+								 : skinnedMeshRenderers.contains(entities[i]) ? skinnedMeshRenderers.get(entities[i]).meshIndex
+																			  : InvalidMeshIndex;
+				if(meshIndex != InvalidMeshIndex)
+					bounds += world[i] * _meshes[meshIndex].getBounds();
 			}
-		};
-		updateChildrenGlobalTransforms(node.globalTransform, node);
-		computeBounds();
-		_dirtyNodes.clear();
-		hierarchicalChanges = true;
+	};
+
+	const auto concurrency = updateConcurrency > 0 ? updateConcurrency : ThreadPool::GetInstance().getThreadCount() + 1;
+	if(!parallelUpdate || concurrency < 2 || nodeCount < ParallelUpdateThreshold) {
+		for(const auto index : _dirtyIndices)
+			updateRange(index, _hierarchy.subtreeEnd(index), _bounds);
+		return true;
 	}
 
-	return hierarchicalChanges;
+	// Ranges are a few times smaller than the share of each thread so they can be balanced. The heads have to be updated first, serially.
+	const auto maxRangeSize = std::max(1u, nodeCount / (4 * concurrency));
+	_updateHeads.clear();
+	_updateRanges.clear();
+	for(const auto index : _dirtyIndices)
+		_hierarchy.split(index, maxRangeSize, _updateHeads, _updateRanges);
+	for(const auto head : _updateHeads)
+		updateRange(head, head + 1, _bounds);
+
+	// Consecutive ranges are grouped into work items of about the same number of nodes, one per thread.
+	const auto			rangesSize = nodeCount - static_cast<uint32_t>(_updateHeads.size());
+	std::vector<Bounds> bounds(concurrency, _bounds);
+	{
+		ThreadPool::TaskQueue tasks;
+		size_t				  begin = 0;
+		uint64_t			  accumulated = 0;
+		for(uint32_t item = 0; item < concurrency && begin < _updateRanges.size(); ++item) {
+			auto end = begin;
+			while(end < _updateRanges.size() && (accumulated < (item + 1) * uint64_t{rangesSize} / concurrency || end == begin)) {
+				accumulated += _updateRanges[end].last - _updateRanges[end].first;
+				++end;
+			}
+			if(item + 1 == concurrency)
+				end = _updateRanges.size();
+			tasks.start([&, begin, end, item]() {
+				for(auto r = begin; r < end; ++r)
+					updateRange(_updateRanges[r].first, _updateRanges[r].last, bounds[item]);
+			});
+			begin = end;
+		}
+	}
+	for(const auto& b : bounds)
+		_bounds += b;
+	return true;
 }
 
 bool Scene::isAncestor(entt::entity ancestor, entt::entity entity) const {
@@ -984,32 +1627,65 @@ glm::mat4 Scene::getGlobalTransform(const NodeComponent& node) const {
 	return transform;
 }
 
-entt::entity Scene::intersectMeshNodes(const Ray& ray) {
-	Hit			 best;
-	entt::entity bestNode = entt::null;
-	const auto&	 meshes = getMeshes();
-	// FIXME: Uses base geometry of SkinnedMesh, which will lead to imprecise results
-	// Note: If we had cached/precomputed node bounds (without the need of meshes), we could speed this up a lot (basically an acceleration structure).
-	forEachNode([&](entt::entity entity, glm::mat4 transform) {
-		auto* mesh = _registry.try_get<MeshRendererComponent>(entity);
-		auto* skinnedMesh = _registry.try_get<SkinnedMeshRendererComponent>(entity);
-		if(auto meshIndex = mesh ? mesh->meshIndex : skinnedMesh ? skinnedMesh->meshIndex : InvalidMeshIndex; meshIndex != InvalidMeshIndex) {
-			auto hit = intersect(ray, transform * meshes[meshIndex].getBounds());
-			if(hit.hit && hit.depth < best.depth) {
-				Ray localRay = glm::inverse(transform) * ray;
-				hit = intersect(localRay, meshes[meshIndex]);
-				hit.depth = glm::length(glm::vec3(transform * glm::vec4((localRay.origin + localRay.direction * hit.depth), 1.0f)) - ray.origin);
-				if(hit.hit && hit.depth < best.depth) {
-					best = hit;
-					bestNode = entity;
-				}
-			}
+Scene::RaycastHit Scene::raycast(const Ray& ray) {
+	if(!_instanceBVHValid) {
+		_raycastInstances.clear();
+		for(auto&& [entity, renderer] : _registry.view<MeshRendererComponent>().each())
+			if(renderer.meshIndex != InvalidMeshIndex && _registry.all_of<NodeComponent>(entity))
+				_raycastInstances.push_back({entity, renderer.meshIndex});
+		for(auto&& [entity, renderer] : _registry.view<SkinnedMeshRendererComponent>().each())
+			if(renderer.meshIndex != InvalidMeshIndex && _registry.all_of<NodeComponent>(entity))
+				_raycastInstances.push_back({entity, renderer.meshIndex});
+		updateRaycastInstanceBounds();
+		_instanceBVH.build(_raycastInstanceBounds, 1);
+		_instanceBVHValid = true;
+		_instanceBVHMoved = false;
+	} else if(_instanceBVHMoved) {
+		updateRaycastInstanceBounds();
+		_instanceBVH.refit(_raycastInstanceBounds);
+		_instanceBVHMoved = false;
+	}
+
+	RaycastHit result;
+	_instanceBVH.traverse(ray, result.depth, [&](uint32_t slot, float& maxDepth) {
+		const auto& instance = _raycastInstances[_instanceBVH.getPrimitives()[slot]];
+		const auto	inverse = glm::inverse(_registry.get<NodeComponent>(instance.entity).globalTransform);
+		// The direction is not normalized: Depths are the same in both spaces.
+		const Ray	 localRay{.origin = glm::vec3(inverse * glm::vec4(ray.origin, 1.0f)), .direction = glm::mat3(inverse) * ray.direction};
+		MeshBVH::Hit hit{.depth = maxDepth};
+		if(getMeshBVH(instance.mesh).intersect(localRay, hit)) {
+			maxDepth = hit.depth;
+			result.entity = instance.entity;
+			result.triangle = hit.triangle;
+			result.barycentrics = hit.barycentrics;
 		}
 	});
-	return bestNode;
+	return result;
+}
+
+void Scene::invalidateMeshBVH(MeshIndex index) {
+	if(index < _meshBVHs.size())
+		_meshBVHs[index].reset();
+	_instanceBVHMoved = true; // Bounds of the instances of the mesh may have changed
+}
+
+const MeshBVH& Scene::getMeshBVH(MeshIndex index) {
+	if(_meshBVHs.size() < _meshes.size())
+		_meshBVHs.resize(_meshes.size());
+	auto& bvh = _meshBVHs[index];
+	if(!bvh || !bvh->isUpToDate(_meshes[index]))
+		bvh = std::make_unique<MeshBVH>(_meshes[index]);
+	return *bvh;
+}
+
+void Scene::updateRaycastInstanceBounds() {
+	_raycastInstanceBounds.resize(_raycastInstances.size());
+	for(size_t i = 0; i < _raycastInstances.size(); ++i)
+		_raycastInstanceBounds[i] = _registry.get<NodeComponent>(_raycastInstances[i].entity).globalTransform * _meshes[_raycastInstances[i].mesh].getBounds();
 }
 
 void Scene::removeFromHierarchy(entt::entity entity) {
+	_hierarchy.invalidate();
 	auto& node = _registry.get<NodeComponent>(entity);
 	if(node.prev != entt::null)
 		_registry.get<NodeComponent>(node.prev).next = node.next;
@@ -1031,6 +1707,7 @@ void Scene::addChild(entt::entity parent, entt::entity child) {
 	auto& parentNode = _registry.get<NodeComponent>(parent);
 	auto& childNode = _registry.get<NodeComponent>(child);
 	assert(childNode.parent == entt::null); // We should probably handle this case, but we don't right now!
+	_hierarchy.invalidate();
 	if(parentNode.first == entt::null) {
 		parentNode.first = child;
 	} else {
@@ -1043,8 +1720,7 @@ void Scene::addChild(entt::entity parent, entt::entity child) {
 	}
 	childNode.parent = parent;
 	++parentNode.children;
-	markDirty(parent);
-	markDirty(child);
+	markDirty(child); // The transform of parent is unchanged
 }
 
 void Scene::addSibling(entt::entity target, entt::entity other) {
@@ -1052,6 +1728,7 @@ void Scene::addSibling(entt::entity target, entt::entity other) {
 	auto& targetNode = _registry.get<NodeComponent>(target);
 	auto& otherNode = _registry.get<NodeComponent>(other);
 	assert(otherNode.parent == entt::null); // We should probably handle this case, but we don't right now!
+	_hierarchy.invalidate();
 	auto& parentNode = _registry.get<NodeComponent>(targetNode.parent);
 	++parentNode.children;
 	otherNode.parent = targetNode.parent;
@@ -1062,6 +1739,66 @@ void Scene::addSibling(entt::entity target, entt::entity other) {
 	targetNode.next = other;
 }
 
+void Scene::sortNodes() {
+	if(!_hierarchy.isValid())
+		_hierarchy.rebuild(_registry, _root);
+	// Nodes detached from the root (InvalidIndex) end up last.
+	_registry.sort<NodeComponent>([&](entt::entity lhs, entt::entity rhs) { return _hierarchy.indexOf(lhs) < _hierarchy.indexOf(rhs); });
+	_hierarchy.invalidate(); // Components were moved
+}
+
+void Scene::HierarchyBuilder::addChild(entt::entity parent, entt::entity child) {
+	assert(parent != child);
+	auto& registry = _scene._registry;
+	auto& parentNode = registry.get<NodeComponent>(parent);
+	auto& childNode = registry.get<NodeComponent>(child);
+	assert(childNode.parent == entt::null);
+	_scene._hierarchy.invalidate();
+
+	// The children of parent may have been modified since the last one was linked here (e.g. between the batches of an asynchronous load).
+	auto [it, inserted] = _lastChildren.try_emplace(parent, entt::null);
+	auto& lastChild = it->second;
+	if(inserted || !registry.valid(lastChild) || registry.get<NodeComponent>(lastChild).parent != parent)
+		lastChild = parentNode.first;
+	if(lastChild != entt::null)
+		while(registry.get<NodeComponent>(lastChild).next != entt::null)
+			lastChild = registry.get<NodeComponent>(lastChild).next;
+
+	if(lastChild == entt::null) {
+		parentNode.first = child;
+	} else {
+		registry.get<NodeComponent>(lastChild).next = child;
+		childNode.prev = lastChild;
+	}
+	childNode.parent = parent;
+	++parentNode.children;
+	lastChild = child;
+	_linked.push_back(child);
+	_linkedSet.insert(child);
+}
+
+void Scene::HierarchyBuilder::addChildren(entt::entity parent, std::span<const entt::entity> children) {
+	for(const auto child : children)
+		addChild(parent, child);
+}
+
+void Scene::HierarchyBuilder::finish(bool sortDepthFirst) {
+	auto& registry = _scene._registry;
+	for(const auto entity : _linked)
+		if(const auto* node = registry.try_get<NodeComponent>(entity); node && !_linkedSet.contains(node->parent))
+			_scene.markDirty(entity);
+	_linked.clear();
+	_linkedSet.clear();
+
+	if(sortDepthFirst)
+		_scene.sortNodes();
+}
+
+void Scene::onConstructNodeComponent(entt::registry&, entt::entity) {
+	// The loaders link the new nodes directly, and the hierarchy holds pointers into the storage.
+	_hierarchy.invalidate();
+}
+
 void Scene::onDestroyNodeComponent(entt::registry& registry, entt::entity entity) {
 	auto& node = registry.get<NodeComponent>(entity);
 	print("Scene::onDestroyNodeComponent '{}' ({})\n", node.name, entity);
@@ -1,15 +1,27 @@
 #pragma once
 
+#include <atomic>
 #include <filesystem>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <entt/entt.hpp>
 
+#include <BVH.hpp>
+#include <JSONDocument.hpp>
 #include <Mesh.hpp>
+#include <MeshOptimizer.hpp>
 #include <Raytracing.hpp>
 #include <RollingBuffer.hpp>
 #include <TaggedType.hpp>
+#include <TransformHierarchy.hpp>
 #include <Undoable.hpp>
 
+class MappedFile;
+class SceneFile;
+
 // TODO: Move this :)
 inline std::vector<Material> Materials;
 
@@ -31,6 +43,7 @@ struct SkinIndexTag {};
 using SkinIndex = TaggedIndex<uint32_t, SkinIndexTag>;
 inline static const SkinIndex InvalidSkinIndex{static_cast<uint32_t>(-1)};
 
+// Change meshIndex through registry.patch or replace: The scene caches the mesh of each instance (see raycast).
 struct MeshRendererComponent {
 	MeshIndex	  meshIndex = InvalidMeshIndex; // FIXME: Use something else.
 	MaterialIndex materialIndex = InvalidMaterialIndex;
@@ -90,7 +103,52 @@ class Scene {
 	bool loadMaterial(const std::filesystem::path& path);
 	bool loadScene(const std::filesystem::path& path);
 
-	bool save(const std::filesystem::path& path);
+	// Writes a version 2 scene file (see SceneFile.hpp). The materials and textures document uses the binary JSON encoding by default (see JSONBinary.hpp),
+	// text JSON remains readable by loadScene. loadScene also reads version 0 files.
+	bool save(const std::filesystem::path& path, bool binaryJSON = true);
+	// Appends the selected meshes of a scene file (all of them if selection is empty) and returns their indices. Only the chunks of these meshes are read,
+	// in parallel. Their default material indices are offset by materialOffset (index of the first material of the file in Materials).
+	std::vector<MeshIndex> loadMeshes(const SceneFile& file, std::span<const uint32_t> selection = {}, uint32_t materialOffset = 0);
+
+	class LoadHandle;
+	// Asynchronous loading: The file is loaded by a task of the ThreadPool into a private staging scene (it doesn't access this scene or the global resources),
+	// its content is then merged into this scene, in batches, by publishLoads. Loaded files are always appended (.scene files don't replace the current scene).
+	LoadHandle loadAsync(const std::filesystem::path& path);
+	// Maximum number of meshes and nodes merged by a call to publishLoads. Materials and textures of a file are published at once, before its meshes;
+	// skins and animations once all its nodes are.
+	struct PublishBudget {
+		size_t meshes = 64;
+		size_t nodes = 4096;
+	};
+	// What a call to publishLoads merged into the scene, e.g. to upload only the new meshes to the GPU.
+	struct PublishResult {
+		bool   resources = false; // Materials or textures were added
+		bool   meshes = false;	  // Meshes [firstMesh, getMeshes().size()) were added
+		size_t firstMesh = 0;
+		bool   nodes = false;	 // Nodes (and their renderers) were added
+		bool   finished = false; // At least one load was finalized: Skins, animations and skinned renderers were added, nodes may have been sorted.
+
+		explicit operator bool() const { return resources || meshes || nodes || finished; }
+	};
+	// Merges the next batches of the parsed asynchronous loads into the scene, to be called at a safe point of the main loop (no concurrent access to the scene
+	// or to the global resources). The result converts to true if the scene or the resources were modified.
+	PublishResult			publishLoads(const PublishBudget& budget);
+	inline PublishResult	publishLoads() { return publishLoads(PublishBudget{}); }
+	inline bool				isLoading() const { return !_loads.empty(); }
+	std::vector<LoadHandle> getLoads() const;
+
+	// Meshes imported by loadglTF and loadOBJ are deduplicated, then reordered for the GPU caches (see MeshOptimizer.hpp). .scene files are saved already processed.
+	bool				   deduplicateImportedMeshes = true;
+	bool				   optimizeImportedMeshes = true;
+	MeshOptimizer::Options meshOptimizerOptions;
+	// Meshes [firstMesh, getMeshes().size()) with the same geometry as another mesh of the scene are removed: Their renderers now point to the first instance.
+	// The remaining meshes are moved down to fill the gaps. Meshes already present are never removed.
+	// Returns the number of meshes removed.
+	size_t deduplicateMeshes(size_t firstMesh = 0);
+	// Adds the meshes [firstMesh, getMeshes().size()) to the candidates of deduplicateMeshes, without removing any of them (e.g. the meshes of a saved scene).
+	void registerMeshes(size_t firstMesh = 0);
+	// Optimizes the meshes [firstMesh, getMeshes().size()) in parallel, returns their accumulated vertex cache statistics.
+	MeshOptimizer::Report optimizeMeshes(size_t firstMesh = 0);
 
 	inline entt::registry&			   getRegistry() { return _registry; }
 	inline const entt::registry&	   getRegistry() const { return _registry; }
@@ -101,18 +159,44 @@ class Scene {
 	inline std::vector<Skin>&		   getSkins() { return _skins; }
 	inline const std::vector<Skin>&	   getSkins() const { return _skins; }
 
+	// The global transforms of node and its descendants will be updated by the next call to update.
 	inline void markDirty(entt::entity node) { _dirtyNodes.push_back(node); }
-	bool		update(float deltaTime);
+	// Updates the global transforms of the dirty subtrees only (nodes detached from the root are ignored). Returns true if any node was updated.
+	bool update(float deltaTime);
+	// Large updates (at least ParallelUpdateThreshold nodes) are split into balanced independent work items and run on the ThreadPool.
+	static constexpr uint32_t ParallelUpdateThreshold = 16 * 1024;
+	bool					  parallelUpdate = true;
+	uint32_t				  updateConcurrency = 0; // Maximum number of threads working on a parallel update, the calling one included. 0: All threads of the pool.
 
 	void removeFromHierarchy(entt::entity);
+	// Appends child to the children of parent. Walks the children of parent: Use a HierarchyBuilder to link many nodes.
 	void addChild(entt::entity parent, entt::entity child);
 	void addSibling(entt::entity target, entt::entity other);
+	class HierarchyBuilder;
+	// Sorts the NodeComponent storage in depth-first order, for the locality of the traversals of the hierarchy.
+	void sortNodes();
+	// Sort the nodes once a file is loaded.
+	bool sortImportedNodes = true;
 
 	bool	  isAncestor(entt::entity ancestor, entt::entity entity) const;
 	glm::mat4 getGlobalTransform(const NodeComponent& node) const;
 
-	entt::entity intersectMeshNodes(const Ray& ray);
-
+	struct RaycastHit {
+		entt::entity entity = entt::null;
+		float		 depth = std::numeric_limits<float>::max(); // Along the direction of the ray (a distance if it is normalized)
+		uint32_t	 triangle = 0;							   // In the mesh of entity
+		glm::vec2	 barycentrics{0.0f};					   // Weights of the second and third vertices of the triangle
+		inline bool	 hit() const { return entity != entt::null; }
+	};
+	// Closest intersection with the meshes of the scene (base geometry of the skinned ones), using the global transforms of the last update.
+	// Like the GPU acceleration structures, there's a BVH per mesh (built on first use and cached) and one over the world bounds of the mesh instances
+	// (rebuilt when renderers are added or removed, refitted after an update that moved nodes).
+	RaycastHit	 raycast(const Ray& ray);
+	entt::entity intersectMeshNodes(const Ray& ray) { return raycast(ray).entity; }
+	// Meshes whose vertices or indices are modified in place (same buffers and bounds) have to be invalidated explicitly.
+	void invalidateMeshBVH(MeshIndex index);
+
+	// Conservative: update() grows them to include the moved meshes, but never shrinks them. See computeBounds for the exact bounds.
 	inline const Bounds& getBounds() const { return _bounds; }
 	inline void			 setBounds(const Bounds& b) { _bounds = b; }
 	const Bounds&		 computeBounds();
@@ -133,25 +217,124 @@ class Scene {
 	void free();
 
   private:
+	struct AsyncLoad;
+
 	std::vector<Mesh> _meshes;
 	std::vector<Skin> _skins;
+	// Content hash to meshes, see deduplicateMeshes. Hashes can collide (and meshes can be edited after their insertion): Candidates are compared before being shared.
+	std::unordered_multimap<uint64_t, MeshIndex> _meshHashes;
 
 	entt::registry			  _registry;
 	entt::entity			  _root = entt::null;
-	std::vector<entt::entity> _dirtyNodes; // FIXME: May not be useful anymore.
+	std::vector<entt::entity> _dirtyNodes;
+	// Rebuilt by update() after structural changes of the hierarchy.
+	TransformHierarchy	  _hierarchy;
+	std::vector<uint32_t> _dirtyIndices; // Kept to avoid reallocating it every frame
+	// Work of the parallel updates, see TransformHierarchy::split
+	std::vector<uint32_t>					 _updateHeads;
+	std::vector<TransformHierarchy::Range> _updateRanges;
 
 	Bounds				 _bounds;
 	RollingBuffer<float> _updateTimes;
 
-	bool loadMaterial(const JSON::value& mat, uint32_t textureOffset);
-	bool loadTextures(const std::filesystem::path& path, const JSON::value& json);
-
+	// Ray queries, see raycast
+	struct RaycastInstance {
+		entt::entity entity;
+		MeshIndex	 mesh;
+	};
+	std::vector<std::unique_ptr<MeshBVH>> _meshBVHs; // By MeshIndex
+	std::vector<RaycastInstance>		  _raycastInstances;
+	std::vector<Bounds>					  _raycastInstanceBounds;
+	BVH									  _instanceBVH;
+	bool								  _instanceBVHValid = false;
+	bool								  _instanceBVHMoved = false; // Has to be refitted
+	const MeshBVH&						  getMeshBVH(MeshIndex index);
+	void								  updateRaycastInstanceBounds();
+
+	// Resources written by the loaders: The global ones, or those of the load when this is the staging scene of an asynchronous load.
+	std::vector<Material>*				_materials = &Materials;
+	std::vector<Texture>*				_textures = &Textures;
+	std::vector<SkeletalAnimationClip>* _animations = &Animations;
+
+	std::vector<std::shared_ptr<AsyncLoad>> _loads; // Not finished yet
+	void									publish(AsyncLoad& load, PublishBudget& budget, PublishResult& result);
+
+	bool loadMaterial(const JSON::Document::Node& mat, uint32_t textureOffset);
+	bool loadSceneV0(const MappedFile& file, const std::filesystem::path& path);
+	bool loadSceneV2(const SceneFile& file, const std::filesystem::path& path);
+	bool loadTextures(const std::filesystem::path& path, const JSON::Document::Node& json);
+	// Content hashes of the meshes [firstMesh, getMeshes().size()), computed in parallel.
+	std::vector<uint64_t> computeMeshHashes(size_t firstMesh) const;
+
+	// Called on construction, update or destruction of the MeshRendererComponent and SkinnedMeshRendererComponent
+	inline void onRendererChange(entt::registry&, entt::entity) { _instanceBVHValid = false; }
+	// Called on NodeComponent construction
+	void onConstructNodeComponent(entt::registry& registry, entt::entity node);
 	// Called on NodeComponent destruction
 	void onDestroyNodeComponent(entt::registry& registry, entt::entity node);
 	// Used for depth-first traversal of the node hierarchy
 	void visitNode(entt::entity entity, glm::mat4 transform, const std::function<void(entt::entity entity, glm::mat4)>& call);
 };
 
+// Progress and control of an asynchronous load (see Scene::loadAsync). Handles can be freely copied and outlive the load (or the scene).
+class Scene::LoadHandle {
+  public:
+	enum class State {
+		Parsing,	// Loading in the staging scene
+		Publishing, // Waiting for, or being merged by, Scene::publishLoads
+		Done,
+		Failed,
+		Cancelled
+	};
+
+	LoadHandle() = default;
+
+	inline bool					 isValid() const { return _load != nullptr; }
+	State						 getState() const;
+	bool						 isFinished() const;
+	const std::filesystem::path& getPath() const;
+	// Coarse while parsing (the file loaders don't report their progress): [0, 0.5[ while parsing, then proportional to the published meshes and nodes.
+	float getProgress() const;
+	// Number of meshes of the file now available in the scene (including those shared with already loaded meshes).
+	size_t getPublishedMeshes() const;
+	// Nothing more will be published. Elements already merged stay in the scene. A parse in progress is abandoned at its next stage.
+	void cancel();
+
+  private:
+	std::shared_ptr<Scene::AsyncLoad> _load;
+
+	explicit LoadHandle(std::shared_ptr<Scene::AsyncLoad> load) : _load(std::move(load)) {}
+	friend class Scene;
+};
+
+// Links nodes in bulk (importers), in time linear in the number of linked nodes: The last child of each parent is tracked instead of being searched
+// for each new child. Nodes are linked immediately, but they're only marked dirty by finish, which can be called after each batch.
+class Scene::HierarchyBuilder {
+  public:
+	explicit HierarchyBuilder(Scene& scene) : _scene(scene) {}
+	~HierarchyBuilder() { finish(); }
+
+	// child must not be in the hierarchy yet. Children are appended after the existing ones, in order.
+	void addChild(entt::entity parent, entt::entity child);
+	void addChildren(entt::entity parent, std::span<const entt::entity> children);
+	// children are indices into entities.
+	template<typename Index>
+	void addChildren(entt::entity parent, std::span<const Index> children, std::span<const entt::entity> entities) {
+		for(const auto index : children)
+			addChild(parent, entities[static_cast<size_t>(index)]);
+	}
+
+	// Marks the top-level nodes linked since the last call dirty (those whose parent wasn't linked by this builder in the meantime), and optionally
+	// sorts the nodes of the scene (see Scene::sortNodes).
+	void finish(bool sortDepthFirst = false);
+
+  private:
+	Scene&										   _scene;
+	std::unordered_map<entt::entity, entt::entity> _lastChildren; // By parent
+	std::vector<entt::entity>					   _linked;		  // Since the last call to finish
+	std::unordered_set<entt::entity>			   _linkedSet;
+};
+
 JSON::value toJSON(const NodeComponent&);
 
 class NodeTransformModification : public Undoable {
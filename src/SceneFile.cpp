@@ -0,0 +1,184 @@
+#include "SceneFile.hpp"
+
+#include <fstream>
+
+#include <Logger.hpp>
+
+using namespace SceneFormat;
+
+static uint64_t alignUp(uint64_t offset) {
+	return (offset + ChunkAlignment - 1) & ~static_cast<uint64_t>(ChunkAlignment - 1);
+}
+
+bool SceneFile::open(const std::filesystem::path& path) {
+	MappedFile file;
+	if(!file.open(path, MappedFile::Access::Random))
+		return false;
+	return open(std::move(file), path);
+}
+
+bool SceneFile::open(MappedFile&& file, const std::filesystem::path& path) {
+	_file = std::move(file);
+	_chunks = {};
+	_meshes = {};
+	_entities = {};
+	_strings = {};
+	if(!validate(path)) {
+		_file.close();
+		return false;
+	}
+	return true;
+}
+
+bool SceneFile::validate(const std::filesystem::path& path) {
+	if(_file.size() < sizeof(Header)) {
+		error("SceneFile: '{}' is too small to be a scene file.\n", path.string());
+		return false;
+	}
+	const auto& header = getHeader();
+	if(header.magic != Magic || header.version != Version) {
+		error("SceneFile: '{}' is not a version {} scene file (magic: {:#x}, version: {}).\n", path.string(), Version, header.magic, header.version);
+		return false;
+	}
+	if(header.length > _file.size() || header.tocOffset % alignof(ChunkEntry) != 0 || header.tocOffset > header.length ||
+	   (header.length - header.tocOffset) / sizeof(ChunkEntry) < header.chunkCount) {
+		error("SceneFile: '{}' is truncated or its table of contents is corrupted.\n", path.string());
+		return false;
+	}
+	_chunks = {reinterpret_cast<const ChunkEntry*>(_file.data() + header.tocOffset), header.chunkCount};
+
+	for(size_t i = 0; i < _chunks.size(); ++i) {
+		const auto& chunk = _chunks[i];
+		if(chunk.offset % ChunkAlignment != 0 || chunk.offset > header.length || chunk.size > header.length - chunk.offset || chunk.elementSize == 0 ||
+		   chunk.size % chunk.elementSize != 0) {
+			error("SceneFile: Chunk {} of '{}' is out-of-bounds or misaligned.\n", i, path.string());
+			return false;
+		}
+	}
+
+	// Chunks with a fixed layout: Element sizes not matching the current structures means that the file was written by an incompatible version.
+	bool	   layoutMismatch = false;
+	const auto checkedChunk = [&](ChunkType type, size_t elementSize) -> uint32_t {
+		const auto* chunk = find(type);
+		if(!chunk)
+			return InvalidIndex;
+		if(chunk->elementSize != elementSize) {
+			error("SceneFile: Unexpected element size for chunk '{}' of '{}' ({}, expected {}).\n", std::string_view{reinterpret_cast<const char*>(&chunk->type), 4},
+				  path.string(), chunk->elementSize, elementSize);
+			layoutMismatch = true;
+			return InvalidIndex;
+		}
+		return static_cast<uint32_t>(chunk - _chunks.data());
+	};
+	_meshes = get<MeshRecord>(checkedChunk(ChunkType::Meshes, sizeof(MeshRecord)));
+	_entities = get<EntityRecord>(checkedChunk(ChunkType::Entities, sizeof(EntityRecord)));
+	if(layoutMismatch)
+		return false;
+	if(const auto* chunk = find(ChunkType::Strings); chunk)
+		_strings = {_file.data() + chunk->offset, chunk->size};
+
+	const auto checkChunkIndex = [&](uint32_t chunkIndex, ChunkType type, size_t elementSize) {
+		return chunkIndex == InvalidIndex || (chunkIndex < _chunks.size() && _chunks[chunkIndex].type == type && _chunks[chunkIndex].elementSize == elementSize);
+	};
+	for(size_t i = 0; i < _meshes.size(); ++i) {
+		const auto& m = _meshes[i];
+		if(!checkChunkIndex(m.vertexChunk, ChunkType::Vertices, sizeof(Vertex)) || !checkChunkIndex(m.indexChunk, ChunkType::Indices, sizeof(uint32_t)) ||
+		   !checkChunkIndex(m.skinWeightsChunk, ChunkType::SkinWeights, sizeof(glm::vec4)) ||
+		   !checkChunkIndex(m.skinJointsChunk, ChunkType::SkinJoints, sizeof(JointIndices)) || static_cast<uint64_t>(m.nameOffset) + m.nameLength > _strings.size()) {
+			error("SceneFile: Mesh {} of '{}' references invalid chunks.\n", i, path.string());
+			return false;
+		}
+	}
+	for(size_t i = 0; i < _entities.size(); ++i) {
+		const auto& e = _entities[i];
+		const auto	validEntity = [&](uint32_t index) { return index == InvalidIndex || index < _entities.size(); };
+		if(!validEntity(e.parent) || !validEntity(e.firstChild) || !validEntity(e.nextSibling) || (e.meshIndex != InvalidIndex && e.meshIndex >= _meshes.size()) ||
+		   static_cast<uint64_t>(e.nameOffset) + e.nameLength > _strings.size()) {
+			error("SceneFile: Entity {} of '{}' is invalid.\n", i, path.string());
+			return false;
+		}
+	}
+	return true;
+}
+
+bool SceneFile::validateMaterials(size_t materialCount, const std::filesystem::path& path) const {
+	const auto validMaterial = [&](uint32_t index) { return index == InvalidIndex || index < materialCount; };
+	for(size_t i = 0; i < _meshes.size(); ++i)
+		if(!validMaterial(_meshes[i].defaultMaterial)) {
+			error("SceneFile: Mesh {} of '{}' references an invalid material ({}, {} materials).\n", i, path.string(), _meshes[i].defaultMaterial, materialCount);
+			return false;
+		}
+	for(size_t i = 0; i < _entities.size(); ++i)
+		if(_entities[i].meshIndex != InvalidIndex && !validMaterial(_entities[i].materialIndex)) {
+			error("SceneFile: Entity {} of '{}' references an invalid material ({}, {} materials).\n", i, path.string(), _entities[i].materialIndex, materialCount);
+			return false;
+		}
+	return true;
+}
+
+const ChunkEntry* SceneFile::find(ChunkType type, uint32_t index) const {
+	for(const auto& chunk : _chunks)
+		if(chunk.type == type && chunk.index == index)
+			return &chunk;
+	return nullptr;
+}
+
+std::string_view SceneFile::getDocument(ChunkType& type) const {
+	for(const auto& chunk : _chunks)
+		if(chunk.type == ChunkType::JSON || chunk.type == ChunkType::BJSN) {
+			type = chunk.type;
+			return {_file.data() + chunk.offset, chunk.size};
+		}
+	return {};
+}
+
+uint32_t SceneFileWriter::add(ChunkType type, std::span<const char> data, uint32_t elementSize, uint32_t index) {
+	_chunks.push_back(ChunkEntry{
+		.type = type,
+		.index = index,
+		.size = data.size(),
+		.elementSize = elementSize,
+	});
+	_data.push_back(data);
+	return static_cast<uint32_t>(_chunks.size() - 1);
+}
+
+bool SceneFileWriter::write(const std::filesystem::path& path) const {
+	std::ofstream file(path, std::ios::binary);
+	if(!file) {
+		error("SceneFileWriter: Could not open '{}' for writing.\n", path.string());
+		return false;
+	}
+
+	// Header, table of contents, then the chunks in order of insertion, each padded to ChunkAlignment.
+	Header header{
+		.tocOffset = alignUp(sizeof(Header)),
+		.chunkCount = static_cast<uint32_t>(_chunks.size()),
+	};
+	auto	 chunks = _chunks;
+	uint64_t offset = alignUp(header.tocOffset + sizeof(ChunkEntry) * chunks.size());
+	for(auto& chunk : chunks) {
+		chunk.offset = offset;
+		offset = alignUp(offset + chunk.size);
+	}
+	header.length = offset;
+
+	static const char padding[ChunkAlignment]{};
+	uint64_t		  written = 0;
+	const auto		  writeAt = [&](uint64_t position, const char* data, size_t size) {
+		 file.write(padding, static_cast<std::streamsize>(position - written));
+		 file.write(data, static_cast<std::streamsize>(size));
+		 written = position + size;
+	};
+	writeAt(0, reinterpret_cast<const char*>(&header), sizeof(header));
+	writeAt(header.tocOffset, reinterpret_cast<const char*>(chunks.data()), sizeof(ChunkEntry) * chunks.size());
+	for(size_t i = 0; i < chunks.size(); ++i)
+		writeAt(chunks[i].offset, _data[i].data(), _data[i].size());
+	writeAt(header.length, nullptr, 0);
+
+	if(!file) {
+		error("SceneFileWriter: Error while writing '{}'.\n", path.string());
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+
+#include <MappedFile.hpp>
+#include <Mesh.hpp>
+
+// Version 2 of the .scene format (see README), designed to be memory mapped and accessed randomly:
+//  - A fixed size header followed by a table of contents describing every chunk (type, owner, offset, size and element size).
+//  - Every chunk starts on a ChunkAlignment boundary: Arrays of Vertex, indices or records can be used in place, straight from the mapping.
+//  - Meshes and entities are stored in flat binary tables. Only materials and textures are still described by a (binary) JSON document.
+// Version 0 files (JSON document followed by unaligned BIN chunks) are still read by Scene::loadScene.
+namespace SceneFormat {
+
+constexpr uint32_t fourCC(const char (&str)[5]) {
+	return static_cast<uint32_t>(str[0]) | (static_cast<uint32_t>(str[1]) << 8) | (static_cast<uint32_t>(str[2]) << 16) | (static_cast<uint32_t>(str[3]) << 24);
+}
+
+inline constexpr uint32_t Magic = fourCC("SCEN");
+inline constexpr uint32_t Version = 2;
+inline constexpr uint32_t ChunkAlignment = 64;		 // Cache line, satisfies the alignment of all the stored types
+inline constexpr uint32_t InvalidIndex = 0xFFFFFFFF; // Missing chunk, entity or mesh
+
+enum class ChunkType : uint32_t {
+	JSON = fourCC("JSON"),		   // Materials and textures, as JSON text
+	BJSN = fourCC("BJSN"),		   // Same document, using the binary encoding of JSONBinary.hpp
+	Strings = fourCC("STRS"),	   // UTF-8 names referenced by the mesh and entity records (offset, length), not null terminated
+	Meshes = fourCC("MESH"),	   // MeshRecord[]
+	Entities = fourCC("ENTS"),	   // EntityRecord[]
+	Vertices = fourCC("VERT"),	   // Vertex[], owned by the mesh 'index'
+	Indices = fourCC("INDX"),	   // uint32_t[], owned by the mesh 'index'
+	SkinWeights = fourCC("SKNW"), // glm::vec4[], owned by the mesh 'index'
+	SkinJoints = fourCC("SKNJ"),  // JointIndices[], owned by the mesh 'index'
+	Keyframes = fourCC("KEYF"),	   // Reserved: Animations are not saved yet.
+};
+
+struct Header {
+	uint32_t magic = Magic;
+	uint32_t version = Version; // Same location as in version 0
+	uint64_t length = 0;		// Total file length, in bytes
+	uint64_t tocOffset = 0;		// ChunkEntry[chunkCount]
+	uint32_t chunkCount = 0;
+	uint32_t reserved = 0;
+};
+static_assert(sizeof(Header) == 32);
+
+struct ChunkEntry {
+	ChunkType type;
+	uint32_t  index = 0; // Owner (e.g. mesh index) of per-mesh chunks, 0 otherwise
+	uint64_t  offset = 0;
+	uint64_t  size = 0;		   // In bytes
+	uint32_t  elementSize = 1; // size is a multiple of it, allows the loader to reject chunks written with a different layout
+	uint32_t  reserved = 0;
+};
+static_assert(sizeof(ChunkEntry) == 32);
+
+struct MeshRecord {
+	enum Flags : uint32_t {
+		Dynamic = 1 << 0,
+		Skinned = 1 << 1,
+	};
+	uint32_t  nameOffset = 0;
+	uint32_t  nameLength = 0;
+	uint32_t  defaultMaterial = 0;
+	uint32_t  flags = 0;
+	uint32_t  vertexChunk = InvalidIndex; // Indices into the table of contents
+	uint32_t  indexChunk = InvalidIndex;
+	uint32_t  skinWeightsChunk = InvalidIndex;
+	uint32_t  skinJointsChunk = InvalidIndex;
+	glm::vec3 boundsMin;
+	glm::vec3 boundsMax;
+};
+static_assert(sizeof(MeshRecord) == 56);
+
+// Node hierarchy, as indices into the entity table. Children are linked in order through nextSibling.
+struct EntityRecord {
+	glm::mat4 transform;
+	uint32_t  nameOffset = 0;
+	uint32_t  nameLength = 0;
+	uint32_t  parent = InvalidIndex;
+	uint32_t  firstChild = InvalidIndex;
+	uint32_t  nextSibling = InvalidIndex;
+	uint32_t  childCount = 0;
+	uint32_t  meshIndex = InvalidIndex; // MeshRendererComponent, if meshIndex != InvalidIndex
+	uint32_t  materialIndex = InvalidIndex;
+};
+static_assert(sizeof(EntityRecord) == 96);
+
+} // namespace SceneFormat
+
+// Read-only view of a version 2 .scene file. The whole file is validated on opening (bounds, alignment and element sizes of all the chunks),
+// the accessors then return views directly into the mapping: Nothing is copied, and only the pages actually accessed are read from disk.
+class SceneFile {
+  public:
+	SceneFile() = default;
+	SceneFile(const SceneFile&) = delete;
+	SceneFile(SceneFile&&) noexcept = default;
+
+	bool open(const std::filesystem::path& path);
+	// Takes ownership of an already opened file (e.g. after checking its version).
+	bool open(MappedFile&& file, const std::filesystem::path& path);
+	// Material indices of the mesh and entity records against the materials of the document, which are only known once it is parsed (open can't check them).
+	bool validateMaterials(size_t materialCount, const std::filesystem::path& path) const;
+
+	inline const MappedFile&					  getFile() const { return _file; }
+	inline const SceneFormat::Header&			  getHeader() const { return *reinterpret_cast<const SceneFormat::Header*>(_file.data()); }
+	inline std::span<const SceneFormat::ChunkEntry> getChunks() const { return _chunks; }
+	// First chunk of this type and owner, or nullptr.
+	const SceneFormat::ChunkEntry* find(SceneFormat::ChunkType type, uint32_t index = 0) const;
+
+	template<typename T>
+	std::span<const T> get(uint32_t chunkIndex) const {
+		if(chunkIndex == SceneFormat::InvalidIndex)
+			return {};
+		const auto& chunk = _chunks[chunkIndex];
+		assert(chunk.elementSize == sizeof(T));
+		return {reinterpret_cast<const T*>(_file.data() + chunk.offset), static_cast<size_t>(chunk.size / sizeof(T))};
+	}
+
+	// Materials and textures document, either JSON or BJSN (see type).
+	std::string_view getDocument(SceneFormat::ChunkType& type) const;
+
+	inline std::span<const SceneFormat::MeshRecord>	  getMeshes() const { return _meshes; }
+	inline std::span<const SceneFormat::EntityRecord> getEntities() const { return _entities; }
+	inline std::string_view							  getString(uint32_t offset, uint32_t length) const { return _strings.substr(offset, length); }
+
+	inline std::span<const Vertex>		 getVertices(const SceneFormat::MeshRecord& m) const { return get<Vertex>(m.vertexChunk); }
+	inline std::span<const uint32_t>	 getIndices(const SceneFormat::MeshRecord& m) const { return get<uint32_t>(m.indexChunk); }
+	inline std::span<const glm::vec4>	 getSkinWeights(const SceneFormat::MeshRecord& m) const { return get<glm::vec4>(m.skinWeightsChunk); }
+	inline std::span<const JointIndices> getSkinJoints(const SceneFormat::MeshRecord& m) const { return get<JointIndices>(m.skinJointsChunk); }
+
+  private:
+	MappedFile								 _file;
+	std::span<const SceneFormat::ChunkEntry> _chunks;
+	std::span<const SceneFormat::MeshRecord>	 _meshes;
+	std::span<const SceneFormat::EntityRecord> _entities;
+	std::string_view						 _strings;
+
+	bool validate(const std::filesystem::path& path);
+};
+
+// Lays out the chunks of a version 2 .scene file. Chunks data is referenced, not copied: It must stay valid until write() returns.
+class SceneFileWriter {
+  public:
+	// Returns the index of the chunk in the table of contents.
+	uint32_t add(SceneFormat::ChunkType type, std::span<const char> data, uint32_t elementSize = 1, uint32_t index = 0);
+	template<typename T>
+	uint32_t add(SceneFormat::ChunkType type, std::span<T> data, uint32_t index = 0) {
+		return add(type, {reinterpret_cast<const char*>(data.data()), data.size_bytes()}, static_cast<uint32_t>(sizeof(T)), index);
+	}
+
+	bool write(const std::filesystem::path& path) const;
+
+  private:
+	std::vector<SceneFormat::ChunkEntry> _chunks;
+	std::vector<std::span<const char>>	 _data;
+};
@@ -5,6 +5,7 @@
 #include <glm/gtx/quaternion.hpp>
 
 #include <JSON.hpp>
+#include <JSONDocument.hpp>
 
 inline JSON::array toJSON(const glm::vec2& v) {
 	return JSON::array{v.x, v.y};
@@ -30,46 +31,58 @@ inline JSON::array toJSON(const glm::mat4& m) {
 
 template<>
 inline glm::vec3 JSON::value::to<glm::vec3>() const {
-	assert(_type == Type::array);
-	assert(_value.as_array.size() == 3);
-	const auto& a = _value.as_array;
-	return glm::vec3{a[0].to<float>(), a[1].to<float>(), a[2].to<float>()};
+	glm::vec3 v;
+	copyTo(&v[0], 3);
+	return v;
 }
 
 template<>
 inline glm::vec4 JSON::value::to<glm::vec4>() const {
-	assert(_type == Type::array);
-	assert(_value.as_array.size() == 4);
-	const auto& a = _value.as_array;
-	return glm::vec4{
-		a[0].to<float>(),
-		a[1].to<float>(),
-		a[2].to<float>(),
-		a[3].to<float>(),
-	};
+	glm::vec4 v;
+	copyTo(&v[0], 4);
+	return v;
 }
 
 template<>
 inline glm::quat JSON::value::to<glm::quat>() const {
-	assert(_type == Type::array);
-	assert(_value.as_array.size() == 4);
-	const auto& a = _value.as_array;
+	glm::vec4 v;
+	copyTo(&v[0], 4);
 	// glm::quat constructor takes w as the first argument.
-	return glm::quat{
-		a[3].to<float>(),
-		a[0].to<float>(),
-		a[1].to<float>(),
-		a[2].to<float>(),
-	};
+	return glm::quat{v.w, v.x, v.y, v.z};
 }
 
 template<>
 inline glm::mat4 JSON::value::to<glm::mat4>() const {
-	assert(_type == Type::array);
-	assert(_value.as_array.size() == 16);
-	const auto& a = _value.as_array;
-	return glm::mat4{
-		a[0].to<float>(), a[1].to<float>(), a[2].to<float>(),  a[3].to<float>(),  a[4].to<float>(),	 a[5].to<float>(),	a[6].to<float>(),  a[7].to<float>(),
-		a[8].to<float>(), a[9].to<float>(), a[10].to<float>(), a[11].to<float>(), a[12].to<float>(), a[13].to<float>(), a[14].to<float>(), a[15].to<float>(),
-	};
+	glm::mat4 m;
+	copyTo(&m[0][0], 16);
+	return m;
+}
+
+template<>
+inline glm::vec3 JSON::Document::Node::to<glm::vec3>() const {
+	glm::vec3 v;
+	copyTo(&v[0], 3); // copyTo resolves deferred arrays (lazy mode) and reads packed ones directly
+	return v;
+}
+
+template<>
+inline glm::vec4 JSON::Document::Node::to<glm::vec4>() const {
+	glm::vec4 v;
+	copyTo(&v[0], 4);
+	return v;
+}
+
+template<>
+inline glm::quat JSON::Document::Node::to<glm::quat>() const {
+	glm::vec4 v;
+	copyTo(&v[0], 4);
+	// glm::quat constructor takes w as the first argument.
+	return glm::quat{v.w, v.x, v.y, v.z};
+}
+
+template<>
+inline glm::mat4 JSON::Document::Node::to<glm::mat4>() const {
+	glm::mat4 m;
+	copyTo(&m[0][0], 16);
+	return m;
 }
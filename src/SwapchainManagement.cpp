@@ -360,7 +360,7 @@ void Editor::recordCommandBuffers() {
 				auto					currentMesh = InvalidMeshIndex;
 				auto					skinnedMeshRenderers = _scene.getRegistry().view<SkinnedMeshRendererComponent>();
 				std::array<VkBuffer, 2> buffers{_renderer.Vertices.buffer(), _renderer.MotionVectors.buffer()};
-				auto					offsets = std::array<VkDeviceSize, 2>{_renderer.StaticVertexBufferSizeInBytes, 0};
+				auto					offsets = std::array<VkDeviceSize, 2>{_renderer.StaticVertexBufferCapacityInBytes, 0};
 				vkCmdBindVertexBuffers(b, 0, static_cast<uint32_t>(buffers.size()), buffers.data(), offsets.data());
 				for(const auto& entity : skinnedMeshRenderers) {
 					const auto& meshRenderer = _scene.getRegistry().get<SkinnedMeshRendererComponent>(entity);
@@ -381,7 +381,7 @@ void Editor::recordCommandBuffers() {
 							b, indexCount, 1, 0,
 							_renderer.getDynamicOffsetTable()[meshRenderer.indexIntoOffsetTable - _renderer.StaticOffsetTableSizeInBytes / sizeof(Renderer::OffsetEntry)]
 									.vertexOffset -
-								_renderer.StaticVertexBufferSizeInBytes / sizeof(Vertex),
+								_renderer.StaticVertexBufferCapacityInBytes / sizeof(PackedVertex),
 							instanceBaseOffset);
 
 					++instanceBaseOffset;
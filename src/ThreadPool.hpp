@@ -1,26 +1,37 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>
 #include <deque>
 #include <functional>
 #include <future>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 class ThreadPool {
   public:
 	class TaskQueue {
 	  public:
+		TaskQueue() = default;
+		TaskQueue(const TaskQueue&) = delete; // Its address identifies its tasks in the pool
+		TaskQueue& operator=(const TaskQueue&) = delete;
 		~TaskQueue() { wait(); }
 
 		const std::future<void>& start(std::function<void()>&& func) {
-			_tasks.emplace_back(ThreadPool::GetInstance().queue(std::forward<std::function<void()>>(func)));
+			_tasks.emplace_back(ThreadPool::GetInstance().queue(std::forward<std::function<void()>>(func), this));
 			return _tasks.back();
 		}
 
+		// Runs the pending tasks of this queue while waiting: Queues can be waited on from a task of the pool (e.g. an asynchronous load) without deadlocking
+		// it. Unrelated tasks are left to the pool, the main thread would otherwise end up running (e.g.) a whole asynchronous load before its next frame.
 		void wait() {
 			for(const auto& f : _tasks)
-				f.wait();
+				while(f.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+					if(!ThreadPool::GetInstance().runPendingTask(this))
+						f.wait(); // None of our tasks left in the pool queue: This one is already running on another thread.
 			_tasks.clear();
 		}
 
@@ -28,7 +39,10 @@ class ThreadPool {
 		std::vector<std::future<void>> _tasks;
 	};
 
-	ThreadPool(uint32_t threadCount = std::thread::hardware_concurrency() - 1);
+	// Leaves a core to the main thread, but always starts at least one thread: Asynchronous tasks (e.g. Scene::loadAsync) would never run otherwise.
+	static uint32_t DefaultThreadCount() { return std::max(2u, std::thread::hardware_concurrency()) - 1; }
+
+	ThreadPool(uint32_t threadCount = DefaultThreadCount());
 	ThreadPool(const ThreadPool&) = delete;
 	ThreadPool& operator=(const ThreadPool&) = delete;
 	~ThreadPool();
@@ -38,34 +52,81 @@ class ThreadPool {
 		return globalThreadPool;
 	}
 
-	void startThreads(uint32_t threadCount = std::thread::hardware_concurrency() - 1);
+	void			startThreads(uint32_t threadCount = DefaultThreadCount());
+	inline uint32_t getThreadCount() const { return static_cast<uint32_t>(_threads.size()); }
 
-	std::future<void> queue(std::function<void()>&& func) {
+	// owner (optional) is the TaskQueue the task belongs to, see runPendingTask.
+	std::future<void> queue(std::function<void()>&& func, const TaskQueue* owner = nullptr) {
 		auto task = std::packaged_task<void()>(std::forward<std::function<void()>>(func));
 		auto future = task.get_future();
 		{
 			std::unique_lock<std::mutex> lock(_tasksMutex);
-			_tasks.push_back(std::move(task));
+			if(owner)
+				_pendingTasks[owner].push_back(_firstTask + _tasks.size());
+			_tasks.push_back({std::move(task), owner});
 		}
 		_tasksAvailable.notify_one();
 		return future;
 	}
 
+	// Runs the oldest queued task of owner on the calling thread, returns false if there was none.
+	bool runPendingTask(const TaskQueue* owner) {
+		assert(owner);
+		std::packaged_task<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(_tasksMutex);
+			const auto it = _pendingTasks.find(owner);
+			if(it == _pendingTasks.end())
+				return false;
+			// Left in the queue (taken) rather than erased from its middle, the threads skip it.
+			auto& queued = _tasks[it->second.front() - _firstTask];
+			task = std::move(queued.task);
+			queued.taken = true;
+			popPendingTask(it);
+		}
+		task();
+		return true;
+	}
+
   private:
-	std::vector<std::thread>			   _threads;
-	std::deque<std::packaged_task<void()>> _tasks;
-	std::mutex							   _tasksMutex;
-	std::condition_variable				   _tasksAvailable;
+	struct Task {
+		std::packaged_task<void()> task;
+		const TaskQueue*		   owner = nullptr;
+		bool					   taken = false; // Already run by runPendingTask
+	};
+
+	std::vector<std::thread> _threads;
+	std::deque<Task>		 _tasks;
+	uint64_t				 _firstTask = 0; // Sequence number of _tasks.front()
+	// Sequence numbers of the queued tasks of each TaskQueue, oldest first. Tasks are taken in order both by the threads and by runPendingTask: The oldest task
+	// of an owner is always the front of its list.
+	std::unordered_map<const TaskQueue*, std::deque<uint64_t>> _pendingTasks;
+	std::mutex												   _tasksMutex;
+	std::condition_variable									   _tasksAvailable;
+
+	void popPendingTask(std::unordered_map<const TaskQueue*, std::deque<uint64_t>>::iterator it) {
+		it->second.pop_front();
+		if(it->second.empty())
+			_pendingTasks.erase(it);
+	}
 
 	void threadLoop() {
 		std::packaged_task<void()> localTask;
 		while(true) {
 			{
 				std::unique_lock<std::mutex> lock(_tasksMutex);
-				if(_tasks.empty())
-					_tasksAvailable.wait(lock, [&] { return !_tasks.empty(); });
-				localTask = std::move(_tasks.front());
+				_tasksAvailable.wait(lock, [&] { return !_tasks.empty(); });
+				auto& front = _tasks.front();
+				const bool taken = front.taken;
+				if(!taken) {
+					localTask = std::move(front.task);
+					if(front.owner)
+						popPendingTask(_pendingTasks.find(front.owner));
+				}
 				_tasks.pop_front();
+				++_firstTask;
+				if(taken)
+					continue;
 			}
 			if(!localTask.valid())
 				return;
@@ -0,0 +1,123 @@
+#include "TransformHierarchy.hpp"
+
+#include <Scene.hpp>
+
+#if defined(TRANSFORM_SIMD_SSE2)
+	#include <emmintrin.h>
+#endif
+
+void multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& result) {
+#if defined(TRANSFORM_SIMD_SSE2)
+	// Column-major: Each column of the result is a linear combination of the columns of a, weighted by the components of the column of b.
+	const float* pa = &a[0][0];
+	const float* pb = &b[0][0];
+	float*		 pr = &result[0][0];
+	const __m128 c0 = _mm_loadu_ps(pa + 0), c1 = _mm_loadu_ps(pa + 4), c2 = _mm_loadu_ps(pa + 8), c3 = _mm_loadu_ps(pa + 12);
+	__m128		 columns[4]; // Stored only once both inputs have been read: result may alias a or b.
+	for(int i = 0; i < 4; ++i) {
+		const __m128 col = _mm_loadu_ps(pb + 4 * i);
+		__m128		 r = _mm_mul_ps(c0, _mm_shuffle_ps(col, col, _MM_SHUFFLE(0, 0, 0, 0)));
+		r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(col, col, _MM_SHUFFLE(1, 1, 1, 1))));
+		r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(col, col, _MM_SHUFFLE(2, 2, 2, 2))));
+		r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_shuffle_ps(col, col, _MM_SHUFFLE(3, 3, 3, 3))));
+		columns[i] = r;
+	}
+	for(int i = 0; i < 4; ++i)
+		_mm_storeu_ps(pr + 4 * i, columns[i]);
+#else
+	result = a * b;
+#endif
+}
+
+void TransformHierarchy::rebuild(entt::registry& registry, entt::entity root) {
+	_entities.clear();
+	_nodes.clear();
+	_parents.clear();
+	_subtreeSizes.clear();
+	std::fill(_indices.begin(), _indices.end(), InvalidIndex);
+
+	// Iterative pre-order traversal. Children are pushed in reverse so they're visited in order.
+	std::vector<std::pair<entt::entity, uint32_t>> stack{{root, InvalidIndex}};
+	std::vector<entt::entity>					   children;
+	while(!stack.empty()) {
+		const auto [entity, parent] = stack.back();
+		stack.pop_back();
+		const auto index = static_cast<uint32_t>(_entities.size());
+		auto&	   node = registry.get<NodeComponent>(entity);
+		_entities.push_back(entity);
+		_nodes.push_back(&node);
+		_parents.push_back(parent);
+		_subtreeSizes.push_back(1);
+		const auto id = entt::to_entity(entity);
+		if(id >= _indices.size())
+			_indices.resize(id + 1, InvalidIndex);
+		_indices[id] = index;
+
+		children.clear();
+		for(auto child = node.first; child != entt::null; child = registry.get<NodeComponent>(child).next)
+			children.push_back(child);
+		for(auto it = children.rbegin(); it != children.rend(); ++it)
+			stack.push_back({*it, index});
+	}
+	// Children follow their parent: Accumulate the subtree sizes backwards.
+	for(size_t i = _entities.size(); i-- > 1;)
+		_subtreeSizes[_parents[i]] += _subtreeSizes[i];
+
+	_local.resize(_entities.size());
+	_world.resize(_entities.size());
+	for(size_t i = 0; i < _nodes.size(); ++i)
+		_world[i] = _nodes[i]->globalTransform;
+	_valid = true;
+}
+
+uint32_t TransformHierarchy::indexOf(entt::entity entity) const {
+	const auto id = entt::to_entity(entity);
+	if(id >= _indices.size() || _indices[id] == InvalidIndex || _entities[_indices[id]] != entity) // Identifiers are recycled with a different version
+		return InvalidIndex;
+	return _indices[id];
+}
+
+void TransformHierarchy::update(uint32_t first, uint32_t last) {
+	assert(_valid && first <= last && last <= _entities.size());
+	if(first == 0 && last > 0) {
+		_world[0] = _nodes[0]->globalTransform;
+		first = 1;
+	}
+	for(uint32_t i = first; i < last; ++i)
+		_local[i] = _nodes[i]->transform;
+	for(uint32_t i = first; i < last; ++i)
+		multiply(_world[_parents[i]], _local[i], _world[i]);
+	for(uint32_t i = first; i < last; ++i)
+		_nodes[i]->globalTransform = _world[i];
+}
+
+void TransformHierarchy::split(uint32_t first, uint32_t maxSize, std::vector<uint32_t>& heads, std::vector<Range>& ranges) const {
+	assert(_valid && maxSize > 0);
+	std::vector<uint32_t> stack{first};
+	while(!stack.empty()) {
+		const auto index = stack.back();
+		stack.pop_back();
+		if(_subtreeSizes[index] <= maxSize) {
+			ranges.push_back({index, subtreeEnd(index)});
+			continue;
+		}
+		heads.push_back(index);
+		// Children are consecutive subtrees: Group the small ones, the larger ones are split in turn.
+		Range run{index + 1, index + 1};
+		for(auto child = index + 1; child < subtreeEnd(index); child = subtreeEnd(child)) {
+			if(_subtreeSizes[child] > maxSize || subtreeEnd(child) - run.first > maxSize) {
+				if(run.first != run.last)
+					ranges.push_back(run);
+				run = {subtreeEnd(child), subtreeEnd(child)};
+				if(_subtreeSizes[child] > maxSize) {
+					stack.push_back(child);
+					continue;
+				}
+				run.first = child;
+			}
+			run.last = subtreeEnd(child);
+		}
+		if(run.first != run.last)
+			ranges.push_back(run);
+	}
+}
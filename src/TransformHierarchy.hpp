@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <entt/entt.hpp>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define TRANSFORM_SIMD_SSE2
+#endif
+
+struct NodeComponent;
+
+// Flattened copy of the node hierarchy of a Scene: Contiguous arrays of parent indices, local and world transforms, propagated with linear passes
+// instead of following the links of NodeComponent through the registry.
+// Nodes are stored in depth-first pre-order: Parents precede their children and each subtree is a contiguous range of nodes.
+// It has to be rebuilt after any structural change (see Scene, which invalidates it when nodes are linked, unlinked, created or destroyed).
+// It also keeps pointers to the NodeComponents, which are stable until then.
+class TransformHierarchy {
+  public:
+	static constexpr uint32_t InvalidIndex = 0xFFFFFFFF;
+
+	// Only the descendants of root are included.
+	void		rebuild(entt::registry& registry, entt::entity root);
+	inline void invalidate() { _valid = false; }
+	inline bool isValid() const { return _valid; }
+
+	inline size_t size() const { return _entities.size(); }
+	// InvalidIndex if the entity isn't part of the hierarchy.
+	uint32_t		indexOf(entt::entity entity) const;
+	// One past the last node of the subtree of index.
+	inline uint32_t subtreeEnd(uint32_t index) const { return index + _subtreeSizes[index]; }
+
+	inline std::span<const entt::entity> getEntities() const { return _entities; }
+	inline std::span<const uint32_t>	 getParents() const { return _parents; }
+	inline std::span<const glm::mat4>	 getWorldTransforms() const { return _world; }
+
+	// Gathers the local transforms of the nodes in [first, last), computes their world transforms in a single pass and writes them back to
+	// NodeComponent::globalTransform. The world transform of the parent of first must be up to date, like the one of the root, which is not derived
+	// from its local transform.
+	void update(uint32_t first, uint32_t last);
+
+	struct Range {
+		uint32_t first;
+		uint32_t last;
+	};
+	// Splits the subtree of first into independent ranges of at most maxSize nodes (consecutive small sibling subtrees are merged), for parallel
+	// updates. heads are the roots of the larger subtrees, in pre-order: They have to be updated (as single nodes, in order) before the ranges.
+	void split(uint32_t first, uint32_t maxSize, std::vector<uint32_t>& heads, std::vector<Range>& ranges) const;
+
+  private:
+	bool						_valid = false;
+	std::vector<entt::entity>	_entities;
+	std::vector<NodeComponent*> _nodes;
+	std::vector<uint32_t>		_parents; // InvalidIndex for the root
+	std::vector<uint32_t>		_subtreeSizes;
+	std::vector<glm::mat4>		_local;
+	std::vector<glm::mat4>		_world;
+	std::vector<uint32_t>		_indices; // By entity identifier (entt::to_entity)
+};
+
+// result = a * b, with SSE2 when available.
+void multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& result);
@@ -1,6 +1,7 @@
 ﻿#include "Editor.hpp"
 
 #define IMGUI_DEFINE_MATH_OPERATORS
+#include <Benchmarks.hpp>
 #include <IconsFontAwesome6.h>
 #include <ImGuiExtensions.hpp>
 #include <ImGuizmo.h>
@@ -220,8 +221,10 @@ void Editor::drawUI() {
 				if(payload) {
 					auto droppedMat = *static_cast<MaterialIndex*>(payload->Data);
 					*matIdx = droppedMat;
-					_renderer.updateMeshOffsetTable();
-					_renderer.uploadMeshOffsetTable();
+					// Material variants may have shifted the skinned entries and the instances custom indices
+					if(!_renderer.updateOffsetTables())
+						_dirtyScene = true; // Out of capacity
+					_dirtyHierarchy = true;
 					_outdatedCommandBuffers = true;
 				}
 				ImGui::EndDragDropTarget();
@@ -235,8 +238,10 @@ void Editor::drawUI() {
 				if(payload) {
 					auto droppedMat = *static_cast<MaterialIndex*>(payload->Data);
 					*matIdx = droppedMat;
-					_renderer.updateMeshOffsetTable();
-					_renderer.uploadMeshOffsetTable();
+					// Material variants may have shifted the skinned entries and the instances custom indices
+					if(!_renderer.updateOffsetTables())
+						_dirtyScene = true; // Out of capacity
+					_dirtyHierarchy = true;
 					_outdatedCommandBuffers = true;
 				}
 				ImGui::EndDragDropTarget();
@@ -299,6 +304,36 @@ void Editor::drawUI() {
 			if(ImGui::MenuItem("Compile Shaders")) {
 				compileShaders();
 			}
+			if(ImGui::MenuItem("Benchmark JSON Parsing")) {
+				benchmarkJSONParsing(DefaultJSONBenchmarkCorpus);
+			}
+			if(ImGui::MenuItem("Benchmark JSON Writing")) {
+				benchmarkJSONWriting();
+			}
+			if(ImGui::MenuItem("Benchmark Scene JSON Loading")) {
+				benchmarkSceneJSONLoading();
+			}
+			if(ImGui::MenuItem("Benchmark Vertex Kernels")) {
+				benchmarkVertexKernels();
+			}
+			if(ImGui::MenuItem("Benchmark Scene Loading")) {
+				benchmarkSceneLoading(DefaultSceneLoadingBenchmarkCorpus);
+			}
+			if(ImGui::MenuItem("Benchmark OBJ Loading")) {
+				benchmarkOBJLoading();
+			}
+			if(ImGui::MenuItem("Benchmark Base64 Decoding")) {
+				benchmarkBase64Decoding();
+			}
+			if(ImGui::MenuItem("Benchmark Scene Update")) {
+				benchmarkSceneUpdate();
+			}
+			if(ImGui::MenuItem("Benchmark Parallel Scene Update")) {
+				benchmarkParallelSceneUpdate();
+			}
+			if(ImGui::MenuItem("Benchmark Raycast")) {
+				benchmarkRaycast();
+			}
 			ImGui::EndMenu();
 		}
 		ImGui::EndMainMenuBar();
@@ -717,6 +752,14 @@ void Editor::drawUI() {
 	bool dirtyMaterials = false;
 
 	if(ImGui::Begin("Objects")) {
+		for(auto& load : _scene.getLoads()) {
+			ImGui::ProgressBar(load.getProgress(), ImVec2(-64.0f, 0.0f), load.getPath().filename().string().c_str());
+			ImGui::SameLine();
+			ImGui::PushID(&load);
+			if(ImGui::SmallButton("Cancel"))
+				load.cancel();
+			ImGui::PopID();
+		}
 		const std::function<void(entt::entity)> displayNode = [&](entt::entity entity) {
 			auto& n = _scene.getRegistry().get<NodeComponent>(entity);
 
@@ -0,0 +1,451 @@
+#include "VertexKernels.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(VERTEX_SIMD_AVX2)
+	#include <immintrin.h>
+#elif defined(VERTEX_SIMD_SSE2)
+	#include <emmintrin.h>
+#endif
+
+namespace VertexKernels {
+
+namespace {
+
+// Calls func with a null pointer of the C++ type corresponding to the component type.
+template<typename Func>
+void dispatch(ComponentType type, Func&& func) {
+	switch(type) {
+		case ComponentType::Byte: func(static_cast<int8_t*>(nullptr)); break;
+		case ComponentType::UnsignedByte: func(static_cast<uint8_t*>(nullptr)); break;
+		case ComponentType::Short: func(static_cast<int16_t*>(nullptr)); break;
+		case ComponentType::UnsignedShort: func(static_cast<uint16_t*>(nullptr)); break;
+		case ComponentType::Int: func(static_cast<int32_t*>(nullptr)); break;
+		case ComponentType::UnsignedInt: func(static_cast<uint32_t*>(nullptr)); break;
+		case ComponentType::Float: func(static_cast<float*>(nullptr)); break;
+		default: assert(false); break;
+	}
+}
+
+template<typename T>
+T load(const char* ptr) {
+	T value;
+	std::memcpy(&value, ptr, sizeof(T));
+	return value;
+}
+
+// Multiplying by the reciprocal rather than dividing gives the same results as the SIMD paths.
+template<typename T>
+constexpr float normalizationScale() {
+	return 1.0f / static_cast<float>(std::numeric_limits<T>::max());
+}
+
+template<typename T>
+float normalize(T value) {
+	if constexpr(std::is_signed_v<T>)
+		return std::max(static_cast<float>(value) * normalizationScale<T>(), -1.0f);
+	else
+		return static_cast<float>(value) * normalizationScale<T>();
+}
+
+// Number of leading elements which can be read using a load of loadSize bytes without reading past the end of the source.
+size_t wideLoadCount(size_t count, size_t srcStride, size_t elementSize, size_t loadSize) {
+	if(count == 0)
+		return 0;
+	const size_t end = (count - 1) * srcStride + elementSize;
+	if(end < loadSize)
+		return 0;
+	return std::min(count, (end - loadSize) / srcStride + 1);
+}
+
+// Scalar
+
+template<size_t Size>
+void copyScalar(char* dst, size_t dstStride, const char* src, size_t srcStride, size_t count) {
+	for(size_t i = 0; i < count; ++i)
+		std::memcpy(dst + i * dstStride, src + i * srcStride, Size);
+}
+
+void copyScalar(char* dst, size_t dstStride, const char* src, size_t srcStride, size_t elementSize, size_t count) {
+	switch(elementSize) {
+		case 4: copyScalar<4>(dst, dstStride, src, srcStride, count); break;
+		case 8: copyScalar<8>(dst, dstStride, src, srcStride, count); break;
+		case 12: copyScalar<12>(dst, dstStride, src, srcStride, count); break;
+		case 16: copyScalar<16>(dst, dstStride, src, srcStride, count); break;
+		case 64: copyScalar<64>(dst, dstStride, src, srcStride, count); break;
+		default:
+			for(size_t i = 0; i < count; ++i)
+				std::memcpy(dst + i * dstStride, src + i * srcStride, elementSize);
+			break;
+	}
+}
+
+template<typename T>
+void widenScalar(uint32_t* dst, const char* src, size_t srcStride, size_t count) {
+	for(size_t i = 0; i < count; ++i)
+		dst[i] = static_cast<uint32_t>(static_cast<std::make_unsigned_t<T>>(load<T>(src + i * srcStride)));
+}
+
+template<typename T>
+void toFloatScalar(char* dst, size_t dstStride, const char* src, size_t srcStride, uint32_t components, bool normalized, size_t count) {
+	for(size_t i = 0; i < count; ++i) {
+		float* out = reinterpret_cast<float*>(dst + i * dstStride);
+		for(uint32_t c = 0; c < components; ++c) {
+			const T value = load<T>(src + i * srcStride + c * sizeof(T));
+			out[c] = normalized ? normalize(value) : static_cast<float>(value);
+		}
+	}
+}
+
+template<typename T>
+void toU16x4Scalar(char* dst, size_t dstStride, const char* src, size_t srcStride, size_t count) {
+	for(size_t i = 0; i < count; ++i) {
+		uint16_t* out = reinterpret_cast<uint16_t*>(dst + i * dstStride);
+		for(uint32_t c = 0; c < 4; ++c)
+			out[c] = static_cast<uint16_t>(load<T>(src + i * srcStride + c * sizeof(T)));
+	}
+}
+
+// SSE2
+
+#if defined(VERTEX_SIMD_SSE2)
+void copySSE2(char* dst, size_t dstStride, const char* src, size_t srcStride, size_t elementSize, size_t count) {
+	switch(elementSize) {
+		case 16:
+			for(size_t i = 0; i < count; ++i)
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * dstStride), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * srcStride)));
+			break;
+		case 64:
+			for(size_t i = 0; i < count; ++i) {
+				const auto s = reinterpret_cast<const __m128i*>(src + i * srcStride);
+				const auto d = reinterpret_cast<__m128i*>(dst + i * dstStride);
+				const auto c0 = _mm_loadu_si128(s + 0), c1 = _mm_loadu_si128(s + 1), c2 = _mm_loadu_si128(s + 2), c3 = _mm_loadu_si128(s + 3);
+				_mm_storeu_si128(d + 0, c0);
+				_mm_storeu_si128(d + 1, c1);
+				_mm_storeu_si128(d + 2, c2);
+				_mm_storeu_si128(d + 3, c3);
+			}
+			break;
+		// vec2 and vec3 are moved through general purpose registers anyway.
+		default: copyScalar(dst, dstStride, src, srcStride, elementSize, count); break;
+	}
+}
+
+// Packed sources only (srcStride == sizeof(T)).
+template<typename T>
+void widenSSE2(uint32_t* dst, const char* src, size_t count) {
+	const __m128i zero = _mm_setzero_si128();
+	size_t		  i = 0;
+	if constexpr(sizeof(T) == 1) {
+		for(; i + 16 <= count; i += 16) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			const __m128i lo = _mm_unpacklo_epi8(v, zero);
+			const __m128i hi = _mm_unpackhi_epi8(v, zero);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 0), _mm_unpacklo_epi16(lo, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(lo, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_unpacklo_epi16(hi, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 12), _mm_unpackhi_epi16(hi, zero));
+		}
+	} else if constexpr(sizeof(T) == 2) {
+		for(; i + 8 <= count; i += 8) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 0), _mm_unpacklo_epi16(v, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(v, zero));
+		}
+	}
+	widenScalar<T>(dst + i, src + i * sizeof(T), sizeof(T), count - i);
+}
+
+// Loads the (up to) 4 components of an element as 32bit integers. Reads 4 * sizeof(T) bytes.
+template<typename T>
+__m128i loadComponentsSSE2(const char* ptr) {
+	if constexpr(sizeof(T) == 1) {
+		const __m128i v = _mm_cvtsi32_si128(load<int32_t>(ptr));
+		if constexpr(std::is_signed_v<T>) {
+			const __m128i bytes = _mm_unpacklo_epi8(v, v);
+			return _mm_srai_epi32(_mm_unpacklo_epi16(bytes, bytes), 24);
+		} else {
+			const __m128i zero = _mm_setzero_si128();
+			return _mm_unpacklo_epi16(_mm_unpacklo_epi8(v, zero), zero);
+		}
+	} else {
+		const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr));
+		if constexpr(std::is_signed_v<T>)
+			return _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+		else
+			return _mm_unpacklo_epi16(v, _mm_setzero_si128());
+	}
+}
+
+void storeComponentsSSE2(float* dst, __m128 v, uint32_t components) {
+	switch(components) {
+		case 1: _mm_store_ss(dst, v); break;
+		case 2: _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_castps_si128(v)); break;
+		case 3:
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_castps_si128(v));
+			_mm_store_ss(dst + 2, _mm_movehl_ps(v, v));
+			break;
+		default: _mm_storeu_ps(dst, v); break;
+	}
+}
+
+// 8 and 16bit integer types only.
+template<typename T>
+void toFloatSSE2(char* dst, size_t dstStride, const char* src, size_t srcStride, uint32_t components, bool normalized, size_t count) {
+	const __m128 scale = _mm_set1_ps(normalized ? normalizationScale<T>() : 1.0f);
+	const __m128 minusOne = _mm_set1_ps(-1.0f);
+	const auto	 convert = [&](const char* ptr) {
+		__m128 v = _mm_mul_ps(_mm_cvtepi32_ps(loadComponentsSSE2<T>(ptr)), scale);
+		if(std::is_signed_v<T> && normalized)
+			v = _mm_max_ps(v, minusOne);
+		return v;
+	};
+	const size_t wide = wideLoadCount(count, srcStride, components * sizeof(T), 4 * sizeof(T));
+	for(size_t i = 0; i < wide; ++i)
+		storeComponentsSSE2(reinterpret_cast<float*>(dst + i * dstStride), convert(src + i * srcStride), components);
+	// Last elements: Go through a temporary buffer to avoid reading past the end of the source.
+	for(size_t i = wide; i < count; ++i) {
+		T tmp[4]{};
+		std::memcpy(tmp, src + i * srcStride, components * sizeof(T));
+		storeComponentsSSE2(reinterpret_cast<float*>(dst + i * dstStride), convert(reinterpret_cast<const char*>(tmp)), components);
+	}
+}
+
+template<typename T>
+void toU16x4SSE2(char* dst, size_t dstStride, const char* src, size_t srcStride, size_t count) {
+	if constexpr(std::is_same_v<T, int8_t>) {
+		toU16x4Scalar<T>(dst, dstStride, src, srcStride, count); // Sign extended
+	} else if constexpr(sizeof(T) == 1) {
+		const __m128i zero = _mm_setzero_si128();
+		for(size_t i = 0; i < count; ++i) {
+			const __m128i v = _mm_cvtsi32_si128(load<int32_t>(src + i * srcStride));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i * dstStride), _mm_unpacklo_epi8(v, zero));
+		}
+	} else if constexpr(sizeof(T) == 2) {
+		copyScalar<8>(dst, dstStride, src, srcStride, count);
+	} else {
+		// Keeps the low half of each 32bit component (words 0, 2, 4 and 6).
+		for(size_t i = 0; i < count; ++i) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * srcStride));
+			v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 2, 0));
+			v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(3, 3, 2, 0));
+			v = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 2, 0));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i * dstStride), v);
+		}
+	}
+}
+
+void iotaSSE2(uint32_t* dst, size_t count, uint32_t first) {
+	__m128i		  v = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(first)), _mm_setr_epi32(0, 1, 2, 3));
+	const __m128i step = _mm_set1_epi32(4);
+	size_t		  i = 0;
+	for(; i + 4 <= count; i += 4) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+		v = _mm_add_epi32(v, step);
+	}
+	for(; i < count; ++i)
+		dst[i] = first + static_cast<uint32_t>(i);
+}
+#endif
+
+// AVX2
+
+#if defined(VERTEX_SIMD_AVX2)
+void copyAVX2(char* dst, size_t dstStride, const char* src, size_t srcStride, size_t elementSize, size_t count) {
+	if(elementSize != 64)
+		return copySSE2(dst, dstStride, src, srcStride, elementSize, count);
+	for(size_t i = 0; i < count; ++i) {
+		const auto s = reinterpret_cast<const __m256i*>(src + i * srcStride);
+		const auto d = reinterpret_cast<__m256i*>(dst + i * dstStride);
+		const auto lo = _mm256_loadu_si256(s + 0), hi = _mm256_loadu_si256(s + 1);
+		_mm256_storeu_si256(d + 0, lo);
+		_mm256_storeu_si256(d + 1, hi);
+	}
+}
+
+// Packed sources only (srcStride == sizeof(T)).
+template<typename T>
+void widenAVX2(uint32_t* dst, const char* src, size_t count) {
+	size_t i = 0;
+	if constexpr(sizeof(T) == 1) {
+		for(; i + 16 <= count; i += 16) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 0), _mm256_cvtepu8_epi32(v));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 8), _mm256_cvtepu8_epi32(_mm_srli_si128(v, 8)));
+		}
+	} else if constexpr(sizeof(T) == 2) {
+		for(; i + 16 <= count; i += 16) {
+			const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+			const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i + 16));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 0), _mm256_cvtepu16_epi32(lo));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 8), _mm256_cvtepu16_epi32(hi));
+		}
+	}
+	widenSSE2<T>(dst + i, src + i * sizeof(T), count - i);
+}
+
+// Converts two elements at once: Their 4 components are gathered in a single register before being widened and converted.
+template<typename T>
+void toFloatAVX2(char* dst, size_t dstStride, const char* src, size_t srcStride, uint32_t components, bool normalized, size_t count) {
+	const __m256 scale = _mm256_set1_ps(normalized ? normalizationScale<T>() : 1.0f);
+	const __m256 minusOne = _mm256_set1_ps(-1.0f);
+	const size_t wide = wideLoadCount(count, srcStride, components * sizeof(T), 4 * sizeof(T));
+	size_t		 i = 0;
+	for(; i + 2 <= wide; i += 2) {
+		const char* a = src + i * srcStride;
+		const char* b = a + srcStride;
+		__m256i		ints;
+		if constexpr(sizeof(T) == 1) {
+			const __m128i packed = _mm_unpacklo_epi32(_mm_cvtsi32_si128(load<int32_t>(a)), _mm_cvtsi32_si128(load<int32_t>(b)));
+			if constexpr(std::is_signed_v<T>)
+				ints = _mm256_cvtepi8_epi32(packed);
+			else
+				ints = _mm256_cvtepu8_epi32(packed);
+		} else {
+			const __m128i packed = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(a)), _mm_loadl_epi64(reinterpret_cast<const __m128i*>(b)));
+			if constexpr(std::is_signed_v<T>)
+				ints = _mm256_cvtepi16_epi32(packed);
+			else
+				ints = _mm256_cvtepu16_epi32(packed);
+		}
+		__m256 v = _mm256_mul_ps(_mm256_cvtepi32_ps(ints), scale);
+		if(std::is_signed_v<T> && normalized)
+			v = _mm256_max_ps(v, minusOne);
+		float* out = reinterpret_cast<float*>(dst + i * dstStride);
+		if(components == 4 && dstStride == 4 * sizeof(float)) {
+			_mm256_storeu_ps(out, v);
+		} else {
+			storeComponentsSSE2(out, _mm256_castps256_ps128(v), components);
+			storeComponentsSSE2(reinterpret_cast<float*>(dst + (i + 1) * dstStride), _mm256_extractf128_ps(v, 1), components);
+		}
+	}
+	toFloatSSE2<T>(dst + i * dstStride, dstStride, src + i * srcStride, srcStride, components, normalized, count - i);
+}
+
+void iotaAVX2(uint32_t* dst, size_t count, uint32_t first) {
+	__m256i		  v = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(first)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+	const __m256i step = _mm256_set1_epi32(8);
+	size_t		  i = 0;
+	for(; i + 8 <= count; i += 8) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+		v = _mm256_add_epi32(v, step);
+	}
+	iotaSSE2(dst + i, count - i, first + static_cast<uint32_t>(i));
+}
+#endif
+
+} // namespace
+
+size_t componentSize(ComponentType type) {
+	size_t size = 0;
+	dispatch(type, [&]<typename T>(T*) { size = sizeof(T); });
+	return size;
+}
+
+void copy(void* dst, size_t dstStride, const void* src, size_t srcStride, size_t elementSize, size_t count, Implementation impl) {
+	auto	   d = static_cast<char*>(dst);
+	const auto s = static_cast<const char*>(src);
+	if(count == 0)
+		return;
+	if(dstStride == elementSize && srcStride == elementSize) {
+		std::memcpy(d, s, elementSize * count);
+		return;
+	}
+	switch(impl) {
+#if defined(VERTEX_SIMD_AVX2)
+		case Implementation::AVX2: copyAVX2(d, dstStride, s, srcStride, elementSize, count); break;
+#endif
+#if defined(VERTEX_SIMD_SSE2)
+		case Implementation::SSE2: copySSE2(d, dstStride, s, srcStride, elementSize, count); break;
+#endif
+		default: copyScalar(d, dstStride, s, srcStride, elementSize, count); break;
+	}
+}
+
+void widen(uint32_t* dst, const void* src, size_t srcStride, ComponentType type, size_t count, Implementation impl) {
+	const auto s = static_cast<const char*>(src);
+	dispatch(type, [&]<typename T>(T*) {
+		if constexpr(std::is_same_v<T, float>) {
+			assert(false);
+		} else if constexpr(sizeof(T) == 4) {
+			copy(dst, sizeof(uint32_t), s, srcStride, sizeof(uint32_t), count, impl);
+		} else {
+			if(srcStride != sizeof(T))
+				return widenScalar<T>(dst, s, srcStride, count);
+			switch(impl) {
+#if defined(VERTEX_SIMD_AVX2)
+				case Implementation::AVX2: widenAVX2<T>(dst, s, count); break;
+#endif
+#if defined(VERTEX_SIMD_SSE2)
+				case Implementation::SSE2: widenSSE2<T>(dst, s, count); break;
+#endif
+				default: widenScalar<T>(dst, s, sizeof(T), count); break;
+			}
+		}
+	});
+}
+
+void toFloat(float* dst, size_t dstStride, const void* src, size_t srcStride, ComponentType type, uint32_t components, bool normalized, size_t count,
+			 Implementation impl) {
+	assert(components >= 1 && components <= 4);
+	auto	   d = reinterpret_cast<char*>(dst);
+	const auto s = static_cast<const char*>(src);
+	dispatch(type, [&]<typename T>(T*) {
+		if constexpr(std::is_same_v<T, float>) {
+			copy(d, dstStride, s, srcStride, components * sizeof(float), count, impl);
+		} else if constexpr(sizeof(T) == 4) {
+			assert(!normalized); // Not allowed by glTF
+			toFloatScalar<T>(d, dstStride, s, srcStride, components, normalized, count);
+		} else {
+			switch(impl) {
+#if defined(VERTEX_SIMD_AVX2)
+				case Implementation::AVX2: toFloatAVX2<T>(d, dstStride, s, srcStride, components, normalized, count); break;
+#endif
+#if defined(VERTEX_SIMD_SSE2)
+				case Implementation::SSE2: toFloatSSE2<T>(d, dstStride, s, srcStride, components, normalized, count); break;
+#endif
+				default: toFloatScalar<T>(d, dstStride, s, srcStride, components, normalized, count); break;
+			}
+		}
+	});
+}
+
+void toU16x4(uint16_t* dst, size_t dstStride, const void* src, size_t srcStride, ComponentType type, size_t count, Implementation impl) {
+	auto	   d = reinterpret_cast<char*>(dst);
+	const auto s = static_cast<const char*>(src);
+	dispatch(type, [&]<typename T>(T*) {
+		if constexpr(std::is_same_v<T, float>) {
+			assert(false);
+		} else {
+			switch(impl) {
+#if defined(VERTEX_SIMD_SSE2)
+				// Nothing to gain from wider registers: Elements are at most 16 bytes.
+				case Implementation::AVX2: [[fallthrough]];
+				case Implementation::SSE2: toU16x4SSE2<T>(d, dstStride, s, srcStride, count); break;
+#endif
+				default: toU16x4Scalar<T>(d, dstStride, s, srcStride, count); break;
+			}
+		}
+	});
+}
+
+void iota(uint32_t* dst, size_t count, uint32_t first, Implementation impl) {
+	switch(impl) {
+#if defined(VERTEX_SIMD_AVX2)
+		case Implementation::AVX2: iotaAVX2(dst, count, first); break;
+#endif
+#if defined(VERTEX_SIMD_SSE2)
+		case Implementation::SSE2: iotaSSE2(dst, count, first); break;
+#endif
+		default:
+			for(size_t i = 0; i < count; ++i)
+				dst[i] = first + static_cast<uint32_t>(i);
+			break;
+	}
+}
+
+} // namespace VertexKernels
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+	#define VERTEX_SIMD_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define VERTEX_SIMD_SSE2
+#endif
+
+// Gather/convert kernels used to extract vertex attributes and indices from (possibly interleaved) glTF buffers.
+// Sources and destinations are described by a pointer to their first element and a stride in bytes, so the same kernels copy to packed arrays
+// (e.g. indices, animation samplers) and scatter into an array of structures (e.g. Vertex::pos, with a stride of sizeof(Vertex)).
+// Sources do not have to be aligned.
+namespace VertexKernels {
+
+enum class Implementation {
+	Scalar,
+	SSE2,
+	AVX2,
+};
+
+// Best implementation available in this build.
+static constexpr Implementation BestImplementation =
+#if defined(VERTEX_SIMD_AVX2)
+	Implementation::AVX2;
+#elif defined(VERTEX_SIMD_SSE2)
+	Implementation::SSE2;
+#else
+	Implementation::Scalar;
+#endif
+
+// Same values as the glTF (and OpenGL) component types.
+enum class ComponentType : uint32_t {
+	Byte = 5120,
+	UnsignedByte = 5121,
+	Short = 5122,
+	UnsignedShort = 5123,
+	Int = 5124,
+	UnsignedInt = 5125,
+	Float = 5126,
+};
+
+size_t componentSize(ComponentType);
+
+// Copies count elements of elementSize bytes. Common attribute sizes (8, 12, 16 and 64 bytes: vec2, vec3, vec4 and mat4) have dedicated paths.
+void copy(void* dst, size_t dstStride, const void* src, size_t srcStride, size_t elementSize, size_t count, Implementation impl = BestImplementation);
+
+// Widens integers to a packed array of uint32_t (e.g. indices). Signed types are reinterpreted, not sign extended.
+void widen(uint32_t* dst, const void* src, size_t srcStride, ComponentType type, size_t count, Implementation impl = BestImplementation);
+
+// Converts elements of 1 to 4 integer components to floats, normalized following the glTF rules (c / 255, max(c / 127, -1)...) if requested.
+// Float sources are simply copied.
+void toFloat(float* dst, size_t dstStride, const void* src, size_t srcStride, ComponentType type, uint32_t components, bool normalized, size_t count,
+			 Implementation impl = BestImplementation);
+
+// Converts elements of 4 integer components (e.g. joint indices) to 4 uint16_t, values wider than 16 bits are truncated.
+void toU16x4(uint16_t* dst, size_t dstStride, const void* src, size_t srcStride, ComponentType type, size_t count, Implementation impl = BestImplementation);
+
+// Writes first, first + 1, ..., first + count - 1 (indices of a non-indexed primitive).
+void iota(uint32_t* dst, size_t count, uint32_t first = 0, Implementation impl = BestImplementation);
+
+} // namespace VertexKernels
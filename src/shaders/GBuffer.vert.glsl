@@ -8,6 +8,7 @@ layout(set = 0, binding = 0) uniform UniformBufferObject {
 } ubo;
 
 #include "InstanceData.glsl"
+#include "Octahedral.glsl"
 layout(set = 1, binding = 0) readonly buffer InstanceDataBlock {
     InstanceData instances[];
 };
@@ -15,11 +16,12 @@ layout(set = 1, binding = 1) readonly buffer PreviousInstanceDataBlock {
     InstanceData previousInstances[];
 };
 
+// PackedVertex (vulkan/Vertex.hpp)
 layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
-layout(location = 2) in vec3 inNormal;
-layout(location = 3) in vec4 inTangent;
-layout(location = 4) in vec2 inTexCoord;
+layout(location = 1) in vec2 inNormal; // Octahedral
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in vec2 inTangent; // Octahedral
+layout(location = 4) in float inTangentSign;
 #ifdef SKINNED
 layout(location = 5) in vec4 inMotionVector;
 #endif
@@ -38,11 +40,11 @@ void main() {
     vec4 viewPosition = ubo.view * worldPosition;
     gl_Position = ubo.proj * viewPosition;
     position = worldPosition.xyz;
-    normal = transpose(inverse(mat3(model))) * inNormal; // transpose(inverse()) is only important in case of non-uniform transformation
-    tangent = vec4(mat3(model) * inTangent.xyz, inTangent.w);
-    bitangent = cross(normal, tangent.xyz) * inTangent.w;
+    normal = transpose(inverse(mat3(model))) * octDecode(inNormal); // transpose(inverse()) is only important in case of non-uniform transformation
+    tangent = vec4(mat3(model) * octDecode(inTangent), inTangentSign);
+    bitangent = cross(normal, tangent.xyz) * inTangentSign;
     texCoord = inTexCoord;
-    color = inColor;
+    color = vec3(1.0);
     motion = (worldPosition - previousInstances[gl_InstanceIndex].transform * vec4(inPosition, 1.0)).xyz;
 #ifdef SKINNED
     motion += mat3(model) * inMotionVector.xyz;
@@ -0,0 +1,40 @@
+#ifndef OCTAHEDRAL_GLSL
+#define OCTAHEDRAL_GLSL
+
+float signNotZero(in float k) {
+    return (k >= 0.0) ? 1.0 : -1.0;
+}
+
+vec2 signNotZero(in vec2 v) {
+    return vec2(signNotZero(v.x), signNotZero(v.y));
+}
+
+/** Assumes that v is a unit vector. The result is an octahedral vector on the [-1, +1] square. */
+vec2 octEncode(in vec3 v) {
+    float l1norm = abs(v.x) + abs(v.y) + abs(v.z);
+    vec2 result = v.xy * (1.0 / l1norm);
+    if (v.z < 0.0) 
+        result = (1.0 - abs(result.yx)) * signNotZero(result.xy);
+    return result;
+}
+
+/** Returns a unit vector. Argument o is an octahedral vector packed via octEncode,
+    on the [-1, +1] square*/
+vec3 octDecode(vec2 o) {
+    vec3 v = vec3(o.x, o.y, 1.0 - abs(o.x) - abs(o.y));
+    if (v.z < 0.0)
+        v.xy = (1.0 - abs(v.yx)) * signNotZero(v.xy);
+    return normalize(v);
+}
+
+// Unit vector packed in two snorm16 (see packOctahedral in vulkan/Vertex.hpp).
+uint packOctahedral(vec3 v) {
+    if (v == vec3(0.0))
+        return 0;
+    return packSnorm2x16(octEncode(v));
+}
+
+vec3 unpackOctahedral(uint packed) {
+    return octDecode(unpackSnorm2x16(packed));
+}
+#endif
@@ -1,38 +1,36 @@
 #ifndef VERTEX_GLSL
 #define VERTEX_GLSL
 
+#include "Octahedral.glsl"
+
 struct Vertex {
 	vec3 pos;
-	vec3 color;
 	vec3 normal;
 	vec4 tangent;
 	vec2 texCoord;
-	uint padding;
 };
 
-const uint VertexStride = 4; // 4 vec4 per vertex
+// Matches PackedVertex (vulkan/Vertex.hpp)
+const uint VertexStride = 2; // 2 vec4 per vertex
 
-// Expect an array named "Vertices" to be accessible
+// Expect an array of uvec4 named "Vertices" to be accessible: The octahedral encoded directions are never read as floats, where some of their bit
+// patterns (NaNs, denormals) may not survive the round trip.
 Vertex unpack(uint index)
 {
 	// Unpack the vertices from the SSBO
-	vec4 d0 = Vertices[VertexStride * index + 0];
-	vec4 d1 = Vertices[VertexStride * index + 1];
-	vec4 d2 = Vertices[VertexStride * index + 2];
-	vec4 d3 = Vertices[VertexStride * index + 3];
+	uvec4 d0 = Vertices[VertexStride * index + 0];
+	uvec4 d1 = Vertices[VertexStride * index + 1];
 
 	Vertex v;
-	v.pos = d0.xyz;
-	v.color = vec3(d0.w, d1.xy);
-	v.normal = vec3(d1.zw, d2.x);
-	v.tangent = vec4(d2.yzw, d3.x);
-	v.texCoord = vec2(d3.yz);
-	v.padding = floatBitsToUint(d3.w);
+	v.pos = uintBitsToFloat(d0.xyz);
+	v.normal = unpackOctahedral(d0.w);
+	v.texCoord = uintBitsToFloat(d1.xy);
+	v.tangent = vec4(unpackOctahedral(d1.z), uintBitsToFloat(d1.w));
 
 	return v;
 }
 
 vec3 unpackVertexPosition(uint index) {
-	return Vertices[VertexStride * index + 0].xyz;
+	return uintBitsToFloat(Vertices[VertexStride * index + 0].xyz);
 }
-#endif
\ No newline at end of file
+#endif
@@ -9,7 +9,7 @@
 
 layout(binding = 0, set = 0) uniform accelerationStructureEXT topLevelAS;
 layout(binding = 1, set = 0) uniform sampler2D textures[];
-layout(binding = 2, set = 0) buffer VerticesBlock { vec4 Vertices[]; };
+layout(binding = 2, set = 0) buffer VerticesBlock { uvec4 Vertices[]; };
 layout(binding = 3, set = 0) buffer Indices { uint  i[]; } indices;
 layout(binding = 4, set = 0) buffer Offsets { uint  o[]; } offsets;
 layout(binding = 5, set = 0) buffer MaterialsBlock { uint Materials[]; };
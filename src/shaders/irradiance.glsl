@@ -2,6 +2,7 @@
 #define IRRADIANCE_GLSL
 
 #include "common.glsl"
+#include "Octahedral.glsl"
 #include "ProbeGrid.glsl"
 
 ivec3 probeLinearIndexToGridIndex(uint index, ProbeGrid grid) {
@@ -85,32 +86,6 @@ vec3 polarToCartesian(vec2 v) {
     return vec3(cos(v.y) * sin(v.x), sin(v.y) * sin(v.x), cos(v.x));
 }
 
-float signNotZero(in float k) {
-    return (k >= 0.0) ? 1.0 : -1.0;
-}
-
-vec2 signNotZero(in vec2 v) {
-    return vec2(signNotZero(v.x), signNotZero(v.y));
-}
-
-/** Assumes that v is a unit vector. The result is an octahedral vector on the [-1, +1] square. */
-vec2 octEncode(in vec3 v) {
-    float l1norm = abs(v.x) + abs(v.y) + abs(v.z);
-    vec2 result = v.xy * (1.0 / l1norm);
-    if (v.z < 0.0) 
-        result = (1.0 - abs(result.yx)) * signNotZero(result.xy);
-    return result;
-}
-
-/** Returns a unit vector. Argument o is an octahedral vector packed via octEncode,
-    on the [-1, +1] square*/
-vec3 octDecode(vec2 o) {
-    vec3 v = vec3(o.x, o.y, 1.0 - abs(o.x) - abs(o.y));
-    if (v.z < 0.0)
-        v.xy = (1.0 - abs(v.yx)) * signNotZero(v.xy);
-    return normalize(v);
-}
-
 // [0, res - 2[ to [-1, 1] for octahedral lookup
 vec2 normalizeLocalTexelCoord(ivec2 coord, uint res) {
     return ((vec2(coord) + 0.5f) * 2.0f / float(res - 2)) - 1.0f;
@@ -17,11 +17,12 @@ layout(binding = 2, set = 0) buffer ProbesBlock { uint Probes[]; };
 #include "irradiance.glsl"
 #define TYPE 0
 
+// PackedVertex (vulkan/Vertex.hpp)
 layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
-layout(location = 2) in vec3 inNormal;
-layout(location = 3) in vec4 inTangent;
-layout(location = 4) in vec2 inTexCoord;
+layout(location = 1) in vec2 inNormal; // Octahedral
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in vec2 inTangent; // Octahedral
+layout(location = 4) in float inTangentSign;
 
 layout(location = 0) out vec3 color;
 layout(location = 1) out vec3 normal;
@@ -45,10 +46,10 @@ void main() {
     probeUVOffset = probeIndexToColorUVOffset(probeLinearIndexToGridIndex(gl_InstanceIndex, grid), grid);
     probeDepthUVOffset = probeIndexToDepthUVOffset(probeLinearIndexToGridIndex(gl_InstanceIndex, grid), grid);
     gl_Position = ubo.proj * ubo.view * vec4(ProbeSize * inPosition + probePosition, 1.0);
-    color = inColor;
-    normal = inNormal;
-    tangent = inTangent;
-    bitangent = cross(normal, tangent.xyz) * inTangent.w;
+    color = vec3(1.0);
+    normal = octDecode(inNormal);
+    tangent = vec4(octDecode(inTangent), inTangentSign);
+    bitangent = cross(normal, tangent.xyz) * inTangentSign;
     texCoord = inTexCoord;
     state = Probes[gl_InstanceIndex];
 #if TYPE == 1
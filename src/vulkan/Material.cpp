@@ -4,7 +4,7 @@
 
 #include <Serialization.hpp>
 
-Material parseMaterial(const JSON::value& mat, uint32_t textureOffset) {
+Material parseMaterial(const JSON::Document::Node& mat, uint32_t textureOffset) {
 	Material material;
 	material.name = mat("name", std::string("NoName"));
 	if(mat.contains("pbrMetallicRoughness")) {
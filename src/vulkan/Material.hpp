@@ -10,6 +10,7 @@
 #include "Resources.hpp"
 
 #include <JSON.hpp>
+#include <JSONDocument.hpp>
 #include <TaggedType.hpp>
 
 struct Material {
@@ -32,5 +33,5 @@ struct MaterialIndexTag {};
 using MaterialIndex = TaggedIndex<uint32_t, MaterialIndexTag>;
 inline static const MaterialIndex InvalidMaterialIndex{static_cast<uint32_t>(-1)};
 
-Material	parseMaterial(const JSON::value& obj, uint32_t textureOffset);
+Material	parseMaterial(const JSON::Document::Node& obj, uint32_t textureOffset);
 JSON::value toJSON(const Material& mat);
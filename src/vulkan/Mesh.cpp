@@ -1,9 +1,11 @@
 #include "Mesh.hpp"
 
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <string>
 
+#include <Hash.hpp>
 #include <JSON.hpp>
 #include <Logger.hpp>
 #include <stringutils.hpp>
@@ -36,7 +38,11 @@ void Mesh::upload(VkDevice device, const Buffer& stagingBuffer, const DeviceMemo
 	if(!isValid())
 		return;
 
-	stagingMemory.fill(_vertices);
+	std::vector<PackedVertex> packedVertices;
+	packedVertices.reserve(_vertices.size());
+	for(const auto& v : _vertices)
+		packedVertices.push_back(PackedVertex::pack(v));
+	stagingMemory.fill(packedVertices);
 	_vertexBuffer.copyFromStagingBuffer(tmpCommandPool, stagingBuffer, getVertexByteSize(), queue);
 
 	stagingMemory.fill(_indices);
@@ -104,3 +110,24 @@ const Bounds& Mesh::computeBounds() {
 	}
 	return _bounds;
 }
+
+uint64_t Mesh::computeContentHash() const {
+	uint64_t hash = hash64(std::span<const Vertex>(_vertices));
+	hash = hash64(std::span<const uint32_t>(_indices), hash);
+	if(isSkinned()) {
+		hash = hash64(std::span<const glm::vec4>(getSkinVertexData().weights), hash);
+		hash = hash64(std::span<const JointIndices>(getSkinVertexData().joints), hash);
+	}
+	return hash;
+}
+
+template<typename T>
+static bool sameBytes(const std::vector<T>& l, const std::vector<T>& r) {
+	return l.size() == r.size() && (l.empty() || std::memcmp(l.data(), r.data(), sizeof(T) * l.size()) == 0);
+}
+
+bool Mesh::hasSameContent(const Mesh& o) const {
+	if(!sameBytes(_vertices, o._vertices) || !sameBytes(_indices, o._indices) || isSkinned() != o.isSkinned())
+		return false;
+	return !isSkinned() || (sameBytes(getSkinVertexData().weights, o.getSkinVertexData().weights) && sameBytes(getSkinVertexData().joints, o.getSkinVertexData().joints));
+}
@@ -45,7 +45,7 @@ class Mesh {
 
 	inline size_t getVertexByteSize() const {
 		assert(!dynamic || _vertices.size() < DynamicVertexCapacity);
-		return sizeof(Vertex) * (dynamic ? DynamicVertexCapacity : _vertices.size());
+		return sizeof(PackedVertex) * (dynamic ? DynamicVertexCapacity : _vertices.size());
 	}
 	inline size_t getIndexByteSize() const {
 		assert(!dynamic || _indices.size() < DynamicIndexCapacity);
@@ -76,6 +76,10 @@ class Mesh {
 	void normalizeVertices();
 	void computeVertexNormals();
 
+	// Hash of the geometry (vertices, indices and skin data), for content-addressed deduplication. Name and material are ignored.
+	uint64_t computeContentHash() const;
+	bool	 hasSameContent(const Mesh& other) const;
+
   private:
 	Buffer _vertexBuffer;
 	Buffer _indexBuffer;
@@ -4,7 +4,10 @@
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
 
+// Host representation of a vertex, used by the importers, the editing tools and the .scene files.
+// It is packed into a PackedVertex when uploaded to the device.
 struct Vertex {
 	glm::vec3 pos;
 	glm::vec3 color{1.0f};
@@ -12,11 +15,55 @@ struct Vertex {
 	glm::vec4 tangent;
 	glm::vec2 texCoord;
 	uint32_t  padding = 0; // Align to 4 vec4
+};
+
+// Octahedral encoding of a direction in two 16bit signed normalized integers (see shaders/Vertex.glsl for the decoding).
+inline uint32_t packOctahedral(glm::vec3 v) {
+	const float l1 = glm::abs(v.x) + glm::abs(v.y) + glm::abs(v.z);
+	if(l1 == 0.0f)
+		return glm::packSnorm2x16(glm::vec2(0.0f));
+	v /= l1;
+	glm::vec2 p{v.x, v.y};
+	if(v.z < 0.0f)
+		p = (1.0f - glm::abs(glm::vec2{v.y, v.x})) * glm::vec2{v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f};
+	return glm::packSnorm2x16(p);
+}
+
+inline glm::vec3 unpackOctahedral(uint32_t packed) {
+	const glm::vec2 p = glm::unpackSnorm2x16(packed);
+	glm::vec3		v{p.x, p.y, 1.0f - glm::abs(p.x) - glm::abs(p.y)};
+	if(v.z < 0.0f) {
+		const glm::vec2 folded = (1.0f - glm::abs(glm::vec2{v.y, v.x})) * glm::vec2{v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f};
+		v.x = folded.x;
+		v.y = folded.y;
+	}
+	return glm::normalize(v);
+}
+
+// Device representation of a vertex (vertex buffers, ray tracing hit shaders and skinning): 32 bytes instead of the 64 of Vertex.
+// Normals and tangents are octahedral encoded and the vertex color (always white) is dropped. Positions stay 32bit floats: They are also
+// the input of the acceleration structures builds and are written back by the skinning shader.
+struct PackedVertex {
+	glm::vec3 pos;
+	uint32_t  normal; // packOctahedral
+	glm::vec2 texCoord;
+	uint32_t  tangent;	   // packOctahedral of tangent.xyz
+	float	  tangentSign; // tangent.w
+
+	static PackedVertex pack(const Vertex& v) {
+		return {
+			.pos = v.pos,
+			.normal = packOctahedral(v.normal),
+			.texCoord = v.texCoord,
+			.tangent = packOctahedral(glm::vec3(v.tangent)),
+			.tangentSign = v.tangent.w < 0.0f ? -1.0f : 1.0f,
+		};
+	}
 
 	static constexpr VkVertexInputBindingDescription getBindingDescription() {
 		VkVertexInputBindingDescription bindingDescription{
 			bindingDescription.binding = 0,
-			bindingDescription.stride = sizeof(Vertex),
+			bindingDescription.stride = sizeof(PackedVertex),
 			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
 		};
 
@@ -28,33 +75,34 @@ struct Vertex {
 				.location = 0,
 				.binding = 0,
 				.format = VK_FORMAT_R32G32B32_SFLOAT,
-				.offset = offsetof(Vertex, pos),
+				.offset = offsetof(PackedVertex, pos),
 			},
 			VkVertexInputAttributeDescription{
 				.location = 1,
 				.binding = 0,
-				.format = VK_FORMAT_R32G32B32_SFLOAT,
-				.offset = offsetof(Vertex, color),
+				.format = VK_FORMAT_R16G16_SNORM,
+				.offset = offsetof(PackedVertex, normal),
 			},
 			VkVertexInputAttributeDescription{
 				.location = 2,
 				.binding = 0,
-				.format = VK_FORMAT_R32G32B32_SFLOAT,
-				.offset = offsetof(Vertex, normal),
+				.format = VK_FORMAT_R32G32_SFLOAT,
+				.offset = offsetof(PackedVertex, texCoord),
 			},
 			VkVertexInputAttributeDescription{
 				.location = 3,
 				.binding = 0,
-				.format = VK_FORMAT_R32G32B32A32_SFLOAT,
-				.offset = offsetof(Vertex, tangent),
+				.format = VK_FORMAT_R16G16_SNORM,
+				.offset = offsetof(PackedVertex, tangent),
 			},
 			VkVertexInputAttributeDescription{
 				.location = 4,
 				.binding = 0,
-				.format = VK_FORMAT_R32G32_SFLOAT,
-				.offset = offsetof(Vertex, texCoord),
+				.format = VK_FORMAT_R32_SFLOAT,
+				.offset = offsetof(PackedVertex, tangentSign),
 			},
 		};
 		return attributeDescriptions;
 	}
 };
+static_assert(sizeof(PackedVertex) == 32);